@@ -1,5 +1,9 @@
 use borsh::{BorshDeserialize, BorshSerialize};
-use nssa::AccountId;
+use nssa::{AccountId, privacy_preserving_transaction::message::ViewTag};
+use nssa_core::{
+    Commitment,
+    encryption::{Ciphertext, EphemeralPublicKey},
+};
 use serde::{Deserialize, Serialize};
 use sha2::{Digest, Sha256, digest::FixedOutput};
 
@@ -109,6 +113,86 @@ impl From<Block> for HashableBlockData {
     }
 }
 
+impl Block {
+    /// Borsh encoding of the [`HashableBlockData`] of this block, the format blocks are served in.
+    ///
+    /// Encodes the fields in place, without cloning the transactions.
+    pub fn hashable_data_bytes(&self) -> Vec<u8> {
+        borsh::to_vec(&(
+            &self.header.block_id,
+            &self.header.prev_block_hash,
+            &self.header.timestamp,
+            &self.body.transactions,
+        ))
+        .expect("derived BorshSerialize should never fail")
+    }
+}
+
+/// Privacy relevant part of a block: the encrypted private post states of its privacy preserving
+/// transactions, enough for a wallet to find and decrypt its private accounts.
+#[derive(Debug, Clone, PartialEq, Eq, BorshSerialize, BorshDeserialize)]
+pub struct CompactBlock {
+    pub block_id: BlockId,
+    pub outputs: Vec<CompactOutput>,
+}
+
+/// Encrypted private post state of a privacy preserving transaction.
+#[derive(Debug, Clone, PartialEq, Eq, BorshSerialize, BorshDeserialize)]
+pub struct CompactOutput {
+    pub view_tag: ViewTag,
+    pub epk: EphemeralPublicKey,
+    pub ciphertext: Ciphertext,
+    pub commitment: Commitment,
+    /// Position of the output in its transaction, part of its decryption
+    pub output_index: u32,
+}
+
+impl CompactBlock {
+    pub fn new(block_id: BlockId, transactions: &[NSSATransaction]) -> Self {
+        let outputs = transactions
+            .iter()
+            .filter_map(|tx| match tx {
+                NSSATransaction::PrivacyPreserving(tx) => Some(tx.message()),
+                _ => None,
+            })
+            .flat_map(|message| {
+                message
+                    .encrypted_private_post_states
+                    .iter()
+                    .zip(&message.new_commitments)
+                    .zip(0u32..)
+                    .map(|((encrypted, commitment), output_index)| CompactOutput {
+                        view_tag: encrypted.view_tag,
+                        epk: encrypted.epk.clone(),
+                        ciphertext: encrypted.ciphertext.clone(),
+                        commitment: commitment.clone(),
+                        output_index,
+                    })
+            })
+            .collect();
+
+        Self { block_id, outputs }
+    }
+
+    /// Drop the outputs whose view tag is not in `view_tags`.
+    pub fn retain_view_tags(&mut self, view_tags: &[ViewTag]) {
+        self.outputs
+            .retain(|output| view_tags.contains(&output.view_tag));
+    }
+}
+
+impl From<&HashableBlockData> for CompactBlock {
+    fn from(value: &HashableBlockData) -> Self {
+        Self::new(value.block_id, &value.transactions)
+    }
+}
+
+impl From<&Block> for CompactBlock {
+    fn from(value: &Block) -> Self {
+        Self::new(value.header.block_id, &value.body.transactions)
+    }
+}
+
 /// Helper struct for account (de-)serialization
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct AccountInitialData {
@@ -136,4 +220,15 @@ mod tests {
         let block_from_bytes = borsh::from_slice::<HashableBlockData>(&bytes).unwrap();
         assert_eq!(hashable, block_from_bytes);
     }
+
+    #[test]
+    fn test_hashable_data_bytes_match_hashable_block_data() {
+        let transactions = vec![test_utils::produce_dummy_empty_transaction()];
+        let block = test_utils::produce_dummy_block(1, Some(HashType([1; 32])), transactions);
+        let bytes = block.hashable_data_bytes();
+        assert_eq!(
+            bytes,
+            borsh::to_vec(&HashableBlockData::from(block)).unwrap()
+        );
+    }
 }
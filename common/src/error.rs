@@ -16,6 +16,8 @@ pub enum SequencerClientError {
     HTTPError(#[from] reqwest::Error),
     #[error("Serde error")]
     SerdeError(#[from] serde_json::Error),
+    #[error("Borsh error")]
+    BorshError(#[from] std::io::Error),
     #[error("Internal error: {0:?}")]
     InternalError(SequencerRpcError),
 }
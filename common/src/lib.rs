@@ -6,6 +6,7 @@ use serde_with::{DeserializeFromStr, SerializeDisplay};
 pub mod block;
 pub mod config;
 pub mod error;
+pub mod metrics;
 pub mod rpc_primitives;
 pub mod sequencer_client;
 pub mod transaction;
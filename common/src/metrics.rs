@@ -0,0 +1,135 @@
+//! Prometheus metrics of the sequencer and indexer hot paths.
+//!
+//! Metrics are registered in the default registry on first use. Services export them in the text
+//! format returned by [`encode`].
+
+use std::sync::LazyLock;
+
+use prometheus::{
+    Encoder as _, Histogram, HistogramVec, IntGauge, TextEncoder, exponential_buckets,
+    register_histogram, register_histogram_vec, register_int_gauge,
+};
+
+/// Buckets from 10µs to about 20s, wide enough for a signature check as well as a slow Bedrock
+/// submission
+fn duration_buckets() -> Vec<f64> {
+    exponential_buckets(1e-5, 2.5, 17).expect("Duration buckets are valid")
+}
+
+pub static TRANSACTION_EXECUTION_SECONDS: LazyLock<HistogramVec> = LazyLock::new(|| {
+    register_histogram_vec!(
+        "lee_transaction_execution_seconds",
+        "Time to execute one transaction on the state, by transaction kind",
+        &["kind"],
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static SIGNATURE_VERIFICATION_SECONDS: LazyLock<HistogramVec> = LazyLock::new(|| {
+    register_histogram_vec!(
+        "lee_signature_verification_seconds",
+        "Time to verify the signatures of one transaction or of a batch of transactions",
+        &["mode"],
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static PROOF_VERIFICATION_SECONDS: LazyLock<Histogram> = LazyLock::new(|| {
+    register_histogram!(
+        "lee_proof_verification_seconds",
+        "Time to verify the proof of one privacy preserving transaction",
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static BLOCK_BUILD_SECONDS: LazyLock<Histogram> = LazyLock::new(|| {
+    register_histogram!(
+        "lee_block_build_seconds",
+        "Time to build and store one block from the mempool",
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static DB_WRITE_SECONDS: LazyLock<HistogramVec> = LazyLock::new(|| {
+    register_histogram_vec!(
+        "lee_db_write_seconds",
+        "Time to write one block and its state changes to RocksDB, by database",
+        &["db"],
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static BEDROCK_SUBMISSION_SECONDS: LazyLock<Histogram> = LazyLock::new(|| {
+    register_histogram!(
+        "lee_bedrock_submission_seconds",
+        "Time of one attempt to post a block inscription to Bedrock",
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static MEMPOOL_DEPTH: LazyLock<IntGauge> = LazyLock::new(|| {
+    register_int_gauge!(
+        "lee_mempool_depth",
+        "Number of transactions waiting in the mempool"
+    )
+    .expect("Metric is registered once")
+});
+
+pub static RPC_REQUEST_SECONDS: LazyLock<HistogramVec> = LazyLock::new(|| {
+    register_histogram_vec!(
+        "lee_rpc_request_seconds",
+        "Time to handle one RPC request, by method",
+        &["method"],
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static LOCK_WAIT_SECONDS: LazyLock<HistogramVec> = LazyLock::new(|| {
+    register_histogram_vec!(
+        "lee_lock_wait_seconds",
+        "Time spent waiting to acquire a lock, by lock",
+        &["lock"],
+        duration_buckets()
+    )
+    .expect("Metric is registered once")
+});
+
+pub static INDEXER_REPLAY_BLOCKS: LazyLock<Histogram> = LazyLock::new(|| {
+    register_histogram!(
+        "lee_indexer_replay_blocks",
+        "Number of blocks replayed to reconstruct a past state",
+        exponential_buckets(1.0, 2.0, 14).expect("Replay buckets are valid")
+    )
+    .expect("Metric is registered once")
+});
+
+/// Hook metrics into crates that can not depend on this one.
+///
+/// Call once at service startup.
+pub fn init() {
+    nssa::privacy_preserving_transaction::circuit::observe_proof_verification(|elapsed| {
+        PROOF_VERIFICATION_SECONDS.observe(elapsed.as_secs_f64())
+    });
+}
+
+/// All registered metrics in the Prometheus text format.
+pub fn encode() -> String {
+    let mut buffer = vec![];
+    TextEncoder::new()
+        .encode(&prometheus::gather(), &mut buffer)
+        .expect("Metrics are encodable");
+    String::from_utf8(buffer).expect("Prometheus text format is UTF-8")
+}
+
+/// Path of the endpoint serving [`encode`]'s output to `GET` requests
+pub const METRICS_PATH: &str = "metrics";
+
+/// Content type of [`encode`]'s output
+pub const CONTENT_TYPE: &str = "text/plain; version=0.0.4";
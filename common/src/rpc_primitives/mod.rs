@@ -6,20 +6,59 @@ pub mod message;
 pub mod parser;
 pub mod requests;
 
+/// Max number of blocks served by one request of a binary block range endpoint, also the max
+/// number of blocks sent in one read of a block stream
+pub const MAX_BLOCKS_PER_READ: u64 = 100;
+
+/// Max number of accounts queried by one `get_accounts` or `get_accounts_nonces` request
+pub const MAX_ACCOUNTS_PER_REQUEST: usize = 4096;
+
+/// Path of the endpoint serving block ranges in binary form
+///
+/// Takes a JSON encoded `GetBlockRangeDataRequest` and responds with the borsh encoding of
+/// `Vec<HashableBlockData>`, compressed if the client accepts it. Ranges are limited to
+/// [`MAX_BLOCKS_PER_READ`] blocks.
+pub const BLOCK_RANGE_BINARY_PATH: &str = "block_range";
+
+/// Path of the endpoint serving ranges of compact blocks
+///
+/// Responds with the borsh encoding of `Vec<CompactBlock>`, compressed if the client accepts it.
+/// Ranges are limited to [`MAX_BLOCKS_PER_READ`] blocks.
+/// A `GET` takes the range as `start_block_id` and `end_block_id` query parameters, and its
+/// response may be cached, as stored blocks never change. A `POST` takes a JSON encoded
+/// `GetCompactBlockRangeRequest` and can keep only the outputs of given view tags.
+pub const COMPACT_BLOCK_RANGE_PATH: &str = "compact_block_range";
+
+/// Path of the endpoint streaming blocks as they are produced
+///
+/// Takes a JSON encoded `SubscribeBlocksRequest` and responds with an unbounded stream of blocks
+/// from `from_block_id` on. Each block is framed as its length, 4 bytes little endian, followed by
+/// its borsh encoded `HashableBlockData`. Responds with 503 while
+/// [`RpcLimitsConfig::max_block_streams`] streams are open.
+pub const BLOCK_STREAM_PATH: &str = "block_stream";
+
 #[derive(Serialize, Deserialize, Clone, Debug)]
 pub struct RpcLimitsConfig {
     /// Maximum byte size of the json payload.
     pub json_payload_max_size: ByteSize,
+    /// Maximum number of block streams open at the same time.
+    #[serde(default = "default_max_block_streams")]
+    pub max_block_streams: usize,
 }
 
 impl Default for RpcLimitsConfig {
     fn default() -> Self {
         Self {
             json_payload_max_size: ByteSize::mib(10),
+            max_block_streams: default_max_block_streams(),
         }
     }
 }
 
+fn default_max_block_streams() -> usize {
+    256
+}
+
 #[derive(Serialize, Deserialize, Clone, Debug)]
 pub struct RpcConfig {
     pub addr: String,
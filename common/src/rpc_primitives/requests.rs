@@ -1,6 +1,6 @@
 use std::collections::HashMap;
 
-use nssa::AccountId;
+use nssa::{AccountId, privacy_preserving_transaction::message::ViewTag};
 use nssa_core::program::ProgramId;
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
@@ -37,6 +37,22 @@ pub struct GetBlockRangeDataRequest {
     pub end_block_id: u64,
 }
 
+/// Get compact blocks `start_block_id..=end_block_id`, see [`super::COMPACT_BLOCK_RANGE_PATH`]
+#[derive(Serialize, Deserialize, Debug)]
+pub struct GetCompactBlockRangeRequest {
+    pub start_block_id: u64,
+    pub end_block_id: u64,
+    /// Keep only the outputs with one of these view tags
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub view_tags: Option<Vec<ViewTag>>,
+}
+
+/// Subscribe to blocks from `from_block_id` on, see [`super::BLOCK_STREAM_PATH`]
+#[derive(Serialize, Deserialize, Debug)]
+pub struct SubscribeBlocksRequest {
+    pub from_block_id: u64,
+}
+
 #[derive(Serialize, Deserialize, Debug)]
 pub struct GetGenesisIdRequest {}
 
@@ -66,6 +82,12 @@ pub struct GetAccountRequest {
     pub account_id: AccountId,
 }
 
+/// Get several accounts in one round trip, results are returned in request order
+#[derive(Serialize, Deserialize, Debug)]
+pub struct GetAccountsRequest {
+    pub account_ids: Vec<AccountId>,
+}
+
 #[derive(Serialize, Deserialize, Debug)]
 pub struct GetProofForCommitmentRequest {
     pub commitment: nssa_core::Commitment,
@@ -87,6 +109,7 @@ parse_request!(GetTransactionByHashRequest);
 parse_request!(GetAccountsNoncesRequest);
 parse_request!(GetProofForCommitmentRequest);
 parse_request!(GetAccountRequest);
+parse_request!(GetAccountsRequest);
 parse_request!(GetProgramIdsRequest);
 
 #[derive(Serialize, Deserialize, Debug)]
@@ -201,6 +224,11 @@ pub struct GetAccountResponse {
     pub account: nssa::Account,
 }
 
+#[derive(Serialize, Deserialize, Debug)]
+pub struct GetAccountsResponse {
+    pub accounts: Vec<nssa::Account>,
+}
+
 #[derive(Serialize, Deserialize, Debug)]
 pub struct GetProofForCommitmentResponse {
     pub membership_proof: Option<nssa_core::MembershipProof>,
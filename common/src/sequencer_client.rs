@@ -1,7 +1,7 @@
 use std::{collections::HashMap, ops::RangeInclusive};
 
 use anyhow::Result;
-use nssa::AccountId;
+use nssa::{AccountId, privacy_preserving_transaction::message::ViewTag};
 use nssa_core::program::ProgramId;
 use reqwest::Client;
 use serde::Deserialize;
@@ -14,17 +14,19 @@ use super::rpc_primitives::requests::{
 };
 use crate::{
     HashType,
+    block::{CompactBlock, HashableBlockData},
     config::BasicAuth,
     error::{SequencerClientError, SequencerRpcError},
     rpc_primitives::{
         self,
         requests::{
             GetAccountRequest, GetAccountResponse, GetAccountsNoncesRequest,
-            GetAccountsNoncesResponse, GetBlockRangeDataRequest, GetBlockRangeDataResponse,
+            GetAccountsNoncesResponse, GetAccountsRequest, GetAccountsResponse,
+            GetBlockRangeDataRequest, GetBlockRangeDataResponse, GetCompactBlockRangeRequest,
             GetInitialTestnetAccountsResponse, GetLastBlockRequest, GetLastBlockResponse,
             GetProgramIdsRequest, GetProgramIdsResponse, GetProofForCommitmentRequest,
             GetProofForCommitmentResponse, GetTransactionByHashRequest,
-            GetTransactionByHashResponse, SendTxRequest, SendTxResponse,
+            GetTransactionByHashResponse, SendTxRequest, SendTxResponse, SubscribeBlocksRequest,
         },
     },
     transaction::NSSATransaction,
@@ -140,6 +142,109 @@ impl SequencerClient {
         Ok(resp_deser)
     }
 
+    /// Get blocks in `range` from the binary block range endpoint of the sequencer
+    ///
+    /// Same blocks as [`Self::get_block_range`], without the JSON and base64 overhead.
+    pub async fn get_block_range_binary(
+        &self,
+        range: RangeInclusive<u64>,
+    ) -> Result<Vec<HashableBlockData>, SequencerClientError> {
+        let block_req = GetBlockRangeDataRequest {
+            start_block_id: *range.start(),
+            end_block_id: *range.end(),
+        };
+
+        let url = self
+            .sequencer_addr
+            .join(rpc_primitives::BLOCK_RANGE_BINARY_PATH)
+            .expect("Block range path should be a valid relative URL");
+        let mut call_builder = self.client.post(url).json(&block_req);
+
+        if let Some(BasicAuth { username, password }) = &self.basic_auth {
+            call_builder = call_builder.basic_auth(username, password.as_deref());
+        }
+
+        let bytes = call_builder
+            .send()
+            .await?
+            .error_for_status()?
+            .bytes()
+            .await?;
+
+        Ok(borsh::from_slice(&bytes)?)
+    }
+
+    /// Get compact blocks in `range` from the sequencer
+    ///
+    /// Without `view_tags` the request is a cacheable `GET`. With them, only the outputs with one
+    /// of the view tags are kept, at the cost of revealing the view tags to the sequencer.
+    pub async fn get_compact_block_range(
+        &self,
+        range: RangeInclusive<u64>,
+        view_tags: Option<Vec<ViewTag>>,
+    ) -> Result<Vec<CompactBlock>, SequencerClientError> {
+        let url = self
+            .sequencer_addr
+            .join(rpc_primitives::COMPACT_BLOCK_RANGE_PATH)
+            .expect("Compact block range path should be a valid relative URL");
+        let mut call_builder = match view_tags {
+            None => self.client.get(url).query(&GetBlockRangeDataRequest {
+                start_block_id: *range.start(),
+                end_block_id: *range.end(),
+            }),
+            Some(view_tags) => self.client.post(url).json(&GetCompactBlockRangeRequest {
+                start_block_id: *range.start(),
+                end_block_id: *range.end(),
+                view_tags: Some(view_tags),
+            }),
+        };
+
+        if let Some(BasicAuth { username, password }) = &self.basic_auth {
+            call_builder = call_builder.basic_auth(username, password.as_deref());
+        }
+
+        let bytes = call_builder
+            .send()
+            .await?
+            .error_for_status()?
+            .bytes()
+            .await?;
+
+        Ok(borsh::from_slice(&bytes)?)
+    }
+
+    /// Subscribe to blocks from `from_block_id` on, as they are produced by the sequencer
+    pub fn subscribe_blocks(&self, from_block_id: u64) -> BlockSubscription {
+        BlockSubscription {
+            client: self.clone(),
+            next_block_id: from_block_id,
+            response: None,
+            received: false,
+            buffer: Vec::new(),
+        }
+    }
+
+    async fn open_block_stream(
+        &self,
+        from_block_id: u64,
+    ) -> Result<reqwest::Response, SequencerClientError> {
+        let url = self
+            .sequencer_addr
+            .join(rpc_primitives::BLOCK_STREAM_PATH)
+            .expect("Block stream path should be a valid relative URL");
+        let mut call_builder = self
+            .client
+            .post(url)
+            .timeout(BLOCK_STREAM_REQUEST_TIMEOUT)
+            .json(&SubscribeBlocksRequest { from_block_id });
+
+        if let Some(BasicAuth { username, password }) = &self.basic_auth {
+            call_builder = call_builder.basic_auth(username, password.as_deref());
+        }
+
+        Ok(call_builder.send().await?.error_for_status()?)
+    }
+
     /// Get last known `blokc_id` from sequencer
     pub async fn get_last_block(&self) -> Result<GetLastBlockResponse, SequencerClientError> {
         let block_req = GetLastBlockRequest {};
@@ -206,6 +311,24 @@ impl SequencerClient {
         Ok(resp_deser)
     }
 
+    /// Get accounts for `account_ids` in a single request. Accounts are returned in the same order
+    /// as `account_ids`, which the sequencer limits to
+    /// [`MAX_ACCOUNTS_PER_REQUEST`](crate::rpc_primitives::MAX_ACCOUNTS_PER_REQUEST) accounts.
+    pub async fn get_accounts(
+        &self,
+        account_ids: Vec<AccountId>,
+    ) -> Result<GetAccountsResponse, SequencerClientError> {
+        let block_req = GetAccountsRequest { account_ids };
+
+        let req = serde_json::to_value(block_req)?;
+
+        let resp = self.call_method_with_payload("get_accounts", req).await?;
+
+        let resp_deser = serde_json::from_value(resp)?;
+
+        Ok(resp_deser)
+    }
+
     /// Get transaction details for `hash`.
     pub async fn get_transaction_by_hash(
         &self,
@@ -358,3 +481,80 @@ impl SequencerClient {
         Ok(resp_deser)
     }
 }
+
+/// Lifetime of a single block stream request, after which the stream is reopened
+const BLOCK_STREAM_REQUEST_TIMEOUT: std::time::Duration = std::time::Duration::from_secs(600);
+
+/// Blocks pushed by the sequencer, in order and without gaps.
+///
+/// The underlying stream is reopened at the next block when its request times out or the
+/// sequencer ends it after sending blocks.
+pub struct BlockSubscription {
+    client: SequencerClient,
+    next_block_id: u64,
+    response: Option<reqwest::Response>,
+    /// Whether a block was received since the stream was opened
+    received: bool,
+    /// Frames received but not decoded yet
+    buffer: Vec<u8>,
+}
+
+impl BlockSubscription {
+    /// Wait for the next block.
+    pub async fn next_block(&mut self) -> Result<HashableBlockData, SequencerClientError> {
+        loop {
+            if let Some(block) = self.take_buffered_block()? {
+                self.next_block_id = block.block_id + 1;
+                self.received = true;
+                return Ok(block);
+            }
+
+            if self.response.is_none() {
+                self.response = Some(self.client.open_block_stream(self.next_block_id).await?);
+                self.received = false;
+            }
+            let response = self
+                .response
+                .as_mut()
+                .expect("Block stream was just opened");
+
+            match response.chunk().await {
+                Ok(Some(chunk)) => self.buffer.extend_from_slice(&chunk),
+                Ok(None) if !self.received => {
+                    return Err(std::io::Error::new(
+                        std::io::ErrorKind::UnexpectedEof,
+                        "Block stream closed by the sequencer",
+                    )
+                    .into());
+                }
+                Ok(None) => self.reopen(),
+                Err(err) if err.is_timeout() => self.reopen(),
+                Err(err) => return Err(err.into()),
+            }
+        }
+    }
+
+    /// Where the subscription continues, the id of the next block to be received.
+    pub fn next_block_id(&self) -> u64 {
+        self.next_block_id
+    }
+
+    fn reopen(&mut self) {
+        self.response = None;
+        self.buffer.clear();
+    }
+
+    fn take_buffered_block(&mut self) -> Result<Option<HashableBlockData>, SequencerClientError> {
+        let Some(len) = self.buffer.first_chunk::<4>() else {
+            return Ok(None);
+        };
+        let end = 4 + u32::from_le_bytes(*len) as usize;
+        if self.buffer.len() < end {
+            return Ok(None);
+        }
+
+        let block = borsh::from_slice(&self.buffer[4..end])?;
+        self.buffer.drain(..end);
+        Ok(Some(block))
+    }
+}
@@ -1,9 +1,12 @@
 use borsh::{BorshDeserialize, BorshSerialize};
 use log::warn;
-use nssa::{AccountId, V02State};
+use nssa::{AccountId, SignatureBatch, V02State};
 use serde::{Deserialize, Serialize};
 
-use crate::HashType;
+use crate::{
+    HashType,
+    metrics::{SIGNATURE_VERIFICATION_SECONDS, TRANSACTION_EXECUTION_SECONDS},
+};
 
 #[derive(Debug, Clone, PartialEq, Eq, BorshSerialize, BorshDeserialize)]
 pub enum NSSATransaction {
@@ -21,6 +24,15 @@ impl NSSATransaction {
         })
     }
 
+    /// Label of the transaction kind in metrics
+    pub fn kind(&self) -> &'static str {
+        match self {
+            NSSATransaction::Public(_) => "public",
+            NSSATransaction::PrivacyPreserving(_) => "privacy_preserving",
+            NSSATransaction::ProgramDeployment(_) => "program_deployment",
+        }
+    }
+
     pub fn affected_public_account_ids(&self) -> Vec<AccountId> {
         match self {
             NSSATransaction::ProgramDeployment(tx) => tx.affected_public_account_ids(),
@@ -29,32 +41,71 @@ impl NSSATransaction {
         }
     }
 
-    // TODO: Introduce type-safe wrapper around checked transaction, e.g. AuthenticatedTransaction
-    pub fn transaction_stateless_check(self) -> Result<Self, TransactionMalformationError> {
+    /// Verify the signatures of the transaction, the only way to build a [`VerifiedTransaction`].
+    pub fn transaction_stateless_check(
+        self,
+    ) -> Result<VerifiedTransaction, TransactionMalformationError> {
+        let _timer = SIGNATURE_VERIFICATION_SECONDS
+            .with_label_values(&["single"])
+            .start_timer();
+
         // Stateless checks here
         match self {
             NSSATransaction::Public(tx) => {
                 if tx.witness_set().is_valid_for(tx.message()) {
-                    Ok(NSSATransaction::Public(tx))
+                    Ok(VerifiedTransaction(NSSATransaction::Public(tx)))
                 } else {
                     Err(TransactionMalformationError::InvalidSignature)
                 }
             }
             NSSATransaction::PrivacyPreserving(tx) => {
                 if tx.witness_set().signatures_are_valid_for(tx.message()) {
-                    Ok(NSSATransaction::PrivacyPreserving(tx))
+                    Ok(VerifiedTransaction(NSSATransaction::PrivacyPreserving(tx)))
                 } else {
                     Err(TransactionMalformationError::InvalidSignature)
                 }
             }
-            NSSATransaction::ProgramDeployment(tx) => Ok(NSSATransaction::ProgramDeployment(tx)),
+            NSSATransaction::ProgramDeployment(tx) => {
+                Ok(VerifiedTransaction(NSSATransaction::ProgramDeployment(tx)))
+            }
+        }
+    }
+
+    /// Verify the signatures of all `transactions` as one batch.
+    ///
+    /// On failure returns the indices of the transactions with an invalid signature.
+    pub fn verify_signatures_batch(
+        transactions: Vec<NSSATransaction>,
+    ) -> Result<Vec<VerifiedTransaction>, Vec<usize>> {
+        let _timer = SIGNATURE_VERIFICATION_SECONDS
+            .with_label_values(&["batch"])
+            .start_timer();
+
+        {
+            let mut batch = SignatureBatch::new();
+            for (index, transaction) in transactions.iter().enumerate() {
+                match transaction {
+                    NSSATransaction::Public(tx) => tx.add_signatures_to_batch(index, &mut batch),
+                    NSSATransaction::PrivacyPreserving(tx) => {
+                        tx.add_signatures_to_batch(index, &mut batch)
+                    }
+                    NSSATransaction::ProgramDeployment(_) => {}
+                }
+            }
+            batch.verify()?;
         }
+
+        Ok(transactions.into_iter().map(VerifiedTransaction).collect())
     }
 
     pub fn execute_check_on_state(
         self,
         state: &mut V02State,
     ) -> Result<Self, nssa::error::NssaError> {
+        let _timer = TRANSACTION_EXECUTION_SECONDS
+            .with_label_values(&[self.kind()])
+            .start_timer();
+
         match &self {
             NSSATransaction::Public(tx) => state.transition_from_public_transaction(tx),
             NSSATransaction::PrivacyPreserving(tx) => {
@@ -70,6 +121,93 @@ impl NSSATransaction {
     }
 }
 
+/// Transaction whose signatures were verified.
+///
+/// Only [`NSSATransaction::transaction_stateless_check`] and
+/// [`NSSATransaction::verify_signatures_batch`] build it, so executing it skips signature checks.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct VerifiedTransaction(NSSATransaction);
+
+impl VerifiedTransaction {
+    pub fn transaction(&self) -> &NSSATransaction {
+        &self.0
+    }
+
+    pub fn into_transaction(self) -> NSSATransaction {
+        self.0
+    }
+
+    pub fn hash(&self) -> HashType {
+        self.0.hash()
+    }
+
+    /// Same as [`NSSATransaction::execute_check_on_state`] without verifying the signatures again.
+    pub fn execute_on_state(
+        self,
+        state: &mut V02State,
+    ) -> Result<NSSATransaction, nssa::error::NssaError> {
+        let _timer = TRANSACTION_EXECUTION_SECONDS
+            .with_label_values(&[self.0.kind()])
+            .start_timer();
+
+        match &self.0 {
+            NSSATransaction::Public(tx) => state.transition_from_verified_public_transaction(tx),
+            NSSATransaction::PrivacyPreserving(tx) => {
+                state.transition_from_verified_privacy_preserving_transaction(tx)
+            }
+            NSSATransaction::ProgramDeployment(tx) => {
+                state.transition_from_program_deployment_transaction(tx)
+            }
+        }
+        .inspect_err(|err| warn!("Error at transition {err:#?}"))?;
+
+        Ok(self.0)
+    }
+
+    /// Signers of the transaction with the nonce each of them signed.
+    fn signer_nonces(&self) -> Vec<(AccountId, nssa_core::account::Nonce)> {
+        let (signatures_and_public_keys, nonces) = match &self.0 {
+            NSSATransaction::Public(tx) => (
+                tx.witness_set().signatures_and_public_keys(),
+                &tx.message().nonces,
+            ),
+            NSSATransaction::PrivacyPreserving(tx) => (
+                tx.witness_set().signatures_and_public_keys(),
+                &tx.message().nonces,
+            ),
+            NSSATransaction::ProgramDeployment(_) => return Vec::new(),
+        };
+        signatures_and_public_keys
+            .iter()
+            .zip(nonces)
+            .map(|((_, public_key), nonce)| (AccountId::from(public_key), *nonce))
+            .collect()
+    }
+}
+
+/// Transactions of one signer are queued by the nonce of their first signature. The other
+/// signers' nonces must be current too for a transaction to be selected.
+///
+/// NSSA transactions carry no fee, so they all have the default priority and are selected in
+/// arrival order.
+impl mempool::MemPoolItem for VerifiedTransaction {
+    type Hash = HashType;
+    type Nonce = nssa_core::account::Nonce;
+    type Sender = AccountId;
+
+    fn hash(&self) -> HashType {
+        self.0.hash()
+    }
+
+    fn sender_nonce(&self) -> Option<(AccountId, nssa_core::account::Nonce)> {
+        self.signer_nonces().into_iter().next()
+    }
+
+    fn cosigner_nonces(&self) -> Vec<(AccountId, nssa_core::account::Nonce)> {
+        self.signer_nonces().into_iter().skip(1).collect()
+    }
+}
+
 impl From<nssa::PublicTransaction> for NSSATransaction {
     fn from(value: nssa::PublicTransaction) -> Self {
         Self::Public(value)
@@ -1,17 +1,91 @@
-use std::{path::Path, sync::Arc};
+use std::{
+    path::Path,
+    sync::{
+        Arc, Mutex, MutexGuard, RwLock, RwLockWriteGuard,
+        atomic::{AtomicBool, AtomicU64, Ordering},
+        mpsc,
+    },
+    thread,
+};
 
-use anyhow::Result;
+use anyhow::{Context as _, Result};
 use bedrock_client::HeaderId;
+use bytesize::ByteSize;
 use common::{
     block::{BedrockStatus, Block},
-    transaction::NSSATransaction,
+    transaction::{NSSATransaction, TransactionMalformationError},
 };
+use log::{error, warn};
 use nssa::{Account, AccountId, V02State};
 use storage::indexer::RocksDBIO;
 
+use crate::state_cache::{StateCache, StateCacheStats};
+
 #[derive(Clone)]
 pub struct IndexerStore {
     dbio: Arc<RocksDBIO>,
+    /// State after the last stored block, kept up to date by [`Self::put_block`]
+    final_state: Arc<RwLock<V02State>>,
+    /// Recently reconstructed historical states
+    state_cache: Arc<Mutex<StateCache>>,
+    breakpoint_writer: Arc<BreakpointWriter>,
+}
+
+/// Writes breakpoints of the final state on a background thread, so storing a block
+/// does not wait for the state to be serialized.
+struct BreakpointWriter {
+    interval: u64,
+    /// Id of the last breakpoint handed to the writer thread
+    last_br_id: AtomicU64,
+    /// Set while the writer thread is storing a breakpoint
+    busy: Arc<AtomicBool>,
+    sender: mpsc::Sender<(u64, V02State)>,
+}
+
+impl BreakpointWriter {
+    fn spawn(dbio: Arc<RocksDBIO>, interval: u64) -> Result<Self> {
+        let last_br_id = dbio.get_meta_last_breakpoint_id()?;
+        let busy = Arc::new(AtomicBool::new(false));
+        let (sender, receiver) = mpsc::channel::<(u64, V02State)>();
+
+        let writer_busy = Arc::clone(&busy);
+        thread::Builder::new()
+            .name("indexer-breakpoints".to_string())
+            .spawn(move || {
+                for (br_id, state) in receiver {
+                    if let Err(err) = dbio.put_breakpoint(br_id, &state) {
+                        error!("Failed to store breakpoint {br_id} with err {err:#?}");
+                    }
+                    writer_busy.store(false, Ordering::Release);
+                }
+            })
+            .context("Failed to spawn breakpoint writer thread")?;
+
+        Ok(Self {
+            interval: interval.max(1),
+            last_br_id: AtomicU64::new(last_br_id),
+            busy,
+            sender,
+        })
+    }
+
+    /// Hand `state`, the state before block `br_id`, to the writer thread if a breakpoint is due.
+    ///
+    /// A breakpoint which is due while the previous one is still being written is retried
+    /// on the next block.
+    fn maybe_write(&self, br_id: u64, state: &V02State) {
+        let last_br_id = self.last_br_id.load(Ordering::Relaxed);
+        if br_id < last_br_id.saturating_add(self.interval) || self.busy.load(Ordering::Acquire) {
+            return;
+        }
+
+        self.busy.store(true, Ordering::Release);
+        if self.sender.send((br_id, state.clone())).is_err() {
+            warn!("Breakpoint writer thread stopped, breakpoint {br_id} is skipped");
+            return;
+        }
+        self.last_br_id.store(br_id, Ordering::Relaxed);
+    }
 }
 
 impl IndexerStore {
@@ -22,17 +96,44 @@ impl IndexerStore {
     pub fn open_db_with_genesis(
         location: &Path,
         start_data: Option<(Block, V02State)>,
+        state_cache_size: ByteSize,
+        breakpoint_interval: u64,
     ) -> Result<Self> {
-        let dbio = RocksDBIO::open_or_create(location, start_data)?;
+        let dbio = Arc::new(RocksDBIO::open_or_create(location, start_data)?);
+        let final_state = Self::load_final_state(&dbio)?;
+        let breakpoint_writer = BreakpointWriter::spawn(Arc::clone(&dbio), breakpoint_interval)?;
 
         Ok(Self {
-            dbio: Arc::new(dbio),
+            dbio,
+            final_state: Arc::new(RwLock::new(final_state)),
+            state_cache: Arc::new(Mutex::new(StateCache::new(state_cache_size.as_u64()))),
+            breakpoint_writer: Arc::new(breakpoint_writer),
         })
     }
 
+    /// Replays the final state from the last breakpoint and rewrites the account table from it.
+    ///
+    /// The account table is written after its block, so rewriting it here also repairs
+    /// a table left behind by an interrupted [`Self::put_block`].
+    fn load_final_state(dbio: &RocksDBIO) -> Result<V02State> {
+        let mut final_state = dbio.final_state()?;
+        dbio.put_final_accounts(&final_state.state_diff().accounts)?;
+        final_state.clear_state_diff();
+
+        Ok(final_state)
+    }
+
+    fn final_state_mut(&self) -> RwLockWriteGuard<'_, V02State> {
+        self.final_state.write().expect("Final state lock poisoned")
+    }
+
     /// Reopening existing database
-    pub fn open_db_restart(location: &Path) -> Result<Self> {
-        Self::open_db_with_genesis(location, None)
+    pub fn open_db_restart(
+        location: &Path,
+        state_cache_size: ByteSize,
+        breakpoint_interval: u64,
+    ) -> Result<Self> {
+        Self::open_db_with_genesis(location, None, state_cache_size, breakpoint_interval)
     }
 
     pub fn last_observed_l1_lib_header(&self) -> Result<Option<HeaderId>> {
@@ -55,15 +156,10 @@ impl IndexerStore {
     }
 
     pub fn get_transaction_by_hash(&self, tx_hash: [u8; 32]) -> Result<NSSATransaction> {
-        let block = self.get_block_at_id(self.dbio.get_block_id_by_tx_hash(tx_hash)?)?;
-        let transaction = block
-            .body
-            .transactions
-            .iter()
-            .find(|enc_tx| enc_tx.hash().0 == tx_hash)
-            .ok_or_else(|| anyhow::anyhow!("Transaction not found in DB"))?;
-
-        Ok(transaction.clone())
+        self.dbio
+            .get_transactions_by_hashes(&[tx_hash])?
+            .pop()
+            .ok_or_else(|| anyhow::anyhow!("Transaction not found in DB"))
     }
 
     pub fn get_block_by_hash(&self, hash: [u8; 32]) -> Result<Block> {
@@ -91,33 +187,105 @@ impl IndexerStore {
             .expect("Must be set at the DB startup")
     }
 
+    /// State after block `block_id`.
+    ///
+    /// Replays from the closest cached state, or from the closest breakpoint if no cached state
+    /// is closer, and caches the result.
     pub fn get_state_at_block(&self, block_id: u64) -> Result<V02State> {
-        Ok(self.dbio.calculate_state_for_id(block_id)?)
+        let last_block = self.get_last_block_id()?;
+        if block_id > last_block {
+            anyhow::bail!("Block on this id not found");
+        }
+
+        // A state cached after block `br_id - 1` is as close as the breakpoint itself
+        let br_id = self.dbio.closest_breakpoint(block_id)?;
+        let cached = self
+            .state_cache()
+            .get_closest(block_id, br_id.saturating_sub(1));
+
+        let (next_block_id, mut state) = match cached {
+            Some((cached_id, state)) if cached_id == block_id => return Ok(state),
+            Some((cached_id, state)) => (cached_id + 1, state),
+            None => (br_id, self.dbio.get_breakpoint(br_id)?),
+        };
+
+        self.dbio
+            .apply_blocks(&mut state, next_block_id, block_id)?;
+        self.state_cache().insert(block_id, state.clone());
+
+        Ok(state)
+    }
+
+    pub fn state_cache_stats(&self) -> StateCacheStats {
+        self.state_cache().stats()
+    }
+
+    fn state_cache(&self) -> MutexGuard<'_, StateCache> {
+        self.state_cache.lock().expect("State cache lock poisoned")
     }
 
     pub fn final_state(&self) -> Result<V02State> {
-        Ok(self.dbio.final_state()?)
+        Ok(self
+            .final_state
+            .read()
+            .expect("Final state lock poisoned")
+            .clone())
     }
 
     pub fn get_account_final(&self, account_id: &AccountId) -> Result<Account> {
-        Ok(self.final_state()?.get_account_by_id(*account_id))
+        Ok(self.dbio.get_final_account(account_id)?.unwrap_or_default())
     }
 
-    pub fn put_block(&self, mut block: Block, l1_header: HeaderId) -> Result<()> {
-        let mut final_state = self.dbio.final_state()?;
+    pub fn put_block(&self, block: Block, l1_header: HeaderId) -> Result<()> {
+        let mut final_state = self.final_state_mut();
+
+        // An invalid block is reverted in memory, without replaying the stored state
+        final_state.begin_speculation();
+        if let Err(err) = Self::apply_block(&mut final_state, &block) {
+            final_state.discard_speculation();
+            return Err(err);
+        }
+        final_state.commit_speculation();
+
+        let res = self.put_applied_block(&mut final_state, block, l1_header);
+        if res.is_err() {
+            // The block may be partially stored, go back to the stored state
+            *final_state = Self::load_final_state(&self.dbio)?;
+        }
+
+        res
+    }
 
-        for transaction in &block.body.transactions {
-            transaction
-                .clone()
-                .transaction_stateless_check()?
-                .execute_check_on_state(&mut final_state)?;
+    fn apply_block(final_state: &mut V02State, block: &Block) -> Result<()> {
+        let transactions =
+            NSSATransaction::verify_signatures_batch(block.body.transactions.clone())
+                .map_err(|_| TransactionMalformationError::InvalidSignature)?;
+        for transaction in transactions {
+            transaction.execute_on_state(final_state)?;
         }
+        Ok(())
+    }
 
+    fn put_applied_block(
+        &self,
+        final_state: &mut V02State,
+        mut block: Block,
+        l1_header: HeaderId,
+    ) -> Result<()> {
         // ToDo: Currently we are fetching only finalized blocks
         // if it changes, the following lines need to be updated
         // to represent correct block finality
         block.bedrock_status = BedrockStatus::Finalized;
 
-        Ok(self.dbio.put_block(block, l1_header.into())?)
+        let block_id = block.header.block_id;
+        self.dbio.put_block(block, l1_header.into())?;
+        self.dbio
+            .put_final_accounts(&final_state.state_diff().accounts)?;
+        final_state.clear_state_diff();
+
+        self.breakpoint_writer
+            .maybe_write(block_id.saturating_add(1), final_state);
+
+        Ok(())
     }
 }
@@ -7,6 +7,7 @@ use std::{
 
 use anyhow::{Context as _, Result};
 pub use bedrock_client::BackoffConfig;
+use bytesize::ByteSize;
 use common::{
     block::{AccountInitialData, CommitmentsInitialData},
     config::BasicAuth,
@@ -39,6 +40,19 @@ pub struct IndexerConfig {
     pub consensus_info_polling_interval: Duration,
     pub bedrock_client_config: ClientConfig,
     pub channel_id: ChannelId,
+    /// Memory budget of reconstructed historical states kept for queries
+    #[serde(default = "default_state_cache_size")]
+    pub state_cache_size: ByteSize,
+    /// Number of blocks between stored state breakpoints
+    ///
+    /// Smaller intervals take more disk space and make historical queries replay fewer blocks.
+    #[serde(default = "default_breakpoint_interval")]
+    pub breakpoint_interval: u64,
+    /// Number of most recent commitment set digests that private transactions may prove against
+    ///
+    /// Must match the sequencer.
+    #[serde(default = "default_root_history_window")]
+    pub root_history_window: usize,
 }
 
 impl IndexerConfig {
@@ -51,3 +65,15 @@ impl IndexerConfig {
             .with_context(|| format!("Failed to parse indexer config at {config_path:?}"))
     }
 }
+
+fn default_state_cache_size() -> ByteSize {
+    ByteSize::mib(256)
+}
+
+fn default_breakpoint_interval() -> u64 {
+    100
+}
+
+fn default_root_history_window() -> usize {
+    nssa::DEFAULT_ROOT_HISTORY_WINDOW
+}
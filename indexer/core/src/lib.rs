@@ -15,6 +15,7 @@ use crate::{block_store::IndexerStore, config::IndexerConfig};
 
 pub mod block_store;
 pub mod config;
+pub mod state_cache;
 
 #[derive(Clone)]
 pub struct IndexerCore {
@@ -81,6 +82,7 @@ impl IndexerCore {
             .collect();
 
         let mut state = nssa::V02State::new_with_genesis_accounts(&init_accs, &initial_commitments);
+        state.set_root_history_window(config.root_history_window);
 
         // ToDo: Remove after testnet
         state.add_pinata_program(PINATA_BASE58.parse().unwrap());
@@ -94,7 +96,12 @@ impl IndexerCore {
                 config.bedrock_client_config.auth.clone(),
             )?,
             config,
-            store: IndexerStore::open_db_with_genesis(&home, Some((start_block, state)))?,
+            store: IndexerStore::open_db_with_genesis(
+                &home,
+                Some((start_block, state)),
+                config.state_cache_size,
+                config.breakpoint_interval,
+            )?,
         })
     }
 
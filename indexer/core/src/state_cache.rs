@@ -0,0 +1,162 @@
+use std::collections::BTreeMap;
+
+use nssa::V02State;
+
+/// Hit and miss counters of a [`StateCache`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct StateCacheStats {
+    /// Lookups that found a snapshot to start replay from
+    pub hits: u64,
+    /// Lookups that had to fall back to a persisted breakpoint
+    pub misses: u64,
+    /// Number of cached snapshots
+    pub entries: usize,
+    /// Estimated memory used by cached snapshots, in bytes
+    pub size: u64,
+}
+
+struct CachedState {
+    state: V02State,
+    size: u64,
+    last_used: u64,
+}
+
+/// Bounded LRU cache of reconstructed states, keyed by the id of the last applied block.
+///
+/// Snapshot sizes are estimated by their serialized length.
+pub struct StateCache {
+    budget: u64,
+    size: u64,
+    entries: BTreeMap<u64, CachedState>,
+    /// Last use tick to block id, oldest first
+    recency: BTreeMap<u64, u64>,
+    tick: u64,
+    hits: u64,
+    misses: u64,
+}
+
+impl StateCache {
+    pub fn new(budget: u64) -> Self {
+        Self {
+            budget,
+            size: 0,
+            entries: BTreeMap::new(),
+            recency: BTreeMap::new(),
+            tick: 0,
+            hits: 0,
+            misses: 0,
+        }
+    }
+
+    /// Closest cached state at or below `block_id`, if it was built from block `min_block_id`
+    /// or later.
+    ///
+    /// Counts a hit or a miss.
+    pub fn get_closest(&mut self, block_id: u64, min_block_id: u64) -> Option<(u64, V02State)> {
+        let Some((&cached_id, _)) = self.entries.range(min_block_id..=block_id).next_back() else {
+            self.misses += 1;
+            return None;
+        };
+
+        self.hits += 1;
+        self.tick += 1;
+
+        let entry = self
+            .entries
+            .get_mut(&cached_id)
+            .expect("Cached id was just found");
+        self.recency.remove(&entry.last_used);
+        self.recency.insert(self.tick, cached_id);
+        entry.last_used = self.tick;
+
+        Some((cached_id, entry.state.clone()))
+    }
+
+    /// Cache the state after block `block_id`, evicting least recently used states to stay
+    /// within budget.
+    pub fn insert(&mut self, block_id: u64, state: V02State) {
+        let size = borsh::object_length(&state).unwrap_or(usize::MAX) as u64;
+        if size > self.budget {
+            return;
+        }
+
+        self.remove(block_id);
+        while self.size + size > self.budget {
+            let Some((_, oldest_id)) = self.recency.pop_first() else {
+                break;
+            };
+            self.remove(oldest_id);
+        }
+
+        self.tick += 1;
+        self.recency.insert(self.tick, block_id);
+        self.entries.insert(
+            block_id,
+            CachedState {
+                state,
+                size,
+                last_used: self.tick,
+            },
+        );
+        self.size += size;
+    }
+
+    fn remove(&mut self, block_id: u64) {
+        if let Some(entry) = self.entries.remove(&block_id) {
+            self.recency.remove(&entry.last_used);
+            self.size -= entry.size;
+        }
+    }
+
+    pub fn stats(&self) -> StateCacheStats {
+        StateCacheStats {
+            hits: self.hits,
+            misses: self.misses,
+            entries: self.entries.len(),
+            size: self.size,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn state(balance: u128) -> V02State {
+        V02State::new_with_genesis_accounts(&[(nssa::AccountId::new([1; 32]), balance)], &[])
+    }
+
+    #[test]
+    fn test_closest_state_at_or_below() {
+        let mut cache = StateCache::new(u64::MAX);
+        cache.insert(10, state(10));
+        cache.insert(20, state(20));
+
+        assert_eq!(cache.get_closest(15, 0).map(|(id, _)| id), Some(10));
+        assert_eq!(cache.get_closest(25, 0).map(|(id, _)| id), Some(20));
+        assert!(cache.get_closest(5, 0).is_none());
+        assert!(cache.get_closest(15, 11).is_none());
+
+        let stats = cache.stats();
+        assert_eq!(stats.hits, 2);
+        assert_eq!(stats.misses, 2);
+        assert_eq!(stats.entries, 2);
+    }
+
+    #[test]
+    fn test_least_recently_used_state_is_evicted() {
+        let size = borsh::object_length(&state(0)).unwrap() as u64;
+        let mut cache = StateCache::new(2 * size);
+        cache.insert(10, state(10));
+        cache.insert(20, state(20));
+
+        // Touch 10 so that 20 is the least recently used
+        assert!(cache.get_closest(10, 0).is_some());
+        cache.insert(30, state(30));
+
+        assert_eq!(cache.get_closest(25, 0).map(|(id, _)| id), Some(10));
+        assert_eq!(cache.get_closest(30, 0).map(|(id, _)| id), Some(30));
+        assert_eq!(cache.stats().entries, 2);
+        assert_eq!(cache.stats().size, 2 * size);
+    }
+}
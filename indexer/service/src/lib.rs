@@ -6,6 +6,7 @@ use indexer_service_rpc::RpcServer as _;
 use jsonrpsee::server::Server;
 use log::{error, info};
 
+pub mod metrics;
 pub mod service;
 
 #[cfg(feature = "mock-responses")]
@@ -12,16 +12,31 @@ struct Args {
     config_path: PathBuf,
     #[clap(short, long, default_value = "8779")]
     port: u16,
+    /// Port to export Prometheus metrics on, not exported if unset
+    #[clap(long)]
+    metrics_port: Option<u16>,
 }
 
 #[tokio::main]
 async fn main() -> Result<()> {
     env_logger::init();
 
-    let Args { config_path, port } = Args::parse();
+    let Args {
+        config_path,
+        port,
+        metrics_port,
+    } = Args::parse();
 
     let cancellation_token = listen_for_shutdown_signal();
 
+    common::metrics::init();
+    let _metrics_handle = match metrics_port {
+        Some(metrics_port) => {
+            Some(indexer_service::metrics::run_metrics_server(metrics_port).await?)
+        }
+        None => None,
+    };
+
     let config = indexer_service::IndexerConfig::from_path(&config_path)?;
     let indexer_handle = indexer_service::run_server(config, port).await?;
 
@@ -0,0 +1,72 @@
+//! Minimal HTTP endpoint exporting metrics for Prometheus to scrape.
+//!
+//! The RPC server only speaks JSON-RPC, so metrics are served on their own port.
+
+use std::net::SocketAddr;
+
+use anyhow::{Context as _, Result};
+use common::metrics;
+use log::{info, warn};
+use tokio::{
+    io::{AsyncReadExt as _, AsyncWriteExt as _},
+    net::{TcpListener, TcpStream},
+    task::JoinHandle,
+};
+
+/// Requests are expected to fit in one read, Prometheus sends a few short headers
+const MAX_REQUEST_SIZE: usize = 4096;
+
+/// Serve metrics at `GET /metrics` until the returned task is aborted.
+pub async fn run_metrics_server(port: u16) -> Result<(JoinHandle<()>, SocketAddr)> {
+    let listener = TcpListener::bind(SocketAddr::from(([0, 0, 0, 0], port)))
+        .await
+        .context("Failed to bind metrics server")?;
+    let addr = listener
+        .local_addr()
+        .context("Failed to get local address of metrics server")?;
+
+    info!("Starting Indexer Service metrics server on {addr}");
+
+    let handle = tokio::spawn(async move {
+        loop {
+            match listener.accept().await {
+                Ok((stream, _)) => {
+                    tokio::spawn(async move {
+                        if let Err(err) = respond(stream).await {
+                            warn!("Failed to serve metrics: {err:#}");
+                        }
+                    });
+                }
+                Err(err) => warn!("Failed to accept metrics connection: {err}"),
+            }
+        }
+    });
+
+    Ok((handle, addr))
+}
+
+async fn respond(mut stream: TcpStream) -> Result<()> {
+    let mut request = vec![0; MAX_REQUEST_SIZE];
+    let read = stream.read(&mut request).await?;
+    let request_line = request[..read]
+        .split(|byte| *byte == b'\n')
+        .next()
+        .unwrap_or_default();
+
+    let response = if request_line
+        .starts_with(format!("GET /{} ", metrics::METRICS_PATH).as_bytes())
+    {
+        let body = metrics::encode();
+        format!(
+            "HTTP/1.1 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{body}",
+            metrics::CONTENT_TYPE,
+            body.len(),
+        )
+    } else {
+        "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n".to_owned()
+    };
+
+    stream.write_all(response.as_bytes()).await?;
+    stream.shutdown().await?;
+    Ok(())
+}
@@ -34,6 +34,9 @@ pub fn indexer_config(
         initial_commitments: initial_data.sequencer_initial_commitments(),
         signing_key: [37; 32],
         channel_id: bedrock_channel_id(),
+        state_cache_size: ByteSize::mib(64),
+        breakpoint_interval: 100,
+        root_history_window: nssa::DEFAULT_ROOT_HISTORY_WINDOW,
     })
 }
 
@@ -78,11 +81,15 @@ pub fn sequencer_config(
         max_num_tx_in_block,
         max_block_size,
         mempool_max_size,
+        mempool_max_nonce_gap: 64,
+        mempool_max_txs_per_sender: 64,
+        mempool_gapped_tx_ttl: Duration::from_secs(600),
         block_create_timeout,
         retry_pending_blocks_timeout: Duration::from_secs(120),
         port: 0,
         initial_accounts: initial_data.sequencer_initial_accounts(),
         initial_commitments: initial_data.sequencer_initial_commitments(),
+        root_history_window: nssa::DEFAULT_ROOT_HISTORY_WINDOW,
         signing_key: [37; 32],
         bedrock_config: BedrockConfig {
             backoff: BackoffConfig {
@@ -93,6 +100,8 @@ pub fn sequencer_config(
             node_url: addr_to_url(UrlProtocol::Http, bedrock_addr)
                 .context("Failed to convert bedrock addr to URL")?,
             auth: None,
+            settlement_queue_size: 256,
+            settlement_batch_size: 16,
         },
         indexer_rpc_url: addr_to_url(UrlProtocol::Ws, indexer_addr)
             .context("Failed to convert indexer addr to URL")?,
@@ -111,6 +120,11 @@ pub fn wallet_config(
         seq_tx_poll_max_blocks: 15,
         seq_poll_max_retries: 10,
         seq_block_poll_max_amount: 100,
+        seq_block_poll_prefetch: 4,
+        sync_checkpoint_blocks: 1000,
+        sync_checkpoint_interval: Duration::from_secs(30),
+        max_parallel_proofs: 4,
+        receipt_cache_size: 64,
         initial_accounts: initial_data.wallet_initial_accounts(),
         basic_auth: None,
     })
@@ -14,8 +14,8 @@ use nssa_core::program::DEFAULT_PROGRAM_ID;
 use tempfile::tempdir;
 use wallet::WalletCore;
 use wallet_ffi::{
-    FfiAccount, FfiAccountList, FfiBytes32, FfiPrivateAccountKeys, FfiPublicAccountKey,
-    FfiTransferResult, WalletHandle, error,
+    FfiAccount, FfiAccountList, FfiBytes32, FfiJobHandle, FfiPrivateAccountKeys,
+    FfiPublicAccountKey, FfiTransferResult, FfiU128, WalletHandle, error,
 };
 
 unsafe extern "C" {
@@ -62,6 +62,21 @@ unsafe extern "C" {
         out_account: *mut FfiAccount,
     ) -> error::WalletFfiError;
 
+    fn wallet_ffi_get_balances(
+        handle: *mut WalletHandle,
+        account_ids: *const FfiBytes32,
+        count: usize,
+        is_public: bool,
+        out_balances: *mut FfiU128,
+    ) -> error::WalletFfiError;
+
+    fn wallet_ffi_get_accounts_public(
+        handle: *mut WalletHandle,
+        account_ids: *const FfiBytes32,
+        count: usize,
+        out_accounts: *mut FfiAccount,
+    ) -> error::WalletFfiError;
+
     fn wallet_ffi_get_account_private(
         handle: *mut WalletHandle,
         account_id: *const FfiBytes32,
@@ -101,6 +116,26 @@ unsafe extern "C" {
         out_result: *mut FfiTransferResult,
     ) -> error::WalletFfiError;
 
+    fn wallet_ffi_transfer_public_async(
+        handle: *mut WalletHandle,
+        from: *const FfiBytes32,
+        to: *const FfiBytes32,
+        amount: *const [u8; 16],
+        out_job: *mut *mut FfiJobHandle,
+    ) -> error::WalletFfiError;
+
+    fn wallet_ffi_job_wait(
+        job: *mut FfiJobHandle,
+        out_result: *mut FfiTransferResult,
+    ) -> error::WalletFfiError;
+
+    fn wallet_ffi_job_poll(
+        job: *mut FfiJobHandle,
+        out_result: *mut FfiTransferResult,
+    ) -> error::WalletFfiError;
+
+    fn wallet_ffi_free_job(job: *mut FfiJobHandle);
+
     fn wallet_ffi_transfer_shielded(
         handle: *mut WalletHandle,
         from: *const FfiBytes32,
@@ -499,6 +534,91 @@ fn test_wallet_ffi_get_account_public() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn test_wallet_ffi_get_balances_public() -> Result<()> {
+    let ctx = BlockingTestContext::new()?;
+    let account_ids: Vec<FfiBytes32> = ctx
+        .ctx()
+        .existing_public_accounts()
+        .iter()
+        .map(FfiBytes32::from)
+        .collect();
+    let home = tempfile::tempdir().unwrap();
+    let wallet_ffi_handle = new_wallet_ffi_with_test_context_config(&ctx, home.path());
+    let mut out_balances = vec![FfiU128::default(); account_ids.len()];
+
+    let result = unsafe {
+        wallet_ffi_get_balances(
+            wallet_ffi_handle,
+            account_ids.as_ptr(),
+            account_ids.len(),
+            true,
+            out_balances.as_mut_ptr(),
+        )
+    };
+    assert_eq!(result, error::WalletFfiError::Success);
+
+    let mut balances: Vec<u128> = out_balances.into_iter().map(u128::from).collect();
+    balances.sort();
+    assert_eq!(balances, vec![10000, 20000]);
+
+    unsafe {
+        wallet_ffi_destroy(wallet_ffi_handle);
+    }
+
+    Ok(())
+}
+
+#[test]
+fn test_wallet_ffi_get_accounts_public() -> Result<()> {
+    let ctx = BlockingTestContext::new()?;
+    let account_ids: Vec<FfiBytes32> = ctx
+        .ctx()
+        .existing_public_accounts()
+        .iter()
+        .map(FfiBytes32::from)
+        .collect();
+    let home = tempfile::tempdir().unwrap();
+    let wallet_ffi_handle = new_wallet_ffi_with_test_context_config(&ctx, home.path());
+    let mut out_accounts: Vec<FfiAccount> = (0..account_ids.len())
+        .map(|_| FfiAccount::default())
+        .collect();
+
+    let result = unsafe {
+        wallet_ffi_get_accounts_public(
+            wallet_ffi_handle,
+            account_ids.as_ptr(),
+            account_ids.len(),
+            out_accounts.as_mut_ptr(),
+        )
+    };
+    assert_eq!(result, error::WalletFfiError::Success);
+
+    let accounts: Vec<Account> = out_accounts
+        .iter()
+        .map(|acc| acc.try_into().unwrap())
+        .collect();
+    let mut balances: Vec<u128> = accounts.iter().map(|acc| acc.balance).collect();
+    balances.sort();
+    assert_eq!(balances, vec![10000, 20000]);
+    for account in &accounts {
+        assert_eq!(
+            account.program_owner,
+            Program::authenticated_transfer_program().id()
+        );
+        assert_eq!(account.nonce, 0);
+    }
+
+    unsafe {
+        for account in out_accounts.iter_mut() {
+            wallet_ffi_free_account_data(account as *mut FfiAccount);
+        }
+        wallet_ffi_destroy(wallet_ffi_handle);
+    }
+
+    Ok(())
+}
+
 #[test]
 fn test_wallet_ffi_get_account_private() -> Result<()> {
     let ctx = BlockingTestContext::new()?;
@@ -842,6 +962,62 @@ fn test_wallet_ffi_transfer_public() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn test_wallet_ffi_transfer_public_async() -> Result<()> {
+    let ctx = BlockingTestContext::new().unwrap();
+    let home = tempfile::tempdir().unwrap();
+    let wallet_ffi_handle = new_wallet_ffi_with_test_context_config(&ctx, home.path());
+    let from: FfiBytes32 = (&ctx.ctx().existing_public_accounts()[0]).into();
+    let to: FfiBytes32 = (&ctx.ctx().existing_public_accounts()[1]).into();
+    let amount: [u8; 16] = 100u128.to_le_bytes();
+
+    let mut job: *mut FfiJobHandle = std::ptr::null_mut();
+    let mut transfer_result = FfiTransferResult::default();
+    unsafe {
+        let result = wallet_ffi_transfer_public_async(
+            wallet_ffi_handle,
+            (&from) as *const FfiBytes32,
+            (&to) as *const FfiBytes32,
+            (&amount) as *const [u8; 16],
+            (&mut job) as *mut *mut FfiJobHandle,
+        );
+        assert_eq!(result, error::WalletFfiError::Success);
+
+        let result = wallet_ffi_job_wait(job, (&mut transfer_result) as *mut FfiTransferResult);
+        assert_eq!(result, error::WalletFfiError::Success);
+        assert!(transfer_result.success);
+        assert!(!transfer_result.tx_hash.is_null());
+
+        // The result can only be collected once
+        let result = wallet_ffi_job_poll(job, std::ptr::null_mut());
+        assert_eq!(result, error::WalletFfiError::JobResultTaken);
+    }
+
+    info!("Waiting for next block creation");
+    std::thread::sleep(Duration::from_secs(TIME_TO_WAIT_FOR_BLOCK_SECONDS));
+
+    let from_balance = unsafe {
+        let mut out_balance: [u8; 16] = [0; 16];
+        let _result = wallet_ffi_get_balance(
+            wallet_ffi_handle,
+            (&from) as *const FfiBytes32,
+            true,
+            (&mut out_balance) as *mut [u8; 16],
+        );
+        u128::from_le_bytes(out_balance)
+    };
+
+    assert_eq!(from_balance, 9900);
+
+    unsafe {
+        wallet_ffi_free_transfer_result((&mut transfer_result) as *mut FfiTransferResult);
+        wallet_ffi_free_job(job);
+        wallet_ffi_destroy(wallet_ffi_handle);
+    }
+
+    Ok(())
+}
+
 #[test]
 fn test_wallet_ffi_transfer_shielded() -> Result<()> {
     let ctx = BlockingTestContext::new().unwrap();
@@ -4,7 +4,8 @@ use std::{
 };
 
 use anyhow::Result;
-use common::sequencer_client::SequencerClient;
+use common::{rpc_primitives::MAX_ACCOUNTS_PER_REQUEST, sequencer_client::SequencerClient};
+use rayon::prelude::*;
 use serde::{Deserialize, Serialize};
 
 use crate::key_management::{
@@ -61,6 +62,14 @@ impl<N: KeyNode> KeyTree<N> {
         }
     }
 
+    /// Tree without any node, not even a root
+    pub fn empty() -> Self {
+        Self {
+            key_map: BTreeMap::new(),
+            account_id_map: HashMap::new(),
+        }
+    }
+
     // ToDo: Add function to create a tree from list of nodes with consistency check.
 
     pub fn find_next_last_child_of_id(&self, parent_id: &ChainIndex) -> Option<u32> {
@@ -180,19 +189,79 @@ impl<N: KeyNode> KeyTree<N> {
     /// depth`.
     ///
     /// Tree must be empty before start
-    pub fn generate_tree_for_depth(&mut self, depth: u32) {
-        let mut id_stack = vec![ChainIndex::root()];
+    ///
+    /// The tree is grown one generation at a time, children of the nodes of a generation are
+    /// derived across worker threads.
+    pub fn generate_tree_for_depth(&mut self, depth: u32)
+    where
+        N: Send + Sync,
+    {
+        let mut parent_ids = vec![ChainIndex::root()];
+
+        while !parent_ids.is_empty() {
+            let children = parent_ids
+                .par_iter()
+                .flat_map_iter(|parent_id| {
+                    let parent_keys = &self.key_map[parent_id];
+                    let mut children = vec![];
+                    let mut child_id = parent_id.nth_child(0);
+
+                    while child_id.depth() < depth {
+                        let child_keys = parent_keys.nth_child(
+                            child_id.index().expect("Child chain index can not be root"),
+                        );
+                        let next_child_id = child_id.next_in_line();
+                        children.push((child_id, child_keys));
+                        child_id = next_child_id;
+                    }
 
-        while let Some(curr_id) = id_stack.pop() {
-            let mut next_id = curr_id.nth_child(0);
+                    children
+                })
+                .collect::<Vec<_>>();
+
+            parent_ids = children
+                .into_iter()
+                .map(|(chain_index, child_keys)| {
+                    self.insert(child_keys.account_id(), chain_index.clone(), child_keys);
+                    chain_index
+                })
+                .collect();
+        }
+    }
+}
 
-            while (next_id.depth()) < depth {
-                self.generate_new_node(&curr_id);
-                id_stack.push(next_id.clone());
-                next_id = next_id.next_in_line();
-            }
+/// Chain indices of a tree generated by [`KeyTree::generate_tree_for_depth`] for `depth`, in
+/// depth first order.
+fn chain_ids_for_depth(depth: u32) -> Vec<ChainIndex> {
+    let mut chain_ids = vec![];
+    let mut id_stack = vec![ChainIndex::root()];
+
+    while let Some(curr_id) = id_stack.pop() {
+        let mut next_id = curr_id.nth_child(0);
+
+        while (next_id.depth()) < depth {
+            id_stack.push(next_id.clone());
+            next_id = next_id.next_in_line();
         }
+
+        chain_ids.push(curr_id);
     }
+
+    chain_ids
+}
+
+/// Accounts of `account_ids`, in the same order, fetched in as few requests as possible.
+async fn get_accounts_batched(
+    client: &SequencerClient,
+    account_ids: Vec<nssa::AccountId>,
+) -> Result<Vec<nssa::Account>> {
+    let mut accounts = Vec::with_capacity(account_ids.len());
+
+    for account_ids in account_ids.chunks(MAX_ACCOUNTS_PER_REQUEST) {
+        accounts.extend(client.get_accounts(account_ids.to_vec()).await?.accounts);
+    }
+
+    Ok(accounts)
 }
 
 impl KeyTree<ChildKeysPrivate> {
@@ -261,29 +330,26 @@ impl KeyTree<ChildKeysPublic> {
     ///
     /// If account is default, removes them.
     ///
+    /// Accounts are queried from the sequencer in batches.
+    ///
     /// Fast, leaves gaps between accounts
     pub async fn cleanup_tree_remove_ininit_for_depth(
         &mut self,
         depth: u32,
         client: Arc<SequencerClient>,
     ) -> Result<()> {
-        let mut id_stack = vec![ChainIndex::root()];
-
-        while let Some(curr_id) = id_stack.pop() {
-            if let Some(node) = self.key_map.get(&curr_id) {
-                let address = node.account_id();
-                let node_acc = client.get_account(address).await?.account;
-
-                if node_acc == nssa::Account::default() && curr_id != ChainIndex::root() {
-                    self.remove(address);
-                }
-            }
-
-            let mut next_id = curr_id.nth_child(0);
-
-            while (next_id.depth()) < depth {
-                id_stack.push(next_id.clone());
-                next_id = next_id.next_in_line();
+        let account_ids = chain_ids_for_depth(depth)
+            .into_iter()
+            .filter(|chain_id| *chain_id != ChainIndex::root())
+            .filter_map(|chain_id| self.key_map.get(&chain_id))
+            .map(|node| node.account_id())
+            .collect::<Vec<_>>();
+
+        let accounts = get_accounts_batched(&client, account_ids.clone()).await?;
+
+        for (account_id, account) in account_ids.into_iter().zip(accounts) {
+            if account == nssa::Account::default() {
+                self.remove(account_id);
             }
         }
 
@@ -296,26 +362,29 @@ impl KeyTree<ChildKeysPublic> {
     ///
     /// Walks through tree in lairs of same depth using `ChainIndex::chain_ids_at_depth()`
     ///
+    /// Accounts of all layers are queried from the sequencer in batches up front.
+    ///
     /// Slow, maintains tree consistency.
     pub async fn cleanup_tree_remove_uninit_layered(
         &mut self,
         depth: u32,
         client: Arc<SequencerClient>,
     ) -> Result<()> {
-        'outer: for i in (1..(depth as usize)).rev() {
-            println!("Cleanup of tree at depth {i}");
-            for id in ChainIndex::chain_ids_at_depth(i) {
-                if let Some(node) = self.key_map.get(&id) {
-                    let address = node.account_id();
-                    let node_acc = client.get_account(address).await?.account;
-
-                    if node_acc == nssa::Account::default() {
-                        let addr = node.account_id();
-                        self.remove(addr);
-                    } else {
-                        break 'outer;
-                    }
-                }
+        let account_ids = (1..(depth as usize))
+            .rev()
+            .flat_map(ChainIndex::chain_ids_at_depth)
+            .filter_map(|id| self.key_map.get(&id))
+            .map(|node| node.account_id())
+            .collect::<Vec<_>>();
+
+        println!("Fetching {} accounts for cleanup", account_ids.len());
+        let accounts = get_accounts_batched(&client, account_ids.clone()).await?;
+
+        for (account_id, account) in account_ids.into_iter().zip(accounts) {
+            if account == nssa::Account::default() {
+                self.remove(account_id);
+            } else {
+                break;
             }
         }
 
@@ -529,6 +598,35 @@ mod tests {
         assert_eq!(next_slot, ChainIndex::from_str("/0/0/2/1").unwrap());
     }
 
+    #[test]
+    fn test_tree_for_depth_matches_sequential_generation() {
+        let seed_holder = seed_holder_for_tests();
+
+        let mut tree = KeyTreePublic::new(&seed_holder);
+        tree.generate_tree_for_depth(8);
+
+        let mut expected_tree = KeyTreePublic::new(&seed_holder);
+        let mut id_stack = vec![ChainIndex::root()];
+        while let Some(curr_id) = id_stack.pop() {
+            let mut next_id = curr_id.nth_child(0);
+            while next_id.depth() < 8 {
+                expected_tree.generate_new_node(&curr_id).unwrap();
+                id_stack.push(next_id.clone());
+                next_id = next_id.next_in_line();
+            }
+        }
+
+        assert_eq!(
+            tree.key_map.keys().collect::<Vec<_>>(),
+            expected_tree.key_map.keys().collect::<Vec<_>>()
+        );
+        assert_eq!(tree.account_id_map, expected_tree.account_id_map);
+        assert_eq!(
+            tree.key_map.keys().cloned().collect::<HashSet<_>>(),
+            chain_ids_for_depth(8).into_iter().collect::<HashSet<_>>()
+        );
+    }
+
     #[test]
     fn test_cleanup() {
         let seed_holder = seed_holder_for_tests();
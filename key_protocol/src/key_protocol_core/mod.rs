@@ -6,7 +6,7 @@ use serde::{Deserialize, Serialize};
 
 use crate::key_management::{
     KeyChain,
-    key_tree::{KeyTreePrivate, KeyTreePublic, chain_index::ChainIndex},
+    key_tree::{KeyTree, KeyTreePrivate, KeyTreePublic, chain_index::ChainIndex},
     secret_holders::SeedHolder,
 };
 
@@ -84,6 +84,33 @@ impl NSSAUserData {
         })
     }
 
+    /// Copy of the keys of `account_ids` only, as default accounts without key trees
+    ///
+    /// Accounts unknown to this store are left out.
+    pub fn subset(&self, account_ids: &[nssa::AccountId]) -> Self {
+        let default_pub_account_signing_keys = account_ids
+            .iter()
+            .filter_map(|&account_id| {
+                let key = self.get_pub_account_signing_key(account_id)?;
+                Some((account_id, key.clone()))
+            })
+            .collect();
+        let default_user_private_accounts = account_ids
+            .iter()
+            .filter_map(|&account_id| {
+                let key_chain = self.get_private_account(account_id)?;
+                Some((account_id, key_chain.clone()))
+            })
+            .collect();
+
+        Self {
+            default_pub_account_signing_keys,
+            default_user_private_accounts,
+            public_key_tree: KeyTree::empty(),
+            private_key_tree: KeyTree::empty(),
+        }
+    }
+
     /// Generated new private key for public transaction signatures
     ///
     /// Returns the account_id of new account
@@ -217,4 +244,30 @@ mod tests {
         let key_chain = &user_data.get_private_account(account_id_private).unwrap().0;
         println!("{key_chain:#?}");
     }
+
+    #[test]
+    fn test_subset_keeps_only_requested_keys() {
+        let mut user_data = NSSAUserData::default();
+
+        let (public_id, _) =
+            user_data.generate_new_public_transaction_private_key(Some(ChainIndex::root()));
+        let (private_id, _) = user_data
+            .generate_new_privacy_preserving_transaction_key_chain(Some(ChainIndex::root()));
+        let (other_private_id, _) = user_data
+            .generate_new_privacy_preserving_transaction_key_chain(Some(ChainIndex::root()));
+
+        let subset = user_data.subset(&[public_id, private_id]);
+
+        assert_eq!(
+            subset.get_pub_account_signing_key(public_id),
+            user_data.get_pub_account_signing_key(public_id)
+        );
+        assert_eq!(
+            subset.get_private_account(private_id).unwrap().1,
+            user_data.get_private_account(private_id).unwrap().1
+        );
+        assert!(subset.get_private_account(other_private_id).is_none());
+        assert!(subset.public_key_tree.key_map.is_empty());
+        assert!(subset.private_key_tree.key_map.is_empty());
+    }
 }
@@ -1,135 +1,814 @@
-use tokio::sync::mpsc::{Receiver, Sender};
+use std::{
+    cmp::{Ordering, Reverse},
+    collections::{BTreeMap, HashMap, HashSet},
+    hash::Hash,
+    sync::{Arc, Mutex, MutexGuard},
+    time::{Duration, Instant},
+};
 
-pub struct MemPool<T> {
-    receiver: Receiver<T>,
-    front_buffer: Vec<T>,
+/// Item that can be queued in a [`MemPool`].
+pub trait MemPoolItem {
+    /// Identity used for deduplication
+    type Hash: Copy + Eq + Hash;
+    /// Account whose nonce orders its items
+    type Sender: Clone + Eq + Hash;
+    /// Converted to measure how far an item is ahead of the next nonce of its sender
+    type Nonce: Copy + Ord + Into<u128>;
+
+    fn hash(&self) -> Self::Hash;
+
+    /// Sender and nonce of the item, if it is ordered by one.
+    ///
+    /// Items of one sender are only selected in nonce order, and an item with the same sender and
+    /// nonce as a queued one replaces it.
+    fn sender_nonce(&self) -> Option<(Self::Sender, Self::Nonce)> {
+        None
+    }
+
+    /// Other accounts whose nonce must be their next nonce for the item to be selected, e.g.
+    /// co-signers.
+    ///
+    /// They do not order items, only the sender does. While one of them is ahead, the item is set
+    /// aside with its sender as if behind a nonce gap. Once one of them is behind, the item can
+    /// never be included and is dropped. Only checked for items with a sender.
+    fn cosigner_nonces(&self) -> Vec<(Self::Sender, Self::Nonce)> {
+        Vec::new()
+    }
+
+    /// Items with a higher priority are selected first, ties are broken by arrival order.
+    fn priority(&self) -> u64 {
+        0
+    }
 }
 
-impl<T> MemPool<T> {
-    pub fn new(max_size: usize) -> (Self, MemPoolHandle<T>) {
-        let (sender, receiver) = tokio::sync::mpsc::channel(max_size);
+#[derive(Debug, Clone, Copy, PartialEq, Eq, thiserror::Error)]
+pub enum MemPoolError {
+    #[error("Mempool is full")]
+    Full,
+    #[error("Item is already in the mempool")]
+    Duplicate,
+    #[error("An item with the same sender and nonce and a higher priority is already queued")]
+    Underpriced,
+    #[error("Nonce is too far ahead of the next nonce of its account")]
+    NonceGapTooLarge,
+    #[error("Sender has too many items in the mempool")]
+    SenderQueueFull,
+}
 
-        let mem_pool = Self {
-            receiver,
-            front_buffer: Vec::new(),
+/// Limits on the items of one sender, so that items waiting behind a nonce gap can not take up
+/// the mempool.
+#[derive(Debug, Clone, Copy)]
+pub struct SenderLimits {
+    /// How far the nonce of an admitted item may be ahead of the next nonce of its sender
+    pub max_nonce_gap: u128,
+    /// Maximum number of queued items of one sender
+    pub max_items: usize,
+    /// Time after which items still waiting behind a nonce gap are dropped
+    pub gapped_ttl: Duration,
+}
+
+impl Default for SenderLimits {
+    fn default() -> Self {
+        Self {
+            max_nonce_gap: 64,
+            max_items: 64,
+            gapped_ttl: Duration::from_secs(600),
+        }
+    }
+}
+
+/// Selection order of an item: highest priority first, then lowest sequence number
+type Order = (Reverse<u64>, i64);
+
+struct Entry<T: MemPoolItem> {
+    item: T,
+    order: Order,
+    sender_nonce: Option<(T::Sender, T::Nonce)>,
+    cosigner_nonces: Vec<(T::Sender, T::Nonce)>,
+    added_at: Instant,
+}
+
+impl<T: MemPoolItem> Entry<T> {
+    /// How the nonces of the item compare to the next nonces of their accounts: less if one is
+    /// behind, else greater if one is ahead.
+    fn nonce_readiness(&self, next_nonce: impl Fn(&T::Sender) -> T::Nonce) -> Ordering {
+        let mut readiness = Ordering::Equal;
+        for (account, nonce) in self.sender_nonce.iter().chain(&self.cosigner_nonces) {
+            match nonce.cmp(&next_nonce(account)) {
+                Ordering::Less => return Ordering::Less,
+                Ordering::Greater => readiness = Ordering::Greater,
+                Ordering::Equal => {}
+            }
+        }
+        readiness
+    }
+}
+
+struct Inner<T: MemPoolItem> {
+    max_size: usize,
+    limits: SenderLimits,
+    entries: HashMap<T::Hash, Entry<T>>,
+    /// Queued nonces of every sender
+    by_sender: HashMap<T::Sender, BTreeMap<T::Nonce, T::Hash>>,
+    /// Items that can be selected: those without a sender and the lowest nonce of every sender
+    /// that is not gapped
+    queue: BTreeMap<Order, T::Hash>,
+    /// Senders whose lowest queued nonce was ahead of their next nonce when last checked
+    ///
+    /// Their items are left out of `queue` until the gap is filled.
+    gapped: HashSet<T::Sender>,
+    next_seq: i64,
+    next_front_seq: i64,
+}
+
+impl<T: MemPoolItem> Inner<T> {
+    fn insert(&mut self, item: T, seq: i64) {
+        let hash = item.hash();
+        let sender_nonce = item.sender_nonce();
+        let order = (Reverse(item.priority()), seq);
+        self.entries.insert(
+            hash,
+            Entry {
+                cosigner_nonces: item.cosigner_nonces(),
+                item,
+                order,
+                sender_nonce: sender_nonce.clone(),
+                added_at: Instant::now(),
+            },
+        );
+
+        let Some((sender, nonce)) = sender_nonce else {
+            self.queue.insert(order, hash);
+            return;
         };
-        let sender = MemPoolHandle::new(sender);
-        (mem_pool, sender)
+
+        // Only the lowest nonce of a sender is queued for selection
+        let nonces = self.by_sender.entry(sender.clone()).or_default();
+        let old_head = nonces.first_key_value().map(|(_, head)| *head);
+        nonces.insert(nonce, hash);
+        let new_head = *nonces.first_key_value().expect("Nonce was just inserted").1;
+        if old_head != Some(new_head) {
+            if let Some(old_head) = old_head {
+                self.queue.remove(&self.entries[&old_head].order);
+            }
+            // A lower nonce may fill the gap, it is checked again on selection
+            self.gapped.remove(&sender);
+            self.queue.insert(order, hash);
+        }
     }
 
-    pub fn pop(&mut self) -> Option<T> {
-        use tokio::sync::mpsc::error::TryRecvError;
+    fn remove(&mut self, hash: &T::Hash) -> Option<T> {
+        let entry = self.entries.remove(hash)?;
+        self.queue.remove(&entry.order);
 
-        // First check if there are any items in the front buffer (LIFO)
-        if let Some(item) = self.front_buffer.pop() {
-            return Some(item);
+        if let Some((sender, nonce)) = &entry.sender_nonce {
+            let nonces = self
+                .by_sender
+                .get_mut(sender)
+                .expect("Queued item sender should be indexed");
+            nonces.remove(nonce);
+            match nonces.first_key_value() {
+                Some((_, head)) => {
+                    if !self.gapped.contains(sender) {
+                        self.queue.insert(self.entries[head].order, *head);
+                    }
+                }
+                None => {
+                    self.by_sender.remove(sender);
+                    self.gapped.remove(sender);
+                }
+            }
         }
 
-        // Otherwise, try to receive from the channel (FIFO)
+        Some(entry.item)
+    }
+
+    fn head(&self, sender: &T::Sender) -> Option<(T::Nonce, T::Hash)> {
+        self.by_sender
+            .get(sender)?
+            .first_key_value()
+            .map(|(nonce, hash)| (*nonce, *hash))
+    }
 
-        match self.receiver.try_recv() {
-            Ok(item) => Some(item),
-            Err(TryRecvError::Empty) => None,
-            Err(TryRecvError::Disconnected) => {
-                panic!("Mempool senders disconnected, cannot receive items, this is a bug")
+    /// Leave the items of `sender` out of selection until its gap is filled.
+    fn park(&mut self, sender: &T::Sender) {
+        if let Some((_, head)) = self.head(sender) {
+            self.queue.remove(&self.entries[&head].order);
+            self.gapped.insert(sender.clone());
+        }
+    }
+
+    /// Drop the highest nonce of a gapped sender, if there is one.
+    fn evict_gapped(&mut self) -> bool {
+        let victim = self.gapped.iter().find_map(|sender| {
+            self.by_sender
+                .get(sender)?
+                .last_key_value()
+                .map(|(_, hash)| *hash)
+        });
+        match victim {
+            Some(victim) => self.remove(&victim).is_some(),
+            None => false,
+        }
+    }
+
+    fn recheck_gapped(&mut self, next_nonce: impl Fn(&T::Sender) -> T::Nonce) {
+        let now = Instant::now();
+        for sender in std::mem::take(&mut self.gapped) {
+            let Some((_, head)) = self.head(&sender) else {
+                continue;
+            };
+            if self.entries[&head].nonce_readiness(&next_nonce) != Ordering::Greater {
+                self.queue.insert(self.entries[&head].order, head);
+                continue;
+            }
+
+            self.gapped.insert(sender.clone());
+            let expired = self.by_sender[&sender]
+                .values()
+                .copied()
+                .filter(|hash| {
+                    now.duration_since(self.entries[hash].added_at) >= self.limits.gapped_ttl
+                })
+                .collect::<Vec<_>>();
+            for hash in expired {
+                self.remove(&hash);
             }
         }
     }
+}
 
-    /// Push an item to the front of the mempool (will be popped first)
+/// Bounded pool of items waiting to be included in a block.
+///
+/// Items are deduplicated by hash. Items of one sender are queued by nonce and only the next
+/// nonce of a sender can be selected, the others wait for it. Items behind a nonce gap are set
+/// aside, they are limited by [`SenderLimits`] and are the first to go when the pool is full.
+pub struct MemPool<T: MemPoolItem> {
+    inner: Arc<Mutex<Inner<T>>>,
+}
+
+impl<T: MemPoolItem> MemPool<T> {
+    pub fn new(max_size: usize) -> (Self, MemPoolHandle<T>) {
+        Self::with_sender_limits(max_size, SenderLimits::default())
+    }
+
+    pub fn with_sender_limits(max_size: usize, limits: SenderLimits) -> (Self, MemPoolHandle<T>) {
+        let inner = Arc::new(Mutex::new(Inner {
+            max_size,
+            limits,
+            entries: HashMap::new(),
+            by_sender: HashMap::new(),
+            queue: BTreeMap::new(),
+            gapped: HashSet::new(),
+            next_seq: 0,
+            next_front_seq: -1,
+        }));
+
+        let mem_pool = Self {
+            inner: Arc::clone(&inner),
+        };
+        let handle = MemPoolHandle { inner };
+        (mem_pool, handle)
+    }
+
+    /// Take the selectable item with the highest priority.
+    ///
+    /// `next_nonce` gives the nonce the next item of a sender must have, the same goes for
+    /// [`MemPoolItem::cosigner_nonces`]. Items with a nonce below it can never be included and
+    /// are dropped. Senders whose next item has a nonce above it are set aside until the gap is
+    /// filled or [`Self::recheck_gapped`] finds it closed, so they are not checked again on every
+    /// pop.
+    pub fn pop(&mut self, next_nonce: impl Fn(&T::Sender) -> T::Nonce) -> Option<T> {
+        let mut inner = lock(&self.inner);
+
+        loop {
+            let hash = *inner.queue.first_key_value()?.1;
+            let entry = &inner.entries[&hash];
+            let Some((sender, _)) = entry.sender_nonce.clone() else {
+                return inner.remove(&hash);
+            };
+            match entry.nonce_readiness(&next_nonce) {
+                Ordering::Equal => return inner.remove(&hash),
+                Ordering::Less => {
+                    inner.remove(&hash);
+                }
+                Ordering::Greater => inner.park(&sender),
+            }
+        }
+    }
+
+    /// Check the senders set aside behind a nonce gap again, for gaps closed by other means than
+    /// their own items, and drop their items that waited longer than [`SenderLimits::gapped_ttl`].
+    ///
+    /// Call once before selecting the items of a block.
+    pub fn recheck_gapped(&mut self, next_nonce: impl Fn(&T::Sender) -> T::Nonce) {
+        lock(&self.inner).recheck_gapped(next_nonce);
+    }
+
+    /// Return an item to the mempool, it will be selected before all items of the same priority.
+    ///
+    /// Items returned this way are taken in LIFO order and do not count against the size limit.
     pub fn push_front(&mut self, item: T) {
-        self.front_buffer.push(item);
+        let mut inner = lock(&self.inner);
+        if inner.entries.contains_key(&item.hash()) {
+            return;
+        }
+
+        let seq = inner.next_front_seq;
+        inner.next_front_seq -= 1;
+        inner.insert(item, seq);
+    }
+
+    pub fn len(&self) -> usize {
+        lock(&self.inner).entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
     }
 }
 
-pub struct MemPoolHandle<T> {
-    sender: Sender<T>,
+/// Handle to submit items to a [`MemPool`].
+pub struct MemPoolHandle<T: MemPoolItem> {
+    inner: Arc<Mutex<Inner<T>>>,
 }
 
-impl<T> MemPoolHandle<T> {
-    fn new(sender: Sender<T>) -> Self {
-        Self { sender }
+impl<T: MemPoolItem> Clone for MemPoolHandle<T> {
+    fn clone(&self) -> Self {
+        Self {
+            inner: Arc::clone(&self.inner),
+        }
     }
+}
 
-    /// Send an item to the mempool blocking if max size is reached
-    pub async fn push(&self, item: T) -> Result<(), tokio::sync::mpsc::error::SendError<T>> {
-        self.sender.send(item).await
+impl<T: MemPoolItem> MemPoolHandle<T> {
+    /// Add an item to the mempool without waiting for room.
+    ///
+    /// `next_nonce` gives the nonce the next item of a sender must have, see [`SenderLimits`] for
+    /// the items admitted ahead of it. An item with the same sender and nonce as a queued one
+    /// replaces it, unless the queued one has a higher priority. When the pool is full, items
+    /// behind a nonce gap are dropped to make room for one that is not.
+    pub fn push(
+        &self,
+        item: T,
+        next_nonce: impl Fn(&T::Sender) -> T::Nonce,
+    ) -> Result<(), MemPoolError> {
+        let mut guard = lock(&self.inner);
+        let inner = &mut *guard;
+        let hash = item.hash();
+        if inner.entries.contains_key(&hash) {
+            return Err(MemPoolError::Duplicate);
+        }
+
+        let mut replaced = None;
+        let mut gapped_sender = None;
+        if let Some((sender, nonce)) = item.sender_nonce() {
+            let next = next_nonce(&sender);
+            let gap_too_large = |nonce: T::Nonce, next: T::Nonce| {
+                Into::<u128>::into(nonce).saturating_sub(next.into()) > inner.limits.max_nonce_gap
+            };
+            if gap_too_large(nonce, next)
+                || item
+                    .cosigner_nonces()
+                    .into_iter()
+                    .any(|(cosigner, nonce)| gap_too_large(nonce, next_nonce(&cosigner)))
+            {
+                return Err(MemPoolError::NonceGapTooLarge);
+            }
+
+            let nonces = inner.by_sender.get(&sender);
+            replaced = nonces.and_then(|nonces| nonces.get(&nonce)).copied();
+            if replaced.is_none() && nonces.map_or(0, BTreeMap::len) >= inner.limits.max_items {
+                return Err(MemPoolError::SenderQueueFull);
+            }
+
+            let head = inner
+                .head(&sender)
+                .map_or(nonce, |(head, _)| head.min(nonce));
+            if head > next {
+                gapped_sender = Some(sender);
+            }
+        }
+
+        match replaced {
+            Some(replaced) => {
+                if inner.entries[&replaced].item.priority() > item.priority() {
+                    return Err(MemPoolError::Underpriced);
+                }
+                inner.remove(&replaced);
+            }
+            None if inner.entries.len() >= inner.max_size => {
+                if gapped_sender.is_some() || !inner.evict_gapped() {
+                    return Err(MemPoolError::Full);
+                }
+            }
+            None => {}
+        }
+
+        let seq = inner.next_seq;
+        inner.next_seq += 1;
+        inner.insert(item, seq);
+        if let Some(sender) = gapped_sender {
+            inner.park(&sender);
+        }
+        Ok(())
+    }
+
+    pub fn len(&self) -> usize {
+        lock(&self.inner).entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
     }
 }
 
+fn lock<T: MemPoolItem>(inner: &Mutex<Inner<T>>) -> MutexGuard<'_, Inner<T>> {
+    inner.lock().unwrap_or_else(|e| e.into_inner())
+}
+
 #[cfg(test)]
 mod tests {
-    use tokio::test;
+    use std::cell::{Cell, RefCell};
 
     use super::*;
 
+    impl MemPoolItem for u64 {
+        type Hash = u64;
+        type Nonce = u64;
+        type Sender = ();
+
+        fn hash(&self) -> u64 {
+            *self
+        }
+    }
+
+    #[derive(Debug, Clone, PartialEq, Eq)]
+    struct TestTx {
+        id: u64,
+        sender: u8,
+        nonce: u64,
+        priority: u64,
+        cosigners: Vec<(u8, u64)>,
+    }
+
+    impl TestTx {
+        fn new(id: u64, sender: u8, nonce: u64) -> Self {
+            Self {
+                id,
+                sender,
+                nonce,
+                priority: 0,
+                cosigners: Vec::new(),
+            }
+        }
+    }
+
+    impl MemPoolItem for TestTx {
+        type Hash = u64;
+        type Nonce = u64;
+        type Sender = u8;
+
+        fn hash(&self) -> u64 {
+            self.id
+        }
+
+        fn sender_nonce(&self) -> Option<(u8, u64)> {
+            Some((self.sender, self.nonce))
+        }
+
+        fn cosigner_nonces(&self) -> Vec<(u8, u64)> {
+            self.cosigners.clone()
+        }
+
+        fn priority(&self) -> u64 {
+            self.priority
+        }
+    }
+
+    fn pop_any(pool: &mut MemPool<u64>) -> Option<u64> {
+        pool.pop(|_| 0)
+    }
+
     #[test]
-    async fn test_mempool_new() {
+    fn test_mempool_new() {
         let (mut pool, _handle): (MemPool<u64>, _) = MemPool::new(10);
-        assert_eq!(pool.pop(), None);
+        assert_eq!(pop_any(&mut pool), None);
     }
 
     #[test]
-    async fn test_push_and_pop() {
+    fn test_push_and_pop() {
         let (mut pool, handle) = MemPool::new(10);
 
-        handle.push(1).await.unwrap();
+        handle.push(1, |_| 0).unwrap();
 
-        let item = pool.pop();
+        let item = pop_any(&mut pool);
         assert_eq!(item, Some(1));
-        assert_eq!(pool.pop(), None);
+        assert_eq!(pop_any(&mut pool), None);
     }
 
     #[test]
-    async fn test_multiple_push_pop() {
+    fn test_multiple_push_pop() {
         let (mut pool, handle) = MemPool::new(10);
 
-        handle.push(1).await.unwrap();
-        handle.push(2).await.unwrap();
-        handle.push(3).await.unwrap();
+        handle.push(1, |_| 0).unwrap();
+        handle.push(2, |_| 0).unwrap();
+        handle.push(3, |_| 0).unwrap();
 
-        assert_eq!(pool.pop(), Some(1));
-        assert_eq!(pool.pop(), Some(2));
-        assert_eq!(pool.pop(), Some(3));
-        assert_eq!(pool.pop(), None);
+        assert_eq!(pop_any(&mut pool), Some(1));
+        assert_eq!(pop_any(&mut pool), Some(2));
+        assert_eq!(pop_any(&mut pool), Some(3));
+        assert_eq!(pop_any(&mut pool), None);
     }
 
     #[test]
-    async fn test_pop_empty() {
+    fn test_pop_empty() {
         let (mut pool, _handle): (MemPool<u64>, _) = MemPool::new(10);
-        assert_eq!(pool.pop(), None);
+        assert_eq!(pop_any(&mut pool), None);
     }
 
     #[test]
-    async fn test_max_size() {
+    fn test_max_size() {
         let (mut pool, handle) = MemPool::new(2);
 
-        handle.push(1).await.unwrap();
-        handle.push(2).await.unwrap();
+        handle.push(1, |_| 0).unwrap();
+        handle.push(2, |_| 0).unwrap();
+        assert_eq!(handle.push(3, |_| 0), Err(MemPoolError::Full));
+
+        assert_eq!(pop_any(&mut pool), Some(1));
+        handle.push(3, |_| 0).unwrap();
+        assert_eq!(pop_any(&mut pool), Some(2));
+        assert_eq!(pop_any(&mut pool), Some(3));
+    }
+
+    #[test]
+    fn test_duplicates_are_rejected() {
+        let (mut pool, handle) = MemPool::new(10);
+
+        handle.push(1, |_| 0).unwrap();
+        assert_eq!(handle.push(1, |_| 0), Err(MemPoolError::Duplicate));
+        assert_eq!(handle.len(), 1);
 
-        // This should block if buffer is full, but we'll use try_send in a real scenario
-        // For now, just verify we can pop items
-        assert_eq!(pool.pop(), Some(1));
-        assert_eq!(pool.pop(), Some(2));
+        assert_eq!(pop_any(&mut pool), Some(1));
+        assert_eq!(pop_any(&mut pool), None);
     }
 
     #[test]
-    async fn test_push_front() {
+    fn test_push_front() {
         let (mut pool, handle) = MemPool::new(10);
 
-        handle.push(1).await.unwrap();
-        handle.push(2).await.unwrap();
+        handle.push(1, |_| 0).unwrap();
+        handle.push(2, |_| 0).unwrap();
 
         // Push items to the front - these should be popped first
         pool.push_front(10);
         pool.push_front(20);
 
         // Items pushed to front are popped in LIFO order
-        assert_eq!(pool.pop(), Some(20));
-        assert_eq!(pool.pop(), Some(10));
+        assert_eq!(pop_any(&mut pool), Some(20));
+        assert_eq!(pop_any(&mut pool), Some(10));
         // Original items are then popped in FIFO order
-        assert_eq!(pool.pop(), Some(1));
-        assert_eq!(pool.pop(), Some(2));
-        assert_eq!(pool.pop(), None);
+        assert_eq!(pop_any(&mut pool), Some(1));
+        assert_eq!(pop_any(&mut pool), Some(2));
+        assert_eq!(pop_any(&mut pool), None);
+    }
+
+    #[test]
+    fn test_sender_items_are_selected_in_nonce_order() {
+        let (mut pool, handle) = MemPool::new(10);
+        let next_nonces = RefCell::new(HashMap::from([(1u8, 0u64), (2, 5)]));
+        let next_nonce = |sender: &u8| next_nonces.borrow()[sender];
+
+        handle.push(TestTx::new(1, 1, 1), next_nonce).unwrap();
+        handle.push(TestTx::new(2, 2, 7), next_nonce).unwrap();
+        handle.push(TestTx::new(3, 1, 0), next_nonce).unwrap();
+        // Below the next nonce of sender 2, can never be included
+        handle.push(TestTx::new(4, 2, 4), next_nonce).unwrap();
+
+        let pop = |pool: &mut MemPool<TestTx>| {
+            let tx = pool.pop(next_nonce)?;
+            *next_nonces.borrow_mut().get_mut(&tx.sender).unwrap() += 1;
+            Some(tx.id)
+        };
+        assert_eq!(pop(&mut pool), Some(3));
+        assert_eq!(pop(&mut pool), Some(1));
+        // Nonce 6 of sender 2 is missing
+        assert_eq!(pop(&mut pool), None);
+        assert_eq!(pool.len(), 1);
+
+        handle.push(TestTx::new(5, 2, 5), next_nonce).unwrap();
+        handle.push(TestTx::new(6, 2, 6), next_nonce).unwrap();
+        assert_eq!(pop(&mut pool), Some(5));
+        assert_eq!(pop(&mut pool), Some(6));
+        assert_eq!(pop(&mut pool), Some(2));
+        assert!(pool.is_empty());
+    }
+
+    #[test]
+    fn test_higher_priority_is_selected_first() {
+        let (mut pool, handle) = MemPool::new(10);
+
+        handle.push(TestTx::new(1, 1, 0), |_| 0).unwrap();
+        handle
+            .push(
+                TestTx {
+                    priority: 5,
+                    ..TestTx::new(2, 2, 0)
+                },
+                |_| 0,
+            )
+            .unwrap();
+
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(2));
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(1));
+    }
+
+    #[test]
+    fn test_same_sender_and_nonce_replaces_item() {
+        let (mut pool, handle) = MemPool::new(1);
+
+        handle
+            .push(
+                TestTx {
+                    priority: 5,
+                    ..TestTx::new(1, 1, 0)
+                },
+                |_| 0,
+            )
+            .unwrap();
+        assert_eq!(
+            handle.push(TestTx::new(2, 1, 0), |_| 0),
+            Err(MemPoolError::Underpriced)
+        );
+
+        // Replacing does not need room in the pool
+        handle
+            .push(
+                TestTx {
+                    priority: 5,
+                    ..TestTx::new(3, 1, 0)
+                },
+                |_| 0,
+            )
+            .unwrap();
+        assert_eq!(pool.len(), 1);
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(3));
+    }
+
+    #[test]
+    fn test_nonce_gap_is_capped_at_admission() {
+        let limits = SenderLimits {
+            max_nonce_gap: 2,
+            ..SenderLimits::default()
+        };
+        let (_pool, handle) = MemPool::with_sender_limits(10, limits);
+
+        handle.push(TestTx::new(1, 1, 7), |_| 5).unwrap();
+        assert_eq!(
+            handle.push(TestTx::new(2, 1, 8), |_| 5),
+            Err(MemPoolError::NonceGapTooLarge)
+        );
+        assert_eq!(handle.len(), 1);
+    }
+
+    #[test]
+    fn test_sender_queue_is_capped_at_admission() {
+        let limits = SenderLimits {
+            max_items: 2,
+            ..SenderLimits::default()
+        };
+        let (_pool, handle) = MemPool::with_sender_limits(10, limits);
+
+        handle.push(TestTx::new(1, 1, 0), |_| 0).unwrap();
+        handle.push(TestTx::new(2, 1, 1), |_| 0).unwrap();
+        assert_eq!(
+            handle.push(TestTx::new(3, 1, 2), |_| 0),
+            Err(MemPoolError::SenderQueueFull)
+        );
+
+        // Replacing a queued nonce and other senders are not limited
+        handle
+            .push(
+                TestTx {
+                    priority: 1,
+                    ..TestTx::new(4, 1, 1)
+                },
+                |_| 0,
+            )
+            .unwrap();
+        handle.push(TestTx::new(5, 2, 0), |_| 0).unwrap();
+        assert_eq!(handle.len(), 3);
+    }
+
+    #[test]
+    fn test_gapped_items_expire() {
+        let limits = SenderLimits {
+            gapped_ttl: Duration::ZERO,
+            ..SenderLimits::default()
+        };
+        let (mut pool, handle) = MemPool::with_sender_limits(10, limits);
+
+        handle.push(TestTx::new(1, 1, 3), |_| 0).unwrap();
+        handle.push(TestTx::new(2, 2, 0), |_| 0).unwrap();
+
+        pool.recheck_gapped(|_| 0);
+        assert_eq!(pool.len(), 1);
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(2));
+    }
+
+    #[test]
+    fn test_gapped_items_are_kept_until_ttl() {
+        let (mut pool, handle) = MemPool::new(10);
+
+        handle.push(TestTx::new(1, 1, 1), |_| 0).unwrap();
+        pool.recheck_gapped(|_| 0);
+        assert_eq!(pool.pop(|_| 0), None);
+        assert_eq!(pool.len(), 1);
+
+        // The gap was closed by other means than an item of the sender
+        pool.recheck_gapped(|_| 1);
+        assert_eq!(pool.pop(|_| 1).map(|tx| tx.id), Some(1));
+    }
+
+    #[test]
+    fn test_full_pool_evicts_gapped_items_for_ready_ones() {
+        let (mut pool, handle) = MemPool::new(2);
+
+        handle.push(TestTx::new(1, 1, 0), |_| 0).unwrap();
+        handle.push(TestTx::new(2, 2, 5), |_| 0).unwrap();
+
+        // A gapped item does not evict another one
+        assert_eq!(
+            handle.push(TestTx::new(3, 3, 5), |_| 0),
+            Err(MemPoolError::Full)
+        );
+
+        handle.push(TestTx::new(4, 3, 0), |_| 0).unwrap();
+        assert_eq!(pool.len(), 2);
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(1));
+        assert_eq!(pool.pop(|_| 0).map(|tx| tx.id), Some(4));
+        assert_eq!(pool.pop(|_| 0), None);
+
+        // Ready items are never evicted
+        handle.push(TestTx::new(5, 1, 0), |_| 0).unwrap();
+        handle.push(TestTx::new(6, 2, 0), |_| 0).unwrap();
+        assert_eq!(
+            handle.push(TestTx::new(7, 3, 0), |_| 0),
+            Err(MemPoolError::Full)
+        );
+    }
+
+    #[test]
+    fn test_gapped_senders_are_not_checked_on_every_pop() {
+        let (mut pool, handle) = MemPool::new(10);
+        for sender in 0..5 {
+            handle
+                .push(TestTx::new(sender as u64, sender, 1), |_| 0)
+                .unwrap();
+        }
+        handle.push(TestTx::new(10, 10, 0), |_| 0).unwrap();
+        handle.push(TestTx::new(11, 11, 0), |_| 0).unwrap();
+
+        let lookups = Cell::new(0);
+        let next_nonce = |_: &u8| {
+            lookups.set(lookups.get() + 1);
+            0
+        };
+        assert_eq!(pool.pop(next_nonce).map(|tx| tx.id), Some(10));
+        assert_eq!(pool.pop(next_nonce).map(|tx| tx.id), Some(11));
+        assert_eq!(pool.pop(next_nonce), None);
+        assert_eq!(lookups.get(), 2);
+    }
+
+    #[test]
+    fn test_cosigned_items_wait_for_every_signer() {
+        let limits = SenderLimits {
+            max_nonce_gap: 2,
+            ..SenderLimits::default()
+        };
+        let (mut pool, handle) = MemPool::with_sender_limits(10, limits);
+        let cosigned = |id, cosigner_nonce| TestTx {
+            cosigners: vec![(2, cosigner_nonce)],
+            ..TestTx::new(id, 1, 0)
+        };
+
+        assert_eq!(
+            handle.push(cosigned(1, 3), |_| 0),
+            Err(MemPoolError::NonceGapTooLarge)
+        );
+
+        // The co-signer is ahead, the item waits like a gapped one
+        handle.push(cosigned(2, 1), |_| 0).unwrap();
+        assert_eq!(pool.pop(|_| 0), None);
+        assert_eq!(pool.len(), 1);
+
+        let cosigner_moved = |sender: &u8| u64::from(*sender == 2);
+        pool.recheck_gapped(cosigner_moved);
+        assert_eq!(pool.pop(cosigner_moved).map(|tx| tx.id), Some(2));
+
+        // The co-signer is behind, the item can never be included
+        handle.push(cosigned(3, 0), |_| 0).unwrap();
+        assert_eq!(pool.pop(cosigner_moved), None);
+        assert!(pool.is_empty());
     }
 }
@@ -0,0 +1,64 @@
+//! Benchmarks of the commitment Merkle tree at 2^10 to 2^24 leaves.
+
+use std::hint::black_box;
+
+use criterion::{BenchmarkId, Criterion, criterion_group, criterion_main};
+use nssa::bench_support::MerkleTree;
+
+const LOG_SIZES: [u32; 5] = [10, 14, 18, 20, 24];
+
+fn value(index: usize) -> [u8; 32] {
+    let mut value = [0; 32];
+    value[..8].copy_from_slice(&(index as u64).to_le_bytes());
+    value
+}
+
+fn tree_with_leaves(count: usize, capacity: usize) -> MerkleTree {
+    let values = (0..count).map(value).collect::<Vec<_>>();
+    let mut tree = MerkleTree::with_capacity(capacity);
+    tree.extend(&values);
+    tree
+}
+
+fn insert(c: &mut Criterion) {
+    let mut group = c.benchmark_group("merkle_tree_insert");
+
+    for log_size in LOG_SIZES {
+        let count = 1 << log_size;
+        // Room for the inserted leaves, so growing the tree is not part of the timing
+        let mut tree = tree_with_leaves(count, 2 * count);
+        let mut next_index = count;
+
+        group.bench_function(BenchmarkId::from_parameter(format!("2^{log_size}")), |b| {
+            b.iter(|| {
+                next_index += 1;
+                tree.insert(black_box(value(next_index)))
+            })
+        });
+    }
+
+    group.finish();
+}
+
+fn authentication_path(c: &mut Criterion) {
+    let mut group = c.benchmark_group("merkle_tree_get_authentication_path_for");
+
+    for log_size in LOG_SIZES {
+        let count = 1 << log_size;
+        let tree = tree_with_leaves(count, count);
+        let mut index = 0;
+
+        group.bench_function(BenchmarkId::from_parameter(format!("2^{log_size}")), |b| {
+            b.iter(|| {
+                // Spread lookups over the tree instead of hitting the same cached path
+                index = (index * 7919 + 1) % count;
+                tree.get_authentication_path_for(black_box(index)).unwrap()
+            })
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, insert, authentication_path);
+criterion_main!(benches);
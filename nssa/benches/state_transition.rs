@@ -0,0 +1,129 @@
+//! Benchmarks of applying transactions to the state.
+//!
+//! The privacy preserving transaction is proven once before measuring, which takes a while.
+//! With `RISC0_DEV_MODE=1` proving is skipped, and so is the proof check of the transition.
+
+use std::hint::black_box;
+
+use criterion::{BatchSize, Criterion, criterion_group, criterion_main};
+use nssa::{
+    AccountId, PrivacyPreservingTransaction, PrivateKey, PublicKey, PublicTransaction, V02State,
+    privacy_preserving_transaction::{Message, WitnessSet, circuit},
+    program::Program,
+    public_transaction,
+};
+use nssa_core::{
+    NullifierPublicKey, SharedSecretKey,
+    account::{Account, AccountWithMetadata},
+    encryption::{EphemeralPublicKey, ViewingPublicKey},
+};
+
+const SENDER_BALANCE: u128 = 1_000_000;
+
+fn sender_key() -> PrivateKey {
+    PrivateKey::try_new([37; 32]).unwrap()
+}
+
+fn account_id(key: &PrivateKey) -> AccountId {
+    AccountId::from(&PublicKey::new_from_private_key(key))
+}
+
+fn transfer_transaction(
+    from_key: &PrivateKey,
+    nonce: u128,
+    to: AccountId,
+    balance: u128,
+) -> PublicTransaction {
+    let account_ids = vec![account_id(from_key), to];
+    let program_id = Program::authenticated_transfer_program().id();
+    let message =
+        public_transaction::Message::try_new(program_id, account_ids, vec![nonce], balance)
+            .unwrap();
+    let witness_set = public_transaction::WitnessSet::for_message(&message, &[from_key]);
+    PublicTransaction::new(message, witness_set)
+}
+
+fn shielded_transfer_transaction(
+    sender_key: &PrivateKey,
+    balance: u128,
+    state: &V02State,
+) -> PrivacyPreservingTransaction {
+    let sender_id = account_id(sender_key);
+    let sender = AccountWithMetadata::new(state.get_account_by_id(sender_id), true, sender_id);
+    let sender_nonce = sender.account.nonce;
+
+    let recipient_npk = NullifierPublicKey::from(&[13; 32]);
+    let recipient_vpk = ViewingPublicKey::from_scalar([31; 32]);
+    let recipient = AccountWithMetadata::new(Account::default(), false, &recipient_npk);
+
+    let esk = [3; 32];
+    let shared_secret = SharedSecretKey::new(&esk, &recipient_vpk);
+    let epk = EphemeralPublicKey::from_scalar(esk);
+
+    let (output, proof) = circuit::execute_and_prove(
+        vec![sender, recipient],
+        Program::serialize_instruction(balance).unwrap(),
+        vec![0, 2],
+        vec![0xdeadbeef],
+        vec![(recipient_npk.clone(), shared_secret)],
+        vec![],
+        vec![None],
+        &Program::authenticated_transfer_program().into(),
+    )
+    .unwrap();
+
+    let message = Message::try_from_circuit_output(
+        vec![sender_id],
+        vec![sender_nonce],
+        vec![(recipient_npk, recipient_vpk, epk)],
+        output,
+    )
+    .unwrap();
+
+    let witness_set = WitnessSet::for_message(&message, proof, &[sender_key]);
+    PrivacyPreservingTransaction::new(message, witness_set)
+}
+
+fn public_transition(c: &mut Criterion) {
+    let sender_key = sender_key();
+    let state =
+        V02State::new_with_genesis_accounts(&[(account_id(&sender_key), SENDER_BALANCE)], &[]);
+    let tx = transfer_transaction(&sender_key, 0, AccountId::new([42; 32]), 10);
+
+    c.bench_function("transition_from_public_transaction", |b| {
+        b.iter_batched_ref(
+            || state.clone(),
+            |state| {
+                state
+                    .transition_from_public_transaction(black_box(&tx))
+                    .unwrap()
+            },
+            BatchSize::SmallInput,
+        )
+    });
+}
+
+fn privacy_preserving_transition(c: &mut Criterion) {
+    let sender_key = sender_key();
+    let state =
+        V02State::new_with_genesis_accounts(&[(account_id(&sender_key), SENDER_BALANCE)], &[]);
+    let tx = shielded_transfer_transaction(&sender_key, 10, &state);
+
+    let mut group = c.benchmark_group("transition_from_privacy_preserving_transaction");
+    group.sample_size(10);
+    group.bench_function("shielded_transfer", |b| {
+        b.iter_batched_ref(
+            || state.clone(),
+            |state| {
+                state
+                    .transition_from_privacy_preserving_transaction(black_box(&tx))
+                    .unwrap()
+            },
+            BatchSize::SmallInput,
+        )
+    });
+    group.finish();
+}
+
+criterion_group!(benches, public_transition, privacy_preserving_transition);
+criterion_main!(benches);
@@ -12,6 +12,12 @@ pub mod public_transaction;
 mod signature;
 mod state;
 
+/// Internals reached by the benchmarks, not part of the API
+#[cfg(feature = "bench")]
+pub mod bench_support {
+    pub use crate::merkle_tree::MerkleTree;
+}
+
 pub use nssa_core::{
     SharedSecretKey,
     account::{Account, AccountId, Data},
@@ -24,5 +30,5 @@ pub use privacy_preserving_transaction::{
 pub use program_deployment_transaction::ProgramDeploymentTransaction;
 pub use program_methods::PRIVACY_PRESERVING_CIRCUIT_ID;
 pub use public_transaction::PublicTransaction;
-pub use signature::{PrivateKey, PublicKey, Signature};
-pub use state::V02State;
+pub use signature::{PrivateKey, PublicKey, Signature, SignatureBatch};
+pub use state::{DEFAULT_ROOT_HISTORY_WINDOW, StateDiff, V02State};
@@ -1,4 +1,5 @@
 use borsh::{BorshDeserialize, BorshSerialize};
+use rayon::prelude::*;
 use sha2::{Digest, Sha256};
 
 mod default_values;
@@ -20,30 +21,37 @@ fn hash_value(value: &Value) -> Node {
     hasher.finalize().into()
 }
 
+/// Min number of nodes hashed by one task when batch insertion hashes a level in parallel
+const PARALLEL_HASH_MIN_NODES: usize = 1024;
+
+/// Compute `count` nodes with `node`, spread over the available cores for large counts
+fn hash_nodes(count: usize, node: impl Fn(usize) -> Node + Send + Sync) -> Vec<Node> {
+    (0..count)
+        .into_par_iter()
+        .with_min_len(PARALLEL_HASH_MIN_NODES)
+        .map(node)
+        .collect()
+}
+
+/// Append-only Merkle tree over the inserted values.
+///
+/// Only nodes covering at least one inserted value are stored, level by level, so the tree grows
+/// by appending to each level instead of reallocating. Nodes covering no value have the default
+/// value of their level.
 #[cfg_attr(test, derive(Debug, PartialEq, Eq))]
-#[derive(Clone, BorshSerialize, BorshDeserialize)]
+#[derive(Clone)]
 pub struct MerkleTree {
-    nodes: Vec<Node>,
-    capacity: usize,
+    /// Nodes of each level, starting from the leaves
+    levels: Vec<Vec<Node>>,
     length: usize,
 }
 
+/// Serialized in place of the capacity of the legacy full tree layout, to tell the layouts apart.
+const SPARSE_LAYOUT_MARKER: u64 = u64::MAX;
+
 impl MerkleTree {
     pub fn root(&self) -> Node {
-        let root_index = self.root_index();
-        *self.get_node(root_index)
-    }
-
-    fn root_index(&self) -> usize {
-        let tree_depth = self.depth();
-        let capacity_depth = self.capacity.trailing_zeros() as usize;
-
-        if tree_depth == capacity_depth {
-            0
-        } else {
-            // 2^(capacity_depth - tree_depth) - 1
-            (1 << (capacity_depth - tree_depth)) - 1
-        }
+        self.node(self.depth(), 0)
     }
 
     /// Number of levels required to hold all nodes
@@ -51,78 +59,96 @@ impl MerkleTree {
         self.length.next_power_of_two().trailing_zeros() as usize
     }
 
-    fn get_node(&self, index: usize) -> &Node {
-        &self.nodes[index]
+    fn node(&self, level: usize, index: usize) -> Node {
+        self.levels
+            .get(level)
+            .and_then(|nodes| nodes.get(index))
+            .copied()
+            .unwrap_or(default_values::DEFAULT_VALUES[level])
     }
 
-    fn set_node(&mut self, index: usize, node: Node) {
-        self.nodes[index] = node;
+    /// Replace the nodes of `level` from index `start` on with `nodes`
+    fn set_nodes_from(&mut self, level: usize, start: usize, nodes: Vec<Node>) {
+        if self.levels.len() == level {
+            self.levels.push(Vec::new());
+        }
+
+        let level_nodes = &mut self.levels[level];
+        level_nodes.truncate(start);
+        level_nodes.extend(nodes);
     }
 
+    /// Empty tree with room for `capacity` values before leaves are reallocated.
     pub fn with_capacity(capacity: usize) -> Self {
-        // Adjust capacity to ensure power of two
-        let capacity = capacity.next_power_of_two();
-        let total_depth = capacity.trailing_zeros() as usize;
-
-        let nodes = default_values::DEFAULT_VALUES[..(total_depth + 1)]
-            .iter()
-            .rev()
-            .enumerate()
-            .flat_map(|(level, default_value)| std::iter::repeat_n(default_value, 1 << level))
-            .cloned()
-            .collect();
-
         Self {
-            nodes,
-            capacity,
+            levels: vec![Vec::with_capacity(capacity)],
             length: 0,
         }
     }
 
-    /// Reallocates storage of Merkle tree for double capacity.
-    /// The current tree is embedded into the new tree as a subtree
-    fn reallocate_to_double_capacity(&mut self) {
-        let old_capacity = self.capacity;
-        let new_capacity = old_capacity << 1;
-
-        let mut this = Self::with_capacity(new_capacity);
+    pub fn insert(&mut self, value: Value) -> usize {
+        self.extend(std::slice::from_ref(&value))
+    }
 
-        for (index, value) in self.nodes.iter().enumerate() {
-            let offset = prev_power_of_two(index + 1);
-            let new_index = index + offset;
-            this.set_node(new_index, *value);
+    /// Inserts `values` in order and returns the index of the first one.
+    ///
+    /// Every internal node above the new values is hashed once, level by level, which gives the
+    /// same tree as inserting the values one by one.
+    pub fn extend(&mut self, values: &[Value]) -> usize {
+        let first_index = self.length;
+        if values.is_empty() {
+            return first_index;
         }
 
-        this.length = self.length;
+        // Insert the new nodes at the bottom layer
+        let leaves = hash_nodes(values.len(), |i| hash_value(&values[i]));
+        self.set_nodes_from(0, first_index, leaves);
+        self.length += values.len();
+
+        // Update upper levels above the newly inserted nodes
+        let mut start = first_index;
+        let mut end = self.length - 1;
+        for level in 1..=self.depth() {
+            start >>= 1;
+            end >>= 1;
+
+            let parents = hash_nodes(end - start + 1, |i| {
+                let parent_index = start + i;
+                let left_child = self.node(level - 1, parent_index << 1);
+                let right_child = self.node(level - 1, (parent_index << 1) + 1);
+                hash_two(&left_child, &right_child)
+            });
+            self.set_nodes_from(level, start, parents);
+        }
 
-        *self = this;
+        first_index
     }
 
-    pub fn insert(&mut self, value: Value) -> usize {
-        if self.length == self.capacity {
-            self.reallocate_to_double_capacity();
+    /// Removes the values from index `length` on, giving the tree as it was before they were
+    /// inserted.
+    pub fn truncate(&mut self, length: usize) {
+        if length >= self.length {
+            return;
         }
 
-        let new_index = self.length;
-
-        let mut node_index = new_index + self.capacity - 1;
-        let mut node_hash = hash_value(&value);
-
-        // Insert the new node at the bottom layer
-        self.set_node(node_index, node_hash);
-        self.length += 1;
+        self.length = length;
+        self.levels.truncate(self.depth() + 1);
+        for (level, level_length) in Self::level_lengths(length).enumerate() {
+            self.levels[level].truncate(level_length);
+        }
 
-        // Update upper levels for the newly inserted node
-        for _ in 0..self.depth() {
-            let parent_index = (node_index - 1) >> 1;
-            let left_child = self.get_node((parent_index << 1) + 1);
-            let right_child = self.get_node((parent_index << 1) + 2);
-            node_hash = hash_two(left_child, right_child);
-            self.set_node(parent_index, node_hash);
-            node_index = parent_index;
+        if length == 0 {
+            return;
         }
 
-        new_index
+        // Only the last node of each level covered removed values
+        let last_index = length - 1;
+        for level in 1..=self.depth() {
+            let parent_index = last_index >> level;
+            let left_child = self.node(level - 1, parent_index << 1);
+            let right_child = self.node(level - 1, (parent_index << 1) + 1);
+            self.levels[level][parent_index] = hash_two(&left_child, &right_child);
+        }
     }
 
     pub fn get_authentication_path_for(&self, index: usize) -> Option<Vec<Node>> {
@@ -130,33 +156,95 @@ impl MerkleTree {
             return None;
         }
 
-        let mut path = Vec::with_capacity(self.depth());
+        let path = (0..self.depth())
+            .map(|level| {
+                // Siblings differ only in the lowest bit of their index
+                self.node(level, (index >> level) ^ 1)
+            })
+            .collect();
+
+        Some(path)
+    }
 
-        let mut node_index = self.capacity + index - 1;
-        let root_index = self.root_index();
+    /// Number of stored nodes of each level for a tree holding `length` values
+    fn level_lengths(length: usize) -> impl Iterator<Item = usize> {
+        let levels = length.next_power_of_two().trailing_zeros() as usize + 1;
+        (0..levels).map(move |level| length.div_ceil(1 << level))
+    }
 
-        while node_index != root_index {
-            let parent_index = (node_index - 1) >> 1;
-            // Left children have odd indices, and right children have even indices
-            let is_left_child = node_index & 1 == 1;
-            let sibling_index = if is_left_child {
-                node_index + 1
-            } else {
-                node_index - 1
-            };
-            path.push(*self.get_node(sibling_index));
-            node_index = parent_index;
+    /// Rebuild from the legacy layout, storing every node of a full tree of `capacity` leaves.
+    fn from_full_tree(nodes: &[Node], capacity: usize, length: usize) -> std::io::Result<Self> {
+        let capacity_depth = capacity.trailing_zeros() as usize;
+        if !capacity.is_power_of_two() || nodes.len() != 2 * capacity - 1 || length > capacity {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "Malformed Merkle tree",
+            ));
         }
 
-        Some(path)
+        let levels = Self::level_lengths(length)
+            .enumerate()
+            .map(|(level, level_length)| {
+                // Nodes of a level start after the 2^(capacity_depth - level) - 1 nodes above it
+                let start = (1 << (capacity_depth - level)) - 1;
+                nodes[start..start + level_length].to_vec()
+            })
+            .collect();
+
+        Ok(Self { levels, length })
     }
 }
 
-fn prev_power_of_two(x: usize) -> usize {
-    if x == 0 {
-        return 0;
+impl BorshSerialize for MerkleTree {
+    fn serialize<W: std::io::Write>(&self, writer: &mut W) -> std::io::Result<()> {
+        // Same encoding as a `Vec<Node>` of all levels, without collecting them
+        let node_count = self.levels.iter().map(Vec::len).sum::<usize>();
+        u32::try_from(node_count)
+            .map_err(|_| {
+                std::io::Error::new(std::io::ErrorKind::InvalidInput, "Merkle tree too large")
+            })?
+            .serialize(writer)?;
+        for node in self.levels.iter().flatten() {
+            writer.write_all(node)?;
+        }
+        SPARSE_LAYOUT_MARKER.serialize(writer)?;
+        (self.length as u64).serialize(writer)
+    }
+}
+
+impl BorshDeserialize for MerkleTree {
+    fn deserialize_reader<R: std::io::Read>(reader: &mut R) -> std::io::Result<Self> {
+        let nodes = Vec::<Node>::deserialize_reader(reader)?;
+        let layout = u64::deserialize_reader(reader)?;
+        let length = u64::deserialize_reader(reader)? as usize;
+
+        if layout != SPARSE_LAYOUT_MARKER {
+            return Self::from_full_tree(&nodes, layout as usize, length);
+        }
+
+        let mut remaining = nodes.as_slice();
+        let mut levels = Vec::new();
+        for level_length in Self::level_lengths(length) {
+            if remaining.len() < level_length {
+                return Err(std::io::Error::new(
+                    std::io::ErrorKind::InvalidData,
+                    "Malformed Merkle tree",
+                ));
+            }
+            let (level, rest) = remaining.split_at(level_length);
+            levels.push(level.to_vec());
+            remaining = rest;
+        }
+
+        if !remaining.is_empty() {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "Malformed Merkle tree",
+            ));
+        }
+
+        Ok(Self { levels, length })
     }
-    1 << (usize::BITS as usize - x.leading_zeros() as usize - 1)
 }
 
 #[cfg(test)]
@@ -180,7 +268,6 @@ mod tests {
         let expected_root =
             hex!("0000000000000000000000000000000000000000000000000000000000000000");
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 4);
         assert_eq!(tree.length, 0);
     }
 
@@ -189,7 +276,7 @@ mod tests {
         let values = [[0; 32]];
         let tree = MerkleTree::new(&values);
         assert_eq!(tree.root(), hash_value(&[0; 32]));
-        assert_eq!(tree.capacity, 1);
+        assert_eq!(tree.depth(), 0);
         assert_eq!(tree.length, 1);
     }
 
@@ -200,7 +287,7 @@ mod tests {
         let expected_root =
             hex!("48c73f7821a58a8d2a703e5b39c571c0aa20cf14abcd0af8f2b955bc202998de");
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 4);
+        assert_eq!(tree.depth(), 2);
         assert_eq!(tree.length, 4)
     }
 
@@ -211,7 +298,7 @@ mod tests {
         let expected_root =
             hex!("c9bbb83096df85157a146e7d770455a98412dee0633187ee86fee6c8a45b831a");
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 4);
+        assert_eq!(tree.depth(), 2);
         assert_eq!(tree.length, 4);
     }
 
@@ -222,7 +309,7 @@ mod tests {
         let expected_root =
             hex!("c8d3d8d2b13f27ceeccdc699119871f9f32ea7ed86ff45d0ad11f77b28cd7568");
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 4);
+        assert_eq!(tree.depth(), 2);
         assert_eq!(tree.length, 3);
     }
 
@@ -234,7 +321,7 @@ mod tests {
             hex!("ef418aed5aa20702d4d94c92da79a4012f2e36f1008bfdb3cd1e38749dca2499");
 
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 8);
+        assert_eq!(tree.depth(), 3);
         assert_eq!(tree.length, 5);
     }
 
@@ -248,7 +335,7 @@ mod tests {
         let expected_root =
             hex!("3f72d2ff55921a86c48e5988ec3e19ee9d0d5aa3e23197842970a903508ed767");
         assert_eq!(tree.root(), expected_root);
-        assert_eq!(tree.capacity, 16);
+        assert_eq!(tree.depth(), 4);
         assert_eq!(tree.length, 11);
     }
 
@@ -262,36 +349,59 @@ mod tests {
     }
 
     #[test]
-    fn test_with_capacity_4() {
+    fn test_empty_tree_has_default_nodes() {
         let tree = MerkleTree::with_capacity(4);
 
         assert_eq!(tree.length, 0);
-        assert_eq!(tree.nodes.len(), 7);
-        for i in 3..7 {
-            assert_eq!(*tree.get_node(i), default_values::DEFAULT_VALUES[0], "{i}");
-        }
-        for i in 1..3 {
-            assert_eq!(*tree.get_node(i), default_values::DEFAULT_VALUES[1], "{i}");
+        for level in 0..3 {
+            for i in 0..(4 >> level) {
+                assert_eq!(
+                    tree.node(level, i),
+                    default_values::DEFAULT_VALUES[level],
+                    "{level} {i}"
+                );
+            }
         }
-        assert_eq!(*tree.get_node(0), default_values::DEFAULT_VALUES[2]);
     }
 
     #[test]
-    fn test_with_capacity_5() {
-        let tree = MerkleTree::with_capacity(5);
+    fn test_only_nodes_covering_values_are_stored() {
+        let tree = MerkleTree::new(&[[1; 32], [2; 32], [3; 32], [4; 32], [5; 32]]);
 
-        assert_eq!(tree.length, 0);
-        assert_eq!(tree.nodes.len(), 15);
-        for i in 7..15 {
-            assert_eq!(*tree.get_node(i), default_values::DEFAULT_VALUES[0])
-        }
-        for i in 3..7 {
-            assert_eq!(*tree.get_node(i), default_values::DEFAULT_VALUES[1])
-        }
-        for i in 1..3 {
-            assert_eq!(*tree.get_node(i), default_values::DEFAULT_VALUES[2])
-        }
-        assert_eq!(*tree.get_node(0), default_values::DEFAULT_VALUES[3])
+        let level_lengths: Vec<usize> = tree.levels.iter().map(Vec::len).collect();
+        assert_eq!(level_lengths, vec![5, 3, 2, 1]);
+        assert_eq!(tree.node(0, 5), default_values::DEFAULT_VALUES[0]);
+        assert_eq!(tree.node(1, 3), default_values::DEFAULT_VALUES[1]);
+    }
+
+    #[test]
+    fn test_borsh_roundtrip() {
+        let tree = MerkleTree::new(&[[1; 32], [2; 32], [3; 32], [4; 32], [5; 32]]);
+
+        let bytes = borsh::to_vec(&tree).unwrap();
+        let decoded = borsh::from_slice::<MerkleTree>(&bytes).unwrap();
+
+        assert_eq!(decoded, tree);
+        assert!(borsh::from_slice::<MerkleTree>(&bytes[..bytes.len() - 40]).is_err());
+    }
+
+    #[test]
+    fn test_legacy_full_tree_layout_is_decoded() {
+        let tree = MerkleTree::new(&[[1; 32], [2; 32], [3; 32]]);
+
+        // Every node of a full tree of capacity 8, root first
+        let capacity = 8usize;
+        let nodes: Vec<Node> = (0..=3)
+            .rev()
+            .flat_map(|level| (0..(capacity >> level)).map(move |i| (level, i)))
+            .map(|(level, i)| tree.node(level, i))
+            .collect();
+        let bytes = borsh::to_vec(&(nodes, capacity as u64, 3u64)).unwrap();
+
+        let decoded = borsh::from_slice::<MerkleTree>(&bytes).unwrap();
+
+        assert_eq!(decoded, tree);
+        assert_eq!(decoded.root(), tree.root());
     }
 
     #[test]
@@ -388,6 +498,51 @@ mod tests {
         assert_eq!(expected_tree, tree);
     }
 
+    #[test]
+    fn test_extend_matches_sequential_insertion() {
+        let values: Vec<Value> = (0..3000u32)
+            .map(|i| {
+                let mut value = [0; 32];
+                value[..4].copy_from_slice(&i.to_le_bytes());
+                value
+            })
+            .collect();
+
+        let mut sequential = MerkleTree::with_capacity(1);
+        for value in &values {
+            sequential.insert(*value);
+        }
+
+        // Batches crossing powers of two, and one above the parallel hashing threshold
+        let mut batched = MerkleTree::with_capacity(1);
+        let mut inserted = 0;
+        for batch_len in [1, 2, 5, 0, 9, 2000, 983] {
+            let batch = &values[inserted..inserted + batch_len];
+            assert_eq!(batched.extend(batch), inserted);
+            inserted += batch_len;
+            assert_eq!(batched.length, inserted);
+        }
+
+        assert_eq!(batched, sequential);
+        assert_eq!(batched.root(), sequential.root());
+        assert_eq!(
+            batched.get_authentication_path_for(1234),
+            sequential.get_authentication_path_for(1234)
+        );
+    }
+
+    #[test]
+    fn test_truncate_matches_shorter_tree() {
+        let values: Vec<Value> = (0..20u8).map(|i| [i; 32]).collect();
+
+        for length in [0, 1, 4, 5, 8, 13, 20] {
+            let mut tree = MerkleTree::new(&values);
+            tree.truncate(length);
+
+            assert_eq!(tree, MerkleTree::new(&values[..length]));
+        }
+    }
+
     // Reference implementation
     fn verify_authentication_path(value: &Value, index: usize, path: &[Node], root: &Node) -> bool {
         let mut result = hash_value(value);
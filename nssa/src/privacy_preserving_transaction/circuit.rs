@@ -1,4 +1,8 @@
-use std::collections::{HashMap, VecDeque};
+use std::{
+    collections::{HashMap, VecDeque},
+    sync::{Arc, OnceLock},
+    time::{Duration, Instant},
+};
 
 use borsh::{BorshDeserialize, BorshSerialize};
 use nssa_core::{
@@ -7,10 +11,11 @@ use nssa_core::{
     account::AccountWithMetadata,
     program::{ChainedCall, InstructionData, ProgramId, ProgramOutput},
 };
-use risc0_zkvm::{ExecutorEnv, InnerReceipt, ProverOpts, Receipt, default_prover};
+use risc0_zkvm::{ExecutorEnv, InnerReceipt, ProverOpts, Receipt, default_executor};
 
 use crate::{
     error::NssaError,
+    privacy_preserving_transaction::prover::{DefaultProvingBackend, ProvingBackend, ReceiptCache},
     program::Program,
     program_methods::{PRIVACY_PRESERVING_CIRCUIT_ELF, PRIVACY_PRESERVING_CIRCUIT_ID},
     state::MAX_NUMBER_CHAINED_CALLS,
@@ -52,119 +57,297 @@ impl From<Program> for ProgramWithDependencies {
     }
 }
 
-/// Generates a proof of the execution of a NSSA program inside the privacy preserving execution
-/// circuit.
-#[expect(clippy::too_many_arguments, reason = "TODO: fix later")]
-pub fn execute_and_prove(
-    pre_states: Vec<AccountWithMetadata>,
-    instruction_data: InstructionData,
-    visibility_mask: Vec<u8>,
-    private_account_nonces: Vec<u128>,
-    private_account_keys: Vec<(NullifierPublicKey, SharedSecretKey)>,
-    private_account_nsks: Vec<NullifierSecretKey>,
-    private_account_membership_proofs: Vec<Option<MembershipProof>>,
-    program_with_dependencies: &ProgramWithDependencies,
-) -> Result<(PrivacyPreservingCircuitOutput, Proof), NssaError> {
-    let ProgramWithDependencies {
-        program,
-        dependencies,
-    } = program_with_dependencies;
-    let mut env_builder = ExecutorEnv::builder();
-    let mut program_outputs = Vec::new();
+/// Default number of program proofs generated at the same time by a [`CircuitProver`].
+pub const DEFAULT_MAX_PARALLEL_PROOFS: usize = 4;
 
-    let initial_call = ChainedCall {
-        program_id: program.id(),
-        instruction_data: instruction_data.clone(),
-        pre_states,
-        pda_seeds: vec![],
-    };
+/// Generates proofs of the privacy preserving execution circuit.
+///
+/// All chained calls are executed first, which is cheap, to discover the call tree. The program
+/// proofs are independent of each other and are then generated concurrently, before the outer
+/// circuit is proven with them as assumptions.
+#[derive(Clone)]
+pub struct CircuitProver {
+    backend: Arc<dyn ProvingBackend>,
+    receipt_cache: Option<Arc<ReceiptCache>>,
+    max_parallel_proofs: usize,
+}
+
+impl Default for CircuitProver {
+    fn default() -> Self {
+        Self::new(Arc::new(DefaultProvingBackend))
+    }
+}
+
+/// A chained call, its program and, if already known, its receipt.
+struct ProgramCall<'a> {
+    program: &'a Program,
+    call: ChainedCall,
+    receipt: Option<Receipt>,
+}
+
+impl CircuitProver {
+    pub fn new(backend: Arc<dyn ProvingBackend>) -> Self {
+        Self {
+            backend,
+            receipt_cache: None,
+            max_parallel_proofs: DEFAULT_MAX_PARALLEL_PROOFS,
+        }
+    }
+
+    /// Generate all proofs with `backend`.
+    pub fn with_backend(mut self, backend: Arc<dyn ProvingBackend>) -> Self {
+        self.backend = backend;
+        self
+    }
 
-    let mut chained_calls = VecDeque::from_iter([(initial_call, program)]);
-    let mut chain_calls_counter = 0;
-    while let Some((chained_call, program)) = chained_calls.pop_front() {
-        if chain_calls_counter >= MAX_NUMBER_CHAINED_CALLS {
-            return Err(NssaError::MaxChainedCallsDepthExceeded);
+    /// Reuse program receipts from `cache` and store new ones in it.
+    pub fn with_receipt_cache(mut self, cache: Arc<ReceiptCache>) -> Self {
+        self.receipt_cache = Some(cache);
+        self
+    }
+
+    /// Limit the number of program proofs generated at the same time, `1` proves them one by one.
+    pub fn with_max_parallel_proofs(mut self, max_parallel_proofs: usize) -> Self {
+        self.max_parallel_proofs = max_parallel_proofs.max(1);
+        self
+    }
+
+    /// Generates a proof of the execution of a NSSA program inside the privacy preserving
+    /// execution circuit.
+    #[expect(clippy::too_many_arguments, reason = "TODO: fix later")]
+    pub fn execute_and_prove(
+        &self,
+        pre_states: Vec<AccountWithMetadata>,
+        instruction_data: InstructionData,
+        visibility_mask: Vec<u8>,
+        private_account_nonces: Vec<u128>,
+        private_account_keys: Vec<(NullifierPublicKey, SharedSecretKey)>,
+        private_account_nsks: Vec<NullifierSecretKey>,
+        private_account_membership_proofs: Vec<Option<MembershipProof>>,
+        program_with_dependencies: &ProgramWithDependencies,
+    ) -> Result<(PrivacyPreservingCircuitOutput, Proof), NssaError> {
+        let initial_call = ChainedCall {
+            program_id: program_with_dependencies.program.id(),
+            instruction_data,
+            pre_states,
+            pda_seeds: vec![],
+        };
+
+        let (mut calls, program_outputs) =
+            self.execute_chained_calls(initial_call, program_with_dependencies)?;
+        self.prove_programs(&mut calls)?;
+
+        let mut env_builder = ExecutorEnv::builder();
+        for call in calls {
+            env_builder.add_assumption(call.receipt.expect("All programs were proven"));
         }
 
-        let inner_receipt = execute_and_prove_program(
-            program,
-            &chained_call.pre_states,
-            &chained_call.instruction_data,
-        )?;
+        let circuit_input = PrivacyPreservingCircuitInput {
+            program_outputs,
+            visibility_mask,
+            private_account_nonces,
+            private_account_keys,
+            private_account_nsks,
+            private_account_membership_proofs,
+            program_id: program_with_dependencies.program.id(),
+        };
 
-        let program_output: ProgramOutput = inner_receipt
+        env_builder.write(&circuit_input).unwrap();
+        let env = env_builder.build().unwrap();
+        let receipt = self
+            .backend
+            .prove(env, PRIVACY_PRESERVING_CIRCUIT_ELF, &ProverOpts::succinct())
+            .map_err(|e| NssaError::CircuitProvingError(e.to_string()))?;
+
+        let proof = Proof(borsh::to_vec(&receipt.inner)?);
+
+        let circuit_output: PrivacyPreservingCircuitOutput = receipt
             .journal
             .decode()
-            .map_err(|e| NssaError::ProgramOutputDeserializationError(e.to_string()))?;
+            .map_err(|e| NssaError::CircuitOutputDeserializationError(e.to_string()))?;
+
+        Ok((circuit_output, proof))
+    }
 
-        // TODO: remove clone
-        program_outputs.push(program_output.clone());
+    /// Execute the call tree depth first, in the order the circuit expects the outputs.
+    ///
+    /// Calls with a cached receipt take their output from its journal instead of being executed.
+    fn execute_chained_calls<'a>(
+        &self,
+        initial_call: ChainedCall,
+        program_with_dependencies: &'a ProgramWithDependencies,
+    ) -> Result<(Vec<ProgramCall<'a>>, Vec<ProgramOutput>), NssaError> {
+        let ProgramWithDependencies {
+            program,
+            dependencies,
+        } = program_with_dependencies;
+
+        let mut calls = Vec::new();
+        let mut program_outputs = Vec::new();
+
+        let mut chained_calls = VecDeque::from_iter([(initial_call, program)]);
+        while let Some((chained_call, program)) = chained_calls.pop_front() {
+            if calls.len() >= MAX_NUMBER_CHAINED_CALLS {
+                return Err(NssaError::MaxChainedCallsDepthExceeded);
+            }
+
+            let receipt = self.receipt_cache.as_ref().and_then(|cache| {
+                cache.get(&ReceiptCache::key(
+                    program,
+                    &chained_call.pre_states,
+                    &chained_call.instruction_data,
+                ))
+            });
+            let program_output: ProgramOutput = match &receipt {
+                Some(receipt) => receipt
+                    .journal
+                    .decode()
+                    .map_err(|e| NssaError::ProgramOutputDeserializationError(e.to_string()))?,
+                None => execute_program(
+                    program,
+                    &chained_call.pre_states,
+                    &chained_call.instruction_data,
+                )?,
+            };
+
+            for new_call in program_output.chained_calls.iter().rev() {
+                let next_program = dependencies
+                    .get(&new_call.program_id)
+                    .ok_or(NssaError::InvalidProgramBehavior)?;
+                chained_calls.push_front((new_call.clone(), next_program));
+            }
+
+            calls.push(ProgramCall {
+                program,
+                call: chained_call,
+                receipt,
+            });
+            program_outputs.push(program_output);
+        }
 
-        // Prove circuit.
-        env_builder.add_assumption(inner_receipt);
+        Ok((calls, program_outputs))
+    }
 
-        for new_call in program_output.chained_calls.into_iter().rev() {
-            let next_program = dependencies
-                .get(&new_call.program_id)
-                .ok_or(NssaError::InvalidProgramBehavior)?;
-            chained_calls.push_front((new_call, next_program));
+    /// Prove every call without a receipt, up to `max_parallel_proofs` at the same time.
+    fn prove_programs(&self, calls: &mut [ProgramCall<'_>]) -> Result<(), NssaError> {
+        let mut unproven: Vec<&mut ProgramCall<'_>> =
+            calls.iter_mut().filter(|c| c.receipt.is_none()).collect();
+
+        for chunk in unproven.chunks_mut(self.max_parallel_proofs) {
+            let receipts = std::thread::scope(|scope| {
+                let proofs: Vec<_> = chunk
+                    .iter()
+                    .map(|c| {
+                        let (program, call) = (c.program, &c.call);
+                        scope.spawn(move || {
+                            self.prove_program(program, &call.pre_states, &call.instruction_data)
+                        })
+                    })
+                    .collect();
+
+                proofs
+                    .into_iter()
+                    .map(|proof| proof.join().expect("Program prover thread panicked"))
+                    .collect::<Vec<_>>()
+            });
+
+            for (c, receipt) in chunk.iter_mut().zip(receipts) {
+                let receipt = receipt?;
+                if let Some(cache) = &self.receipt_cache {
+                    cache.insert(
+                        ReceiptCache::key(c.program, &c.call.pre_states, &c.call.instruction_data),
+                        receipt.clone(),
+                    );
+                }
+                c.receipt = Some(receipt);
+            }
         }
 
-        chain_calls_counter += 1;
+        Ok(())
+    }
+
+    fn prove_program(
+        &self,
+        program: &Program,
+        pre_states: &[AccountWithMetadata],
+        instruction_data: &InstructionData,
+    ) -> Result<Receipt, NssaError> {
+        // Write inputs to the program
+        let mut env_builder = ExecutorEnv::builder();
+        Program::write_inputs(pre_states, instruction_data, &mut env_builder)?;
+        let env = env_builder.build().unwrap();
+
+        // Prove the program
+        self.backend
+            .prove(env, program.elf(), &ProverOpts::default())
+            .map_err(|e| NssaError::ProgramProveFailed(e.to_string()))
     }
+}
 
-    let circuit_input = PrivacyPreservingCircuitInput {
-        program_outputs,
+/// Generates a proof of the execution of a NSSA program inside the privacy preserving execution
+/// circuit, with a default [`CircuitProver`].
+#[expect(clippy::too_many_arguments, reason = "TODO: fix later")]
+pub fn execute_and_prove(
+    pre_states: Vec<AccountWithMetadata>,
+    instruction_data: InstructionData,
+    visibility_mask: Vec<u8>,
+    private_account_nonces: Vec<u128>,
+    private_account_keys: Vec<(NullifierPublicKey, SharedSecretKey)>,
+    private_account_nsks: Vec<NullifierSecretKey>,
+    private_account_membership_proofs: Vec<Option<MembershipProof>>,
+    program_with_dependencies: &ProgramWithDependencies,
+) -> Result<(PrivacyPreservingCircuitOutput, Proof), NssaError> {
+    CircuitProver::default().execute_and_prove(
+        pre_states,
+        instruction_data,
         visibility_mask,
         private_account_nonces,
         private_account_keys,
         private_account_nsks,
         private_account_membership_proofs,
-        program_id: program_with_dependencies.program.id(),
-    };
-
-    env_builder.write(&circuit_input).unwrap();
-    let env = env_builder.build().unwrap();
-    let prover = default_prover();
-    let opts = ProverOpts::succinct();
-    let prove_info = prover
-        .prove_with_opts(env, PRIVACY_PRESERVING_CIRCUIT_ELF, &opts)
-        .map_err(|e| NssaError::CircuitProvingError(e.to_string()))?;
-
-    let proof = Proof(borsh::to_vec(&prove_info.receipt.inner)?);
-
-    let circuit_output: PrivacyPreservingCircuitOutput = prove_info
-        .receipt
-        .journal
-        .decode()
-        .map_err(|e| NssaError::CircuitOutputDeserializationError(e.to_string()))?;
-
-    Ok((circuit_output, proof))
+        program_with_dependencies,
+    )
 }
 
-fn execute_and_prove_program(
+fn execute_program(
     program: &Program,
     pre_states: &[AccountWithMetadata],
     instruction_data: &InstructionData,
-) -> Result<Receipt, NssaError> {
+) -> Result<ProgramOutput, NssaError> {
     // Write inputs to the program
     let mut env_builder = ExecutorEnv::builder();
     Program::write_inputs(pre_states, instruction_data, &mut env_builder)?;
     let env = env_builder.build().unwrap();
 
-    // Prove the program
-    let prover = default_prover();
-    Ok(prover
-        .prove(env, program.elf())
-        .map_err(|e| NssaError::ProgramProveFailed(e.to_string()))?
-        .receipt)
+    // Execute the program (without proving)
+    default_executor()
+        .execute(env, program.elf())
+        .map_err(|e| NssaError::ProgramExecutionFailed(e.to_string()))?
+        .journal
+        .decode()
+        .map_err(|e| NssaError::ProgramOutputDeserializationError(e.to_string()))
+}
+
+static PROOF_VERIFICATION_OBSERVER: OnceLock<fn(Duration)> = OnceLock::new();
+
+/// Report the duration of every proof verification to `observer`, e.g. to export it as a metric.
+///
+/// Only the first observer set is kept.
+pub fn observe_proof_verification(observer: fn(Duration)) {
+    let _ = PROOF_VERIFICATION_OBSERVER.set(observer);
 }
 
 impl Proof {
     pub(crate) fn is_valid_for(&self, circuit_output: &PrivacyPreservingCircuitOutput) -> bool {
+        let start = Instant::now();
         let inner: InnerReceipt = borsh::from_slice(&self.0).unwrap();
         let receipt = Receipt::new(inner, circuit_output.to_bytes());
-        receipt.verify(PRIVACY_PRESERVING_CIRCUIT_ID).is_ok()
+        let is_valid = receipt.verify(PRIVACY_PRESERVING_CIRCUIT_ID).is_ok();
+
+        if let Some(observer) = PROOF_VERIFICATION_OBSERVER.get() {
+            observer(start.elapsed());
+        }
+        is_valid
     }
 }
 
@@ -362,4 +545,54 @@ mod tests {
         .unwrap();
         assert_eq!(recipient_post, expected_private_account_2);
     }
+
+    #[test]
+    fn prove_with_cached_program_receipt() {
+        let program = Program::authenticated_transfer_program();
+        let recipient_keys = test_private_account_keys_1();
+        let sender = AccountWithMetadata::new(
+            Account {
+                program_owner: program.id(),
+                balance: 100,
+                ..Account::default()
+            },
+            true,
+            AccountId::new([0; 32]),
+        );
+        let recipient = AccountWithMetadata::new(
+            Account::default(),
+            false,
+            AccountId::from(&recipient_keys.npk()),
+        );
+        let shared_secret = SharedSecretKey::new(&[3; 32], &recipient_keys.vpk());
+
+        let cache = Arc::new(ReceiptCache::new(8));
+        let prover = CircuitProver::default().with_receipt_cache(Arc::clone(&cache));
+        let prove = |nonce| {
+            prover
+                .execute_and_prove(
+                    vec![sender.clone(), recipient.clone()],
+                    Program::serialize_instruction(37_u128).unwrap(),
+                    vec![0, 2],
+                    vec![nonce],
+                    vec![(recipient_keys.npk(), shared_secret)],
+                    vec![],
+                    vec![None],
+                    &program.clone().into(),
+                )
+                .unwrap()
+        };
+
+        let (output_1, proof_1) = prove(1);
+        assert_eq!(cache.len(), 1);
+
+        // The program execution is identical, only the private account nonce differs
+        let (output_2, proof_2) = prove(2);
+        assert_eq!(cache.len(), 1);
+
+        assert!(proof_1.is_valid_for(&output_1));
+        assert!(proof_2.is_valid_for(&output_2));
+        assert_eq!(output_1.public_post_states, output_2.public_post_states);
+        assert_ne!(output_1.new_commitments, output_2.new_commitments);
+    }
 }
@@ -3,6 +3,7 @@ pub mod transaction;
 pub mod witness_set;
 
 pub mod circuit;
+pub mod prover;
 
 pub use message::Message;
 pub use transaction::PrivacyPreservingTransaction;
@@ -0,0 +1,119 @@
+//! Proving backends and the receipt cache used by [`CircuitProver`].
+//!
+//! [`CircuitProver`]: super::circuit::CircuitProver
+
+use std::{
+    collections::{HashMap, VecDeque},
+    sync::Mutex,
+};
+
+use nssa_core::{account::AccountWithMetadata, program::InstructionData};
+use risc0_zkvm::{ExecutorEnv, ProverOpts, Receipt, default_prover};
+use sha2::{Digest, Sha256};
+
+use crate::program::Program;
+
+/// Generator of receipts for program executions and for the privacy preserving circuit.
+///
+/// The executor environment is not `Send`, so it is built on the thread that runs the proof and
+/// handed to the backend there. Implementations must therefore be usable from several threads at
+/// once.
+pub trait ProvingBackend: Send + Sync {
+    fn prove(&self, env: ExecutorEnv<'_>, elf: &[u8], opts: &ProverOpts)
+    -> anyhow::Result<Receipt>;
+}
+
+/// Backend selected by risc0's [`default_prover`].
+///
+/// It proves locally, on the GPU when built with the `cuda` feature, and can be pointed at an
+/// external prover or a remote proving service with the `RISC0_PROVER` environment variable.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct DefaultProvingBackend;
+
+impl ProvingBackend for DefaultProvingBackend {
+    fn prove(
+        &self,
+        env: ExecutorEnv<'_>,
+        elf: &[u8],
+        opts: &ProverOpts,
+    ) -> anyhow::Result<Receipt> {
+        Ok(default_prover().prove_with_opts(env, elf, opts)?.receipt)
+    }
+}
+
+/// Content address of a program execution: the program id and its serialized inputs.
+pub type ReceiptKey = [u8; 32];
+
+/// Bounded cache of program receipts, keyed by [`ReceiptKey`].
+///
+/// Programs are deterministic, so a receipt proves every execution with the same program and
+/// inputs. When full, the oldest receipt is evicted.
+pub struct ReceiptCache {
+    capacity: usize,
+    inner: Mutex<ReceiptCacheInner>,
+}
+
+#[derive(Default)]
+struct ReceiptCacheInner {
+    receipts: HashMap<ReceiptKey, Receipt>,
+    /// Insertion order, oldest first
+    order: VecDeque<ReceiptKey>,
+}
+
+impl ReceiptCache {
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            inner: Mutex::new(ReceiptCacheInner::default()),
+        }
+    }
+
+    pub fn key(
+        program: &Program,
+        pre_states: &[AccountWithMetadata],
+        instruction_data: &InstructionData,
+    ) -> ReceiptKey {
+        // Same encoding as the inputs written by `Program::write_inputs`
+        let input = risc0_zkvm::serde::to_vec(&(pre_states, instruction_data))
+            .expect("Program inputs must be serializable");
+
+        let mut hasher = Sha256::new();
+        for word in program.id().iter().chain(&input) {
+            hasher.update(word.to_le_bytes());
+        }
+        hasher.finalize().into()
+    }
+
+    pub fn get(&self, key: &ReceiptKey) -> Option<Receipt> {
+        let inner = self.inner.lock().unwrap_or_else(|e| e.into_inner());
+        inner.receipts.get(key).cloned()
+    }
+
+    pub fn insert(&self, key: ReceiptKey, receipt: Receipt) {
+        if self.capacity == 0 {
+            return;
+        }
+
+        let mut inner = self.inner.lock().unwrap_or_else(|e| e.into_inner());
+        if inner.receipts.insert(key, receipt).is_some() {
+            return;
+        }
+        inner.order.push_back(key);
+
+        while inner.order.len() > self.capacity {
+            let Some(oldest) = inner.order.pop_front() else {
+                break;
+            };
+            inner.receipts.remove(&oldest);
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        let inner = self.inner.lock().unwrap_or_else(|e| e.into_inner());
+        inner.receipts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
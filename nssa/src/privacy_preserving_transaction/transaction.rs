@@ -9,7 +9,7 @@ use sha2::{Digest as _, digest::FixedOutput as _};
 
 use super::{message::Message, witness_set::WitnessSet};
 use crate::{
-    AccountId, V02State,
+    AccountId, SignatureBatch, V02State,
     error::NssaError,
     privacy_preserving_transaction::{circuit::Proof, message::EncryptedAccountData},
 };
@@ -31,6 +31,18 @@ impl PrivacyPreservingTransaction {
     pub(crate) fn validate_and_produce_public_state_diff(
         &self,
         state: &V02State,
+    ) -> Result<HashMap<AccountId, Account>, NssaError> {
+        self.validate_and_produce_public_state_diff_with(state, true)
+    }
+
+    /// Same as [`Self::validate_and_produce_public_state_diff`], signature verification is
+    /// skipped unless `verify_signatures` is set.
+    ///
+    /// Only pass `false` for transactions whose signatures were already verified.
+    pub(crate) fn validate_and_produce_public_state_diff_with(
+        &self,
+        state: &V02State,
+        verify_signatures: bool,
     ) -> Result<HashMap<AccountId, Account>, NssaError> {
         let message = &self.message;
         let witness_set = &self.witness_set;
@@ -72,7 +84,7 @@ impl PrivacyPreservingTransaction {
         }
 
         // Check the signatures are valid
-        if !witness_set.signatures_are_valid_for(message) {
+        if verify_signatures && !witness_set.signatures_are_valid_for(message) {
             return Err(NssaError::InvalidInput(
                 "Invalid signature for given message and public key".into(),
             ));
@@ -128,6 +140,15 @@ impl PrivacyPreservingTransaction {
         &self.message
     }
 
+    /// Add the signatures of this transaction to `batch`, tagged with `tag`.
+    pub fn add_signatures_to_batch<'a>(&'a self, tag: usize, batch: &mut SignatureBatch<'a>) {
+        batch.push(
+            tag,
+            self.message.to_bytes(),
+            self.witness_set.signatures_and_public_keys(),
+        );
+    }
+
     pub fn witness_set(&self) -> &WitnessSet {
         &self.witness_set
     }
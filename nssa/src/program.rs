@@ -1,3 +1,5 @@
+use std::sync::Arc;
+
 use borsh::{BorshDeserialize, BorshSerialize};
 use nssa_core::{
     account::AccountWithMetadata,
@@ -18,7 +20,18 @@ const MAX_NUM_CYCLES_PUBLIC_EXECUTION: u64 = 1024 * 1024 * 32; // 32M cycles
 #[derive(Clone, Debug, PartialEq, Eq, BorshSerialize, BorshDeserialize)]
 pub struct Program {
     id: ProgramId,
-    elf: Vec<u8>,
+    /// Shared, so that cloning a state does not copy program binaries
+    #[borsh(serialize_with = "serialize_elf", deserialize_with = "deserialize_elf")]
+    elf: Arc<[u8]>,
+}
+
+/// Same encoding as an owned byte vector
+fn serialize_elf<W: std::io::Write>(elf: &Arc<[u8]>, writer: &mut W) -> std::io::Result<()> {
+    BorshSerialize::serialize(&elf[..], writer)
+}
+
+fn deserialize_elf<R: std::io::Read>(reader: &mut R) -> std::io::Result<Arc<[u8]>> {
+    Vec::<u8>::deserialize_reader(reader).map(Arc::from)
 }
 
 impl Program {
@@ -29,7 +42,10 @@ impl Program {
             .compute_image_id()
             .map_err(|_| NssaError::InvalidProgramBytecode)?
             .into();
-        Ok(Self { elf: bytecode, id })
+        Ok(Self {
+            elf: bytecode.into(),
+            id,
+        })
     }
 
     pub fn id(&self) -> ProgramId {
@@ -135,7 +151,7 @@ mod tests {
 
             Program {
                 id: NONCE_CHANGER_ID,
-                elf: NONCE_CHANGER_ELF.to_vec(),
+                elf: NONCE_CHANGER_ELF.into(),
             }
         }
 
@@ -145,7 +161,7 @@ mod tests {
 
             Program {
                 id: EXTRA_OUTPUT_ID,
-                elf: EXTRA_OUTPUT_ELF.to_vec(),
+                elf: EXTRA_OUTPUT_ELF.into(),
             }
         }
 
@@ -155,7 +171,7 @@ mod tests {
 
             Program {
                 id: MISSING_OUTPUT_ID,
-                elf: MISSING_OUTPUT_ELF.to_vec(),
+                elf: MISSING_OUTPUT_ELF.into(),
             }
         }
 
@@ -165,7 +181,7 @@ mod tests {
 
             Program {
                 id: PROGRAM_OWNER_CHANGER_ID,
-                elf: PROGRAM_OWNER_CHANGER_ELF.to_vec(),
+                elf: PROGRAM_OWNER_CHANGER_ELF.into(),
             }
         }
 
@@ -175,7 +191,7 @@ mod tests {
 
             Program {
                 id: SIMPLE_BALANCE_TRANSFER_ID,
-                elf: SIMPLE_BALANCE_TRANSFER_ELF.to_vec(),
+                elf: SIMPLE_BALANCE_TRANSFER_ELF.into(),
             }
         }
 
@@ -185,7 +201,7 @@ mod tests {
 
             Program {
                 id: DATA_CHANGER_ID,
-                elf: DATA_CHANGER_ELF.to_vec(),
+                elf: DATA_CHANGER_ELF.into(),
             }
         }
 
@@ -195,7 +211,7 @@ mod tests {
 
             Program {
                 id: MINTER_ID,
-                elf: MINTER_ELF.to_vec(),
+                elf: MINTER_ELF.into(),
             }
         }
 
@@ -205,7 +221,7 @@ mod tests {
 
             Program {
                 id: BURNER_ID,
-                elf: BURNER_ELF.to_vec(),
+                elf: BURNER_ELF.into(),
             }
         }
 
@@ -214,7 +230,7 @@ mod tests {
 
             Program {
                 id: CHAIN_CALLER_ID,
-                elf: CHAIN_CALLER_ELF.to_vec(),
+                elf: CHAIN_CALLER_ELF.into(),
             }
         }
 
@@ -223,7 +239,7 @@ mod tests {
 
             Program {
                 id: CLAIMER_ID,
-                elf: CLAIMER_ELF.to_vec(),
+                elf: CLAIMER_ELF.into(),
             }
         }
 
@@ -232,7 +248,7 @@ mod tests {
 
             Program {
                 id: CHANGER_CLAIMER_ID,
-                elf: CHANGER_CLAIMER_ELF.to_vec(),
+                elf: CHANGER_CLAIMER_ELF.into(),
             }
         }
 
@@ -241,7 +257,7 @@ mod tests {
 
             Program {
                 id: NOOP_ID,
-                elf: NOOP_ELF.to_vec(),
+                elf: NOOP_ELF.into(),
             }
         }
 
@@ -252,7 +268,7 @@ mod tests {
 
             Program {
                 id: MALICIOUS_AUTHORIZATION_CHANGER_ID,
-                elf: MALICIOUS_AUTHORIZATION_CHANGER_ELF.to_vec(),
+                elf: MALICIOUS_AUTHORIZATION_CHANGER_ELF.into(),
             }
         }
 
@@ -305,10 +321,10 @@ mod tests {
         let pinata_program = Program::pinata();
 
         assert_eq!(auth_transfer_program.id, AUTHENTICATED_TRANSFER_ID);
-        assert_eq!(auth_transfer_program.elf, AUTHENTICATED_TRANSFER_ELF);
+        assert_eq!(&*auth_transfer_program.elf, AUTHENTICATED_TRANSFER_ELF);
         assert_eq!(token_program.id, TOKEN_ID);
-        assert_eq!(token_program.elf, TOKEN_ELF);
+        assert_eq!(&*token_program.elf, TOKEN_ELF);
         assert_eq!(pinata_program.id, PINATA_ID);
-        assert_eq!(pinata_program.elf, PINATA_ELF);
+        assert_eq!(&*pinata_program.elf, PINATA_ELF);
     }
 }
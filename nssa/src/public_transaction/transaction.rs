@@ -9,7 +9,7 @@ use nssa_core::{
 use sha2::{Digest, digest::FixedOutput};
 
 use crate::{
-    V02State,
+    SignatureBatch, V02State,
     error::NssaError,
     public_transaction::{Message, WitnessSet},
     state::MAX_NUMBER_CHAINED_CALLS,
@@ -33,6 +33,15 @@ impl PublicTransaction {
         &self.message
     }
 
+    /// Add the signatures of this transaction to `batch`, tagged with `tag`.
+    pub fn add_signatures_to_batch<'a>(&'a self, tag: usize, batch: &mut SignatureBatch<'a>) {
+        batch.push(
+            tag,
+            self.message.to_bytes(),
+            self.witness_set.signatures_and_public_keys(),
+        );
+    }
+
     pub fn witness_set(&self) -> &WitnessSet {
         &self.witness_set
     }
@@ -65,6 +74,18 @@ impl PublicTransaction {
     pub(crate) fn validate_and_produce_public_state_diff(
         &self,
         state: &V02State,
+    ) -> Result<HashMap<AccountId, Account>, NssaError> {
+        self.validate_and_produce_public_state_diff_with(state, true)
+    }
+
+    /// Same as [`Self::validate_and_produce_public_state_diff`], signature verification is
+    /// skipped unless `verify_signatures` is set.
+    ///
+    /// Only pass `false` for transactions whose signatures were already verified.
+    pub(crate) fn validate_and_produce_public_state_diff_with(
+        &self,
+        state: &V02State,
+        verify_signatures: bool,
     ) -> Result<HashMap<AccountId, Account>, NssaError> {
         let message = self.message();
         let witness_set = self.witness_set();
@@ -84,7 +105,7 @@ impl PublicTransaction {
         }
 
         // Check the signatures are valid
-        if !witness_set.is_valid_for(message) {
+        if verify_signatures && !witness_set.is_valid_for(message) {
             return Err(NssaError::InvalidInput(
                 "Invalid signature for given message and public key".into(),
             ));
@@ -0,0 +1,151 @@
+use rayon::prelude::*;
+
+use super::{PublicKey, Signature};
+
+/// Signatures verified together, e.g. all signatures of a block.
+///
+/// All signatures share one verification context and are checked across the available cores.
+/// Every signature is tagged by the caller, so a failing batch reports which items were invalid.
+#[derive(Default)]
+pub struct SignatureBatch<'a> {
+    messages: Vec<Vec<u8>>,
+    entries: Vec<BatchEntry<'a>>,
+}
+
+struct BatchEntry<'a> {
+    signature: &'a Signature,
+    public_key: &'a PublicKey,
+    message: usize,
+    tag: usize,
+}
+
+impl<'a> SignatureBatch<'a> {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Add `signatures` over `message`, tagged with `tag`.
+    pub fn push(
+        &mut self,
+        tag: usize,
+        message: Vec<u8>,
+        signatures: impl IntoIterator<Item = &'a (Signature, PublicKey)>,
+    ) {
+        let message_index = self.messages.len();
+        self.messages.push(message);
+        self.entries.extend(
+            signatures
+                .into_iter()
+                .map(|(signature, public_key)| BatchEntry {
+                    signature,
+                    public_key,
+                    message: message_index,
+                    tag,
+                }),
+        );
+    }
+
+    /// Number of signatures in the batch.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Verify all signatures of the batch.
+    ///
+    /// If the batch fails, signatures are checked one by one and the sorted, deduplicated tags
+    /// of the invalid ones are returned.
+    pub fn verify(&self) -> Result<(), Vec<usize>> {
+        let secp = secp256k1::Secp256k1::verification_only();
+
+        if self.verify_all(&secp) {
+            return Ok(());
+        }
+
+        let mut invalid_tags = self
+            .entries
+            .par_iter()
+            .filter(|entry| !self.verify_entry(&secp, entry))
+            .map(|entry| entry.tag)
+            .collect::<Vec<_>>();
+        invalid_tags.sort_unstable();
+        invalid_tags.dedup();
+        Err(invalid_tags)
+    }
+
+    fn verify_all(&self, secp: &secp256k1::Secp256k1<secp256k1::VerifyOnly>) -> bool {
+        self.entries
+            .par_iter()
+            .all(|entry| self.verify_entry(secp, entry))
+    }
+
+    fn verify_entry(
+        &self,
+        secp: &secp256k1::Secp256k1<secp256k1::VerifyOnly>,
+        entry: &BatchEntry<'_>,
+    ) -> bool {
+        entry
+            .signature
+            .is_valid_for_with(secp, &self.messages[entry.message], entry.public_key)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::SignatureBatch;
+    use crate::signature::bip340_test_vectors;
+
+    #[test]
+    fn test_batch_of_valid_bip340_test_vectors_verifies() {
+        let test_vectors = bip340_test_vectors::test_vectors();
+        let pairs = test_vectors
+            .iter()
+            .map(|test_vector| (test_vector.signature.clone(), test_vector.pubkey.clone()))
+            .collect::<Vec<_>>();
+
+        let mut batch = SignatureBatch::new();
+        for (i, test_vector) in test_vectors.iter().enumerate() {
+            if test_vector.verification_result {
+                batch.push(
+                    i,
+                    test_vector.message.clone().unwrap_or_default(),
+                    [&pairs[i]],
+                );
+            }
+        }
+
+        assert!(!batch.is_empty());
+        assert_eq!(batch.verify(), Ok(()));
+    }
+
+    #[test]
+    fn test_batch_of_all_bip340_test_vectors_reports_invalid_ones() {
+        let test_vectors = bip340_test_vectors::test_vectors();
+        let pairs = test_vectors
+            .iter()
+            .map(|test_vector| (test_vector.signature.clone(), test_vector.pubkey.clone()))
+            .collect::<Vec<_>>();
+
+        let mut batch = SignatureBatch::new();
+        for (i, test_vector) in test_vectors.iter().enumerate() {
+            batch.push(
+                i,
+                test_vector.message.clone().unwrap_or_default(),
+                [&pairs[i]],
+            );
+        }
+
+        let expected_invalid = test_vectors
+            .iter()
+            .enumerate()
+            .filter(|(_, test_vector)| !test_vector.verification_result)
+            .map(|(i, _)| i)
+            .collect::<Vec<_>>();
+        assert!(!expected_invalid.is_empty());
+        assert_eq!(batch.len(), test_vectors.len());
+        assert_eq!(batch.verify(), Err(expected_invalid));
+    }
+}
@@ -1,6 +1,8 @@
+mod batch;
 mod private_key;
 mod public_key;
 
+pub use batch::SignatureBatch;
 use borsh::{BorshDeserialize, BorshSerialize};
 pub use private_key::PrivateKey;
 pub use public_key::PublicKey;
@@ -34,8 +36,20 @@ impl Signature {
     }
 
     pub fn is_valid_for(&self, bytes: &[u8], public_key: &PublicKey) -> bool {
+        self.is_valid_for_with(
+            &secp256k1::Secp256k1::verification_only(),
+            bytes,
+            public_key,
+        )
+    }
+
+    fn is_valid_for_with(
+        &self,
+        secp: &secp256k1::Secp256k1<secp256k1::VerifyOnly>,
+        bytes: &[u8],
+        public_key: &PublicKey,
+    ) -> bool {
         let pk = secp256k1::XOnlyPublicKey::from_byte_array(*public_key.value()).unwrap();
-        let secp = secp256k1::Secp256k1::new();
         let sig = secp256k1::schnorr::Signature::from_byte_array(self.value);
         secp.verify_schnorr(&sig, bytes, &pk).is_ok()
     }
@@ -1,9 +1,9 @@
-use std::collections::{BTreeSet, HashMap, HashSet};
+use std::collections::{HashMap, HashSet, VecDeque};
 
 use borsh::{BorshDeserialize, BorshSerialize};
 use nssa_core::{
     Commitment, CommitmentSetDigest, DUMMY_COMMITMENT, MembershipProof, Nullifier,
-    account::{Account, AccountId},
+    account::{Account, AccountId, Nonce},
     program::ProgramId,
 };
 
@@ -16,12 +16,220 @@ use crate::{
 
 pub const MAX_NUMBER_CHAINED_CALLS: usize = 10;
 
-#[derive(Clone, BorshSerialize, BorshDeserialize)]
+/// Default number of most recent commitment set digests that proofs may be built against
+pub const DEFAULT_ROOT_HISTORY_WINDOW: usize = 4096;
+
+/// Marks the windowed serialization layout of [`RootHistory`].
+///
+/// The legacy layout starts with the number of digests, which never reaches this value.
+const ROOT_HISTORY_WINDOW_MARKER: u32 = u32::MAX;
+
+/// Ring buffer of the most recent commitment set digests, with a hash index for membership
+/// checks.
+///
+/// Every digest gets a position, counting all digests ever added. Only the last `window` of them
+/// are kept.
+#[derive(Clone)]
+#[cfg_attr(test, derive(Debug, PartialEq, Eq))]
+struct RootHistory {
+    window: usize,
+    /// Position of the oldest kept digest
+    start: u64,
+    digests: VecDeque<CommitmentSetDigest>,
+    /// Number of occurrences of each kept digest
+    index: HashMap<CommitmentSetDigest, usize>,
+}
+
+impl RootHistory {
+    fn new(window: usize) -> Self {
+        Self {
+            window: window.max(1),
+            start: 0,
+            digests: VecDeque::new(),
+            index: HashMap::new(),
+        }
+    }
+
+    /// Rebuilds a history from its digests in order, the first one being at position `start`.
+    fn from_digests(
+        window: usize,
+        start: u64,
+        digests: impl IntoIterator<Item = CommitmentSetDigest>,
+    ) -> Self {
+        let mut this = Self::new(window);
+        this.start = start;
+        for digest in digests {
+            this.push(digest);
+        }
+        this
+    }
+
+    /// Adds a digest, dropping the oldest ones outside of the window, and returns its position.
+    fn push(&mut self, digest: CommitmentSetDigest) -> u64 {
+        let position = self.start + self.digests.len() as u64;
+        self.digests.push_back(digest);
+        *self.index.entry(digest).or_default() += 1;
+        self.truncate();
+        position
+    }
+
+    fn contains(&self, digest: &CommitmentSetDigest) -> bool {
+        self.index.contains_key(digest)
+    }
+
+    /// Digest that the next [`Self::push`] drops from the window
+    fn next_evicted(&self) -> Option<CommitmentSetDigest> {
+        if self.digests.len() < self.window {
+            return None;
+        }
+        self.digests.front().copied()
+    }
+
+    /// Undoes the last [`Self::push`], putting back the digest it dropped.
+    fn pop(&mut self, evicted: Option<CommitmentSetDigest>) {
+        if let Some(digest) = self.digests.pop_back() {
+            self.forget(&digest);
+        }
+        if let Some(digest) = evicted {
+            self.digests.push_front(digest);
+            *self.index.entry(digest).or_default() += 1;
+            self.start -= 1;
+        }
+    }
+
+    fn forget(&mut self, digest: &CommitmentSetDigest) {
+        if let Some(count) = self.index.get_mut(digest) {
+            *count -= 1;
+            if *count == 0 {
+                self.index.remove(digest);
+            }
+        }
+    }
+
+    fn set_window(&mut self, window: usize) {
+        self.window = window.max(1);
+        self.truncate();
+    }
+
+    fn truncate(&mut self) {
+        while self.digests.len() > self.window {
+            self.pop_oldest();
+        }
+    }
+
+    /// Adds a digest at a known position, after digests that left the window before being seen.
+    ///
+    /// Positions that were already added are skipped.
+    fn push_at(&mut self, position: u64, digest: CommitmentSetDigest) {
+        let next_position = self.start + self.digests.len() as u64;
+        if position < next_position {
+            return;
+        }
+        if position > next_position {
+            // Everything kept so far is older than the skipped digests
+            while !self.digests.is_empty() {
+                self.pop_oldest();
+            }
+            self.start = position;
+        }
+        self.push(digest);
+    }
+
+    /// Drops the digests at positions below `start`.
+    fn drop_before(&mut self, start: u64) {
+        while self.start < start && !self.digests.is_empty() {
+            self.pop_oldest();
+        }
+    }
+
+    fn pop_oldest(&mut self) {
+        if let Some(oldest) = self.digests.pop_front() {
+            self.start += 1;
+            self.forget(&oldest);
+        }
+    }
+
+    /// Kept digests with their positions, oldest first
+    fn iter(&self) -> impl Iterator<Item = (u64, CommitmentSetDigest)> + '_ {
+        (self.start..).zip(self.digests.iter().copied())
+    }
+}
+
+impl BorshSerialize for RootHistory {
+    fn serialize<W: std::io::Write>(&self, writer: &mut W) -> std::io::Result<()> {
+        ROOT_HISTORY_WINDOW_MARKER.serialize(writer)?;
+        (self.window as u64).serialize(writer)?;
+        self.start.serialize(writer)?;
+        (self.digests.len() as u32).serialize(writer)?;
+        for digest in &self.digests {
+            digest.serialize(writer)?;
+        }
+        Ok(())
+    }
+}
+
+impl BorshDeserialize for RootHistory {
+    fn deserialize_reader<R: std::io::Read>(reader: &mut R) -> std::io::Result<Self> {
+        Self::deserialize_with_current(reader, None)
+    }
+}
+
+impl RootHistory {
+    /// Decodes either layout. The legacy layout is an unordered set, so its digests get
+    /// arbitrary positions, except for `current` which is placed last to stay in the window
+    /// longest.
+    fn deserialize_with_current<R: std::io::Read>(
+        reader: &mut R,
+        current: Option<CommitmentSetDigest>,
+    ) -> std::io::Result<Self> {
+        let marker_or_len = u32::deserialize_reader(reader)?;
+
+        if marker_or_len != ROOT_HISTORY_WINDOW_MARKER {
+            // Legacy unbounded set, keep all of its digests
+            let mut digests = (0..marker_or_len)
+                .map(|_| CommitmentSetDigest::deserialize_reader(reader))
+                .collect::<std::io::Result<Vec<_>>>()?;
+            if let Some(current) = current {
+                digests.retain(|digest| *digest != current);
+                digests.push(current);
+            }
+            let window = digests.len().max(DEFAULT_ROOT_HISTORY_WINDOW);
+            return Ok(Self::from_digests(window, 0, digests));
+        }
+
+        let window = u64::deserialize_reader(reader)?;
+        let start = u64::deserialize_reader(reader)?;
+        let digests = Vec::<CommitmentSetDigest>::deserialize_reader(reader)?;
+        if digests.len() as u64 > window {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "root history is longer than its window",
+            ));
+        }
+
+        Ok(Self::from_digests(window as usize, start, digests))
+    }
+}
+
+#[derive(Clone, BorshSerialize)]
 #[cfg_attr(test, derive(Debug, PartialEq, Eq))]
 pub(crate) struct CommitmentSet {
     merkle_tree: MerkleTree,
     commitments: HashMap<Commitment, usize>,
-    root_history: HashSet<CommitmentSetDigest>,
+    root_history: RootHistory,
+}
+
+impl BorshDeserialize for CommitmentSet {
+    fn deserialize_reader<R: std::io::Read>(reader: &mut R) -> std::io::Result<Self> {
+        let merkle_tree = MerkleTree::deserialize_reader(reader)?;
+        let commitments = HashMap::deserialize_reader(reader)?;
+        let root_history = RootHistory::deserialize_with_current(reader, Some(merkle_tree.root()))?;
+        Ok(Self {
+            merkle_tree,
+            commitments,
+            root_history,
+        })
+    }
 }
 
 impl CommitmentSet {
@@ -39,18 +247,61 @@ impl CommitmentSet {
     }
 
     /// Inserts a list of commitments to the `CommitmentSet`.
-    pub(crate) fn extend(&mut self, commitments: &[Commitment]) {
-        for commitment in commitments.iter().cloned() {
-            let index = self.merkle_tree.insert(commitment.to_byte_array());
-            self.commitments.insert(commitment, index);
-        }
-        self.root_history.insert(self.digest());
+    ///
+    /// Returns the position of the new digest in the root history.
+    pub(crate) fn extend(&mut self, commitments: &[Commitment]) -> u64 {
+        self.insert_commitments(commitments.iter().cloned());
+        self.root_history.push(self.digest())
+    }
+
+    fn insert_commitments(&mut self, commitments: impl IntoIterator<Item = Commitment>) {
+        let commitments = commitments.into_iter().collect::<Vec<_>>();
+        let values = commitments
+            .iter()
+            .map(Commitment::to_byte_array)
+            .collect::<Vec<_>>();
+
+        let first_index = self.merkle_tree.extend(&values);
+        self.commitments.extend(
+            commitments
+                .into_iter()
+                .enumerate()
+                .map(|(offset, commitment)| (commitment, first_index + offset)),
+        );
     }
 
     fn contains(&self, commitment: &Commitment) -> bool {
         self.commitments.contains_key(commitment)
     }
 
+    /// Undoes the last [`Self::extend`] with `commitments`, given the digest it dropped from the
+    /// root history.
+    fn undo_extend(&mut self, commitments: &[Commitment], evicted: Option<CommitmentSetDigest>) {
+        let first_index = commitments
+            .iter()
+            .filter_map(|commitment| self.commitments.remove(commitment))
+            .min();
+        if let Some(first_index) = first_index {
+            self.merkle_tree.truncate(first_index);
+        }
+        self.root_history.pop(evicted);
+    }
+
+    /// Rebuilds a `CommitmentSet` from its commitments in insertion order and its root history.
+    ///
+    /// The window is large enough to keep all of the given digests.
+    fn from_parts(
+        commitments: impl IntoIterator<Item = Commitment>,
+        root_history_start: u64,
+        root_history: Vec<CommitmentSetDigest>,
+    ) -> CommitmentSet {
+        let mut this = Self::with_capacity(32);
+        this.insert_commitments(commitments);
+        let window = root_history.len().max(DEFAULT_ROOT_HISTORY_WINDOW);
+        this.root_history = RootHistory::from_digests(window, root_history_start, root_history);
+        this
+    }
+
     /// Initializes an empty `CommitmentSet` with a given capacity.
     /// If the capacity is not a power_of_two, then capacity is taken
     /// to be the next power_of_two.
@@ -58,50 +309,250 @@ impl CommitmentSet {
         Self {
             merkle_tree: MerkleTree::with_capacity(capacity),
             commitments: HashMap::new(),
-            root_history: HashSet::new(),
+            root_history: RootHistory::new(DEFAULT_ROOT_HISTORY_WINDOW),
         }
     }
 }
 
-#[cfg_attr(test, derive(Debug, PartialEq, Eq))]
+/// Number of recently added nullifiers above which they are merged into the sorted ones
+const NULLIFIER_MERGE_THRESHOLD: usize = 4096;
+
+/// Set of spent nullifiers.
+///
+/// Most nullifiers live in a flat sorted vector searched by bisection. New ones go to a small
+/// hash set first and are merged into the vector in bulk, so inserting does not shift the whole
+/// vector every time.
+#[cfg_attr(test, derive(Debug))]
 #[derive(Clone)]
-struct NullifierSet(BTreeSet<Nullifier>);
+struct NullifierSet {
+    /// Sorted, without duplicates
+    sorted: Vec<Nullifier>,
+    /// Not in `sorted`
+    recent: HashSet<Nullifier>,
+}
 
 impl NullifierSet {
     fn new() -> Self {
-        Self(BTreeSet::new())
+        Self {
+            sorted: Vec::new(),
+            recent: HashSet::new(),
+        }
+    }
+
+    fn from_unsorted(mut nullifiers: Vec<Nullifier>) -> Self {
+        nullifiers.sort_unstable();
+        nullifiers.dedup();
+        Self {
+            sorted: nullifiers,
+            recent: HashSet::new(),
+        }
     }
 
     fn extend(&mut self, new_nullifiers: Vec<Nullifier>) {
-        self.0.extend(new_nullifiers);
+        for nullifier in new_nullifiers {
+            if self.sorted.binary_search(&nullifier).is_err() {
+                self.recent.insert(nullifier);
+            }
+        }
+
+        if self.recent.len() > NULLIFIER_MERGE_THRESHOLD {
+            self.sorted.extend(self.recent.drain());
+            // Stable sort detects the sorted prefix and merges the new tail into it
+            self.sorted.sort();
+        }
     }
 
     fn contains(&self, nullifier: &Nullifier) -> bool {
-        self.0.contains(nullifier)
+        self.recent.contains(nullifier) || self.sorted.binary_search(nullifier).is_ok()
+    }
+
+    fn remove(&mut self, nullifier: &Nullifier) {
+        if self.recent.remove(nullifier) {
+            return;
+        }
+        // Only when a merge happened since the nullifier was added
+        if let Ok(index) = self.sorted.binary_search(nullifier) {
+            self.sorted.remove(index);
+        }
+    }
+
+    fn len(&self) -> usize {
+        self.sorted.len() + self.recent.len()
+    }
+
+    /// All nullifiers, in no particular order
+    fn iter(&self) -> impl Iterator<Item = &Nullifier> {
+        self.sorted.iter().chain(&self.recent)
+    }
+
+    fn sorted_refs(&self) -> Vec<&Nullifier> {
+        let mut recent = self.recent.iter().collect::<Vec<_>>();
+        recent.sort_unstable();
+
+        let mut all = Vec::with_capacity(self.len());
+        all.extend(&self.sorted);
+        all.extend(recent);
+        // Two sorted runs, merged in linear time
+        all.sort();
+        all
     }
 }
 
+#[cfg(test)]
+impl PartialEq for NullifierSet {
+    fn eq(&self, other: &Self) -> bool {
+        self.sorted_refs() == other.sorted_refs()
+    }
+}
+
+#[cfg(test)]
+impl Eq for NullifierSet {}
+
 impl BorshSerialize for NullifierSet {
     fn serialize<W: std::io::Write>(&self, writer: &mut W) -> std::io::Result<()> {
-        self.0.iter().collect::<Vec<_>>().serialize(writer)
+        let nullifiers = self.sorted_refs();
+        u32::try_from(nullifiers.len())
+            .map_err(|_| std::io::Error::from(std::io::ErrorKind::InvalidData))?
+            .serialize(writer)?;
+        for nullifier in nullifiers {
+            nullifier.serialize(writer)?;
+        }
+        Ok(())
     }
 }
 
 impl BorshDeserialize for NullifierSet {
     fn deserialize_reader<R: std::io::Read>(reader: &mut R) -> std::io::Result<Self> {
-        let vec = Vec::<Nullifier>::deserialize_reader(reader)?;
-
-        let mut set = BTreeSet::new();
-        for n in vec {
-            if !set.insert(n) {
-                return Err(std::io::Error::new(
-                    std::io::ErrorKind::InvalidData,
-                    "duplicate nullifier in NullifierSet",
-                ));
-            }
+        let mut sorted = Vec::<Nullifier>::deserialize_reader(reader)?;
+
+        // Serialized sets are sorted, so this is a single pass in the usual case
+        if !sorted.is_sorted() {
+            sorted.sort_unstable();
         }
+        if sorted.windows(2).any(|pair| pair[0] == pair[1]) {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "duplicate nullifier in NullifierSet",
+            ));
+        }
+
+        Ok(Self {
+            sorted,
+            recent: HashSet::new(),
+        })
+    }
+}
+
+/// Part of a [`V02State`], either all of it or only what changed since the last persisted diff.
+///
+/// Used by storage to persist the state incrementally.
+#[derive(Clone, Debug, Default)]
+pub struct StateDiff {
+    /// Public accounts with their current value
+    pub accounts: Vec<(AccountId, Account)>,
+    /// Commitments with their index in the commitment Merkle tree
+    pub commitments: Vec<(usize, Commitment)>,
+    /// Commitment set digests added to the root history, with their position in it
+    pub commitment_set_digests: Vec<(u64, CommitmentSetDigest)>,
+    /// Position of the oldest digest still in the root history
+    ///
+    /// Digests at lower positions fell out of the validity window.
+    pub root_history_start: u64,
+    pub nullifiers: Vec<Nullifier>,
+    pub programs: Vec<Program>,
+}
+
+/// Keys of the state touched since the last persisted diff.
+#[derive(Clone, Default)]
+struct ChangeLog {
+    accounts: HashSet<AccountId>,
+    commitments: Vec<Commitment>,
+    commitment_set_digests: Vec<(u64, CommitmentSetDigest)>,
+    nullifiers: Vec<Nullifier>,
+    programs: HashSet<ProgramId>,
+}
 
-        Ok(Self(set))
+/// Change tracking of a [`V02State`].
+///
+/// Tracking is off (`None`) until the first diff is persisted, so states that are never
+/// persisted incrementally do not accumulate a change log.
+#[derive(Clone, Default)]
+struct DiffTracker(Option<ChangeLog>);
+
+impl DiffTracker {
+    fn record(&mut self, f: impl FnOnce(&mut ChangeLog)) {
+        if let Some(log) = &mut self.0 {
+            f(log);
+        }
+    }
+}
+
+// The tracker is bookkeeping, not part of the state value.
+#[cfg(test)]
+impl PartialEq for DiffTracker {
+    fn eq(&self, _other: &Self) -> bool {
+        true
+    }
+}
+
+#[cfg(test)]
+impl Eq for DiffTracker {}
+
+#[cfg(test)]
+impl std::fmt::Debug for DiffTracker {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_tuple("DiffTracker")
+            .field(&self.0.is_some())
+            .finish()
+    }
+}
+
+/// Change that a discarded speculation reverts.
+#[derive(Clone)]
+enum Undo {
+    /// Previous value of an account
+    Account(AccountId, Option<Account>),
+    /// Commitments added by one extend, and the digest it dropped from the root history
+    Commitments(Vec<Commitment>, Option<CommitmentSetDigest>),
+    /// Nullifiers that were not in the set yet
+    Nullifiers(Vec<Nullifier>),
+    /// Previous value of a program
+    Program(ProgramId, Option<Program>),
+}
+
+/// Undo journal of the open speculations of a [`V02State`], oldest first.
+#[derive(Clone, Default)]
+struct Speculation {
+    journal: Vec<Undo>,
+    /// Journal length and change tracking at the start of each open speculation
+    checkpoints: Vec<(usize, DiffTracker)>,
+}
+
+impl Speculation {
+    fn record(&mut self, undo: impl FnOnce() -> Undo) {
+        if !self.checkpoints.is_empty() {
+            self.journal.push(undo());
+        }
+    }
+}
+
+// The journal is bookkeeping, not part of the state value.
+#[cfg(test)]
+impl PartialEq for Speculation {
+    fn eq(&self, _other: &Self) -> bool {
+        true
+    }
+}
+
+#[cfg(test)]
+impl Eq for Speculation {}
+
+#[cfg(test)]
+impl std::fmt::Debug for Speculation {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_tuple("Speculation")
+            .field(&self.checkpoints.len())
+            .finish()
     }
 }
 
@@ -111,6 +562,10 @@ pub struct V02State {
     public_state: HashMap<AccountId, Account>,
     private_state: (CommitmentSet, NullifierSet),
     programs: HashMap<ProgramId, Program>,
+    #[borsh(skip)]
+    diff_tracker: DiffTracker,
+    #[borsh(skip)]
+    speculation: Speculation,
 }
 
 impl V02State {
@@ -140,6 +595,8 @@ impl V02State {
             public_state,
             private_state: (private_state, NullifierSet::new()),
             programs: HashMap::new(),
+            diff_tracker: DiffTracker::default(),
+            speculation: Speculation::default(),
         };
 
         this.insert_program(Program::authenticated_transfer_program());
@@ -149,15 +606,276 @@ impl V02State {
         this
     }
 
+    /// Rebuilds a state from a full [`StateDiff`], as produced by [`Self::state_diff`] on a state
+    /// that does not track changes yet.
+    pub fn from_state_diff(diff: StateDiff) -> Self {
+        let StateDiff {
+            accounts,
+            mut commitments,
+            mut commitment_set_digests,
+            root_history_start,
+            nullifiers,
+            programs,
+        } = diff;
+
+        commitments.sort_unstable_by_key(|(index, _)| *index);
+        commitment_set_digests.sort_unstable_by_key(|(position, _)| *position);
+        let commitment_set = CommitmentSet::from_parts(
+            commitments.into_iter().map(|(_, commitment)| commitment),
+            root_history_start,
+            commitment_set_digests
+                .into_iter()
+                .filter(|(position, _)| *position >= root_history_start)
+                .map(|(_, digest)| digest)
+                .collect(),
+        );
+
+        Self {
+            public_state: accounts.into_iter().collect(),
+            private_state: (commitment_set, NullifierSet::from_unsorted(nullifiers)),
+            programs: programs
+                .into_iter()
+                .map(|program| (program.id(), program))
+                .collect(),
+            diff_tracker: DiffTracker::default(),
+            speculation: Speculation::default(),
+        }
+    }
+
+    /// Changes since the last [`Self::clear_state_diff`], or the whole state if changes are not
+    /// tracked yet.
+    pub fn state_diff(&self) -> StateDiff {
+        let Some(log) = &self.diff_tracker.0 else {
+            let mut commitments = self
+                .private_state
+                .0
+                .commitments
+                .iter()
+                .map(|(commitment, index)| (*index, commitment.clone()))
+                .collect::<Vec<_>>();
+            commitments.sort_unstable_by_key(|(index, _)| *index);
+
+            return StateDiff {
+                accounts: self
+                    .public_state
+                    .iter()
+                    .map(|(account_id, account)| (*account_id, account.clone()))
+                    .collect(),
+                commitments,
+                commitment_set_digests: self.private_state.0.root_history.iter().collect(),
+                root_history_start: self.private_state.0.root_history.start,
+                nullifiers: self.private_state.1.iter().cloned().collect(),
+                programs: self.programs.values().cloned().collect(),
+            };
+        };
+
+        StateDiff {
+            accounts: log
+                .accounts
+                .iter()
+                .map(|account_id| (*account_id, self.get_account_by_id(*account_id)))
+                .collect(),
+            commitments: log
+                .commitments
+                .iter()
+                .map(|commitment| {
+                    (
+                        self.private_state.0.commitments[commitment],
+                        commitment.clone(),
+                    )
+                })
+                .collect(),
+            commitment_set_digests: log
+                .commitment_set_digests
+                .iter()
+                .copied()
+                .filter(|(position, _)| *position >= self.private_state.0.root_history.start)
+                .collect(),
+            root_history_start: self.private_state.0.root_history.start,
+            nullifiers: log.nullifiers.clone(),
+            programs: log
+                .programs
+                .iter()
+                .filter_map(|program_id| self.programs.get(program_id).cloned())
+                .collect(),
+        }
+    }
+
+    /// Applies changes taken with [`Self::state_diff`] from a state that was equal to this one
+    /// when it started tracking them, e.g. to keep a read-only copy up to date.
+    ///
+    /// Commitments and digests this state already has are skipped, so a full diff also applies.
+    /// The changes are not recorded in the change tracking of this state.
+    pub fn apply_state_diff(&mut self, diff: &StateDiff) {
+        for (account_id, account) in &diff.accounts {
+            self.public_state.insert(*account_id, account.clone());
+        }
+
+        let known_commitments = self.private_state.0.commitments.len();
+        let mut commitments = diff
+            .commitments
+            .iter()
+            .filter(|(index, _)| *index >= known_commitments)
+            .cloned()
+            .collect::<Vec<_>>();
+        commitments.sort_unstable_by_key(|(index, _)| *index);
+        self.private_state
+            .0
+            .insert_commitments(commitments.into_iter().map(|(_, commitment)| commitment));
+
+        let root_history = &mut self.private_state.0.root_history;
+        for (position, digest) in &diff.commitment_set_digests {
+            root_history.push_at(*position, *digest);
+        }
+        root_history.drop_before(diff.root_history_start);
+
+        self.private_state.1.extend(diff.nullifiers.clone());
+
+        for program in &diff.programs {
+            self.programs.insert(program.id(), program.clone());
+        }
+    }
+
+    /// Marks the current [`Self::state_diff`] as persisted and starts tracking changes from here.
+    pub fn clear_state_diff(&mut self) {
+        self.diff_tracker.0 = Some(ChangeLog::default());
+    }
+
+    /// Starts a speculation: changes made from here can be reverted with
+    /// [`Self::discard_speculation`] in time proportional to their size, instead of cloning the
+    /// state beforehand.
+    ///
+    /// Speculations nest, each commit or discard ends the innermost one.
+    pub fn begin_speculation(&mut self) {
+        self.speculation
+            .checkpoints
+            .push((self.speculation.journal.len(), self.diff_tracker.clone()));
+    }
+
+    /// Keeps the changes of the innermost speculation.
+    pub fn commit_speculation(&mut self) {
+        self.speculation.checkpoints.pop();
+        if self.speculation.checkpoints.is_empty() {
+            self.speculation.journal.clear();
+        }
+    }
+
+    /// Reverts the changes of the innermost speculation.
+    pub fn discard_speculation(&mut self) {
+        let Some((journal_len, diff_tracker)) = self.speculation.checkpoints.pop() else {
+            return;
+        };
+
+        while self.speculation.journal.len() > journal_len {
+            let undo = self
+                .speculation
+                .journal
+                .pop()
+                .expect("Journal is longer than checkpoint");
+            match undo {
+                Undo::Account(account_id, Some(account)) => {
+                    self.public_state.insert(account_id, account);
+                }
+                Undo::Account(account_id, None) => {
+                    self.public_state.remove(&account_id);
+                }
+                Undo::Commitments(commitments, evicted) => {
+                    self.private_state.0.undo_extend(&commitments, evicted);
+                }
+                Undo::Nullifiers(nullifiers) => {
+                    for nullifier in &nullifiers {
+                        self.private_state.1.remove(nullifier);
+                    }
+                }
+                Undo::Program(program_id, Some(program)) => {
+                    self.programs.insert(program_id, program);
+                }
+                Undo::Program(program_id, None) => {
+                    self.programs.remove(&program_id);
+                }
+            }
+        }
+        self.diff_tracker = diff_tracker;
+    }
+
     pub(crate) fn insert_program(&mut self, program: Program) {
-        self.programs.insert(program.id(), program);
+        let program_id = program.id();
+        let previous = self.programs.insert(program_id, program);
+        self.speculation
+            .record(|| Undo::Program(program_id, previous));
+        self.diff_tracker.record(|log| {
+            log.programs.insert(program_id);
+        });
+    }
+
+    /// Sets how many of the most recent commitment set digests proofs may be built against.
+    ///
+    /// Older digests are dropped right away when the window shrinks.
+    pub fn set_root_history_window(&mut self, window: usize) {
+        self.private_state.0.root_history.set_window(window);
+    }
+
+    fn extend_commitments(&mut self, commitments: &[Commitment]) {
+        let evicted = self.private_state.0.root_history.next_evicted();
+        let position = self.private_state.0.extend(commitments);
+        self.speculation
+            .record(|| Undo::Commitments(commitments.to_vec(), evicted));
+        let digest = self.private_state.0.digest();
+        self.diff_tracker.record(|log| {
+            log.commitments.extend_from_slice(commitments);
+            log.commitment_set_digests.push((position, digest));
+        });
+    }
+
+    fn extend_nullifiers(&mut self, nullifiers: Vec<Nullifier>) {
+        let set = &self.private_state.1;
+        self.speculation.record(|| {
+            Undo::Nullifiers(
+                nullifiers
+                    .iter()
+                    .filter(|nullifier| !set.contains(nullifier))
+                    .cloned()
+                    .collect(),
+            )
+        });
+        self.diff_tracker.record(|log| {
+            log.nullifiers.extend_from_slice(&nullifiers);
+        });
+        self.private_state.1.extend(nullifiers);
+    }
+
+    fn insert_account(&mut self, account_id: AccountId, account: Account) {
+        let previous = self.public_state.insert(account_id, account);
+        self.speculation
+            .record(|| Undo::Account(account_id, previous));
+        self.diff_tracker.record(|log| {
+            log.accounts.insert(account_id);
+        });
     }
 
     pub fn transition_from_public_transaction(
         &mut self,
         tx: &PublicTransaction,
     ) -> Result<(), NssaError> {
-        let state_diff = tx.validate_and_produce_public_state_diff(self)?;
+        self.apply_public_transaction(tx, true)
+    }
+
+    /// Same as [`Self::transition_from_public_transaction`], but does not verify signatures.
+    ///
+    /// For transactions that already passed the stateless checks, e.g. in the sequencer mempool.
+    pub fn transition_from_verified_public_transaction(
+        &mut self,
+        tx: &PublicTransaction,
+    ) -> Result<(), NssaError> {
+        self.apply_public_transaction(tx, false)
+    }
+
+    fn apply_public_transaction(
+        &mut self,
+        tx: &PublicTransaction,
+        verify_signatures: bool,
+    ) -> Result<(), NssaError> {
+        let state_diff = tx.validate_and_produce_public_state_diff_with(self, verify_signatures)?;
 
         for (account_id, post) in state_diff.into_iter() {
             let current_account = self.get_account_by_id_mut(account_id);
@@ -176,14 +894,34 @@ impl V02State {
     pub fn transition_from_privacy_preserving_transaction(
         &mut self,
         tx: &PrivacyPreservingTransaction,
+    ) -> Result<(), NssaError> {
+        self.apply_privacy_preserving_transaction(tx, true)
+    }
+
+    /// Same as [`Self::transition_from_privacy_preserving_transaction`], but does not verify
+    /// signatures. The proof is still verified, as it depends on the public pre-states.
+    ///
+    /// For transactions that already passed the stateless checks, e.g. in the sequencer mempool.
+    pub fn transition_from_verified_privacy_preserving_transaction(
+        &mut self,
+        tx: &PrivacyPreservingTransaction,
+    ) -> Result<(), NssaError> {
+        self.apply_privacy_preserving_transaction(tx, false)
+    }
+
+    fn apply_privacy_preserving_transaction(
+        &mut self,
+        tx: &PrivacyPreservingTransaction,
+        verify_signatures: bool,
     ) -> Result<(), NssaError> {
         // 1. Verify the transaction satisfies acceptance criteria
-        let public_state_diff = tx.validate_and_produce_public_state_diff(self)?;
+        let public_state_diff =
+            tx.validate_and_produce_public_state_diff_with(self, verify_signatures)?;
 
         let message = tx.message();
 
         // 2. Add new commitments
-        self.private_state.0.extend(&message.new_commitments);
+        self.extend_commitments(&message.new_commitments);
 
         // 3. Add new nullifiers
         let new_nullifiers = message
@@ -192,7 +930,7 @@ impl V02State {
             .cloned()
             .map(|(nullifier, _)| nullifier)
             .collect::<Vec<Nullifier>>();
-        self.private_state.1.extend(new_nullifiers);
+        self.extend_nullifiers(new_nullifiers);
 
         // 4. Update public accounts
         for (account_id, post) in public_state_diff.into_iter() {
@@ -219,6 +957,12 @@ impl V02State {
     }
 
     fn get_account_by_id_mut(&mut self, account_id: AccountId) -> &mut Account {
+        let public_state = &self.public_state;
+        self.speculation
+            .record(|| Undo::Account(account_id, public_state.get(&account_id).cloned()));
+        self.diff_tracker.record(|log| {
+            log.accounts.insert(account_id);
+        });
         self.public_state.entry(account_id).or_default()
     }
 
@@ -229,6 +973,13 @@ impl V02State {
             .unwrap_or(Account::default())
     }
 
+    /// Nonce of a public account, without cloning the account.
+    pub fn get_account_nonce(&self, account_id: AccountId) -> Nonce {
+        self.public_state
+            .get(&account_id)
+            .map_or(0, |account| account.nonce)
+    }
+
     pub fn get_proof_for_commitment(&self, commitment: &Commitment) -> Option<MembershipProof> {
         self.private_state.0.get_proof_for(commitment)
     }
@@ -280,7 +1031,7 @@ impl V02State {
     pub fn add_pinata_program(&mut self, account_id: AccountId) {
         self.insert_program(Program::pinata());
 
-        self.public_state.insert(
+        self.insert_account(
             account_id,
             Account {
                 program_owner: Program::pinata().id(),
@@ -295,7 +1046,7 @@ impl V02State {
     pub fn add_pinata_token_program(&mut self, account_id: AccountId) {
         self.insert_program(Program::pinata_token());
 
-        self.public_state.insert(
+        self.insert_account(
             account_id,
             Account {
                 program_owner: Program::pinata_token().id(),
@@ -310,7 +1061,7 @@ impl V02State {
 #[cfg(test)]
 pub mod tests {
 
-    use std::collections::HashMap;
+    use std::collections::{BTreeSet, HashMap};
 
     use amm_core::PoolDefinition;
     use nssa_core::{
@@ -334,7 +1085,10 @@ pub mod tests {
         program::Program,
         public_transaction,
         signature::PrivateKey,
-        state::MAX_NUMBER_CHAINED_CALLS,
+        state::{
+            DEFAULT_ROOT_HISTORY_WINDOW, MAX_NUMBER_CHAINED_CALLS, NULLIFIER_MERGE_THRESHOLD,
+            NullifierSet, RootHistory,
+        },
     };
 
     fn transfer_transaction(
@@ -463,6 +1217,29 @@ pub mod tests {
         assert_eq!(state.get_account_by_id(to).nonce, 0);
     }
 
+    #[test]
+    fn transition_from_verified_public_transaction_skips_signature_check() {
+        let key = PrivateKey::try_new([1; 32]).unwrap();
+        let other_key = PrivateKey::try_new([2; 32]).unwrap();
+        let account_id = AccountId::from(&PublicKey::new_from_private_key(&key));
+        let initial_data = [(account_id, 100)];
+        let mut state = V02State::new_with_genesis_accounts(&initial_data, &[]);
+        let to = AccountId::new([2; 32]);
+
+        // Signed with the wrong key
+        let tx = transfer_transaction(account_id, other_key, 0, to, 5);
+
+        let result = state.transition_from_public_transaction(&tx);
+        assert!(matches!(result, Err(NssaError::InvalidInput(_))));
+        assert_eq!(state.get_account_by_id(account_id).balance, 100);
+
+        state
+            .transition_from_verified_public_transaction(&tx)
+            .unwrap();
+        assert_eq!(state.get_account_by_id(account_id).balance, 95);
+        assert_eq!(state.get_account_by_id(to).balance, 5);
+    }
+
     #[test]
     fn transition_from_authenticated_transfer_program_invocation_insuficient_balance() {
         let key = PrivateKey::try_new([1; 32]).unwrap();
@@ -4369,4 +5146,294 @@ pub mod tests {
         let state_from_bytes: V02State = borsh::from_slice(&bytes).unwrap();
         assert_eq!(state, state_from_bytes);
     }
+
+    #[test]
+    fn test_full_state_diff_rebuilds_state() {
+        let account_id_1 = AccountId::new([1; 32]);
+        let account_id_2 = AccountId::new([2; 32]);
+        let initial_data = [(account_id_1, 100u128), (account_id_2, 151u128)];
+        let initial_commitment = Commitment::new(&NullifierPublicKey([3; 32]), &Account::default());
+        let state = V02State::new_with_genesis_accounts(&initial_data, &[initial_commitment]);
+
+        let rebuilt = V02State::from_state_diff(state.state_diff());
+
+        assert_eq!(state, rebuilt);
+        assert_eq!(
+            state.commitment_set_digest(),
+            rebuilt.commitment_set_digest()
+        );
+    }
+
+    #[test]
+    fn test_state_diff_contains_only_changes_after_clear() {
+        let key = PrivateKey::try_new([1; 32]).unwrap();
+        let from = AccountId::from(&PublicKey::new_from_private_key(&key));
+        let untouched = AccountId::new([3; 32]);
+        let initial_data = [(from, 100), (untouched, 50)];
+        let mut state = V02State::new_with_genesis_accounts(&initial_data, &[]);
+        let to = AccountId::new([2; 32]);
+
+        state.clear_state_diff();
+        let tx = transfer_transaction(from, key, 0, to, 5);
+        state.transition_from_public_transaction(&tx).unwrap();
+
+        let diff = state.state_diff();
+        let accounts = diff.accounts.into_iter().collect::<HashMap<_, _>>();
+        assert_eq!(accounts.len(), 2);
+        assert_eq!(accounts[&from], state.get_account_by_id(from));
+        assert_eq!(accounts[&to], state.get_account_by_id(to));
+        assert!(diff.commitments.is_empty());
+        assert!(diff.nullifiers.is_empty());
+        assert!(diff.programs.is_empty());
+
+        state.clear_state_diff();
+        assert!(state.state_diff().accounts.is_empty());
+    }
+
+    #[test]
+    fn test_root_history_keeps_only_window() {
+        let mut history = RootHistory::new(3);
+        for digest in [[1; 32], [2; 32], [1; 32], [3; 32]] {
+            history.push(digest);
+        }
+
+        // The first [1; 32] fell out but its second occurrence is still in the window
+        assert_eq!(history.start, 1);
+        assert!(history.contains(&[1; 32]));
+        assert!(history.contains(&[2; 32]));
+
+        assert_eq!(history.push([4; 32]), 4);
+        assert!(!history.contains(&[2; 32]));
+
+        history.set_window(1);
+        assert_eq!(history.iter().collect::<Vec<_>>(), vec![(4, [4; 32])]);
+        assert!(!history.contains(&[1; 32]));
+    }
+
+    #[test]
+    fn test_digests_outside_window_are_rejected() {
+        let mut state = V02State::new_with_genesis_accounts(&[], &[]);
+        let old_digest = state.commitment_set_digest();
+        state.set_root_history_window(1);
+
+        let commitment = Commitment::new(&NullifierPublicKey([3; 32]), &Account::default());
+        state.extend_commitments(&[commitment]);
+
+        let nullifier = Nullifier::for_account_initialization(&NullifierPublicKey([4; 32]));
+        assert!(matches!(
+            state.check_nullifiers_are_valid(&[(nullifier.clone(), old_digest)]),
+            Err(NssaError::InvalidInput(_))
+        ));
+        assert!(
+            state
+                .check_nullifiers_are_valid(&[(nullifier, state.commitment_set_digest())])
+                .is_ok()
+        );
+    }
+
+    #[test]
+    fn test_legacy_root_history_layout_is_decoded() {
+        let digests = BTreeSet::from([[1; 32], [2; 32]]);
+        let bytes = borsh::to_vec(&digests).unwrap();
+
+        let history: RootHistory = borsh::from_slice(&bytes).unwrap();
+
+        assert_eq!(history.window, DEFAULT_ROOT_HISTORY_WINDOW);
+        assert!(history.contains(&[1; 32]));
+        assert!(history.contains(&[2; 32]));
+        assert_eq!(
+            borsh::from_slice::<RootHistory>(&borsh::to_vec(&history).unwrap()).unwrap(),
+            history
+        );
+    }
+
+    #[test]
+    fn test_legacy_state_keeps_current_root_in_smaller_window() {
+        let mut state = V02State::new_with_genesis_accounts(&[], &[]);
+        state.extend_commitments(&[Commitment::new(
+            &NullifierPublicKey([3; 32]),
+            &Account::default(),
+        )]);
+        let current_digest = state.commitment_set_digest();
+
+        // More digests than the default window, with the current one not sorting last
+        let mut digests = (0..DEFAULT_ROOT_HISTORY_WINDOW as u32 + 100)
+            .map(|i| {
+                let mut digest = [0xff; 32];
+                digest[..4].copy_from_slice(&i.to_be_bytes());
+                digest
+            })
+            .collect::<BTreeSet<_>>();
+        digests.insert(current_digest);
+        assert_ne!(digests.last(), Some(&current_digest));
+
+        let CommitmentSet {
+            merkle_tree,
+            commitments,
+            ..
+        } = &state.private_state.0;
+        let mut legacy = vec![];
+        legacy.extend(borsh::to_vec(&state.public_state).unwrap());
+        legacy.extend(borsh::to_vec(merkle_tree).unwrap());
+        legacy.extend(borsh::to_vec(commitments).unwrap());
+        legacy.extend(borsh::to_vec(&digests).unwrap());
+        legacy.extend(borsh::to_vec(&state.private_state.1).unwrap());
+        legacy.extend(borsh::to_vec(&state.programs).unwrap());
+
+        let mut decoded = borsh::from_slice::<V02State>(&legacy).unwrap();
+        let diff = decoded.state_diff();
+        assert_eq!(
+            diff.commitment_set_digests
+                .last()
+                .map(|(_, digest)| *digest),
+            Some(current_digest)
+        );
+
+        decoded.set_root_history_window(16);
+        let nullifier = Nullifier::for_account_initialization(&NullifierPublicKey([4; 32]));
+        assert!(
+            decoded
+                .check_nullifiers_are_valid(&[(nullifier.clone(), current_digest)])
+                .is_ok()
+        );
+
+        // Further digests evict the arbitrary legacy ones before the current one
+        decoded.extend_commitments(&[Commitment::new(
+            &NullifierPublicKey([5; 32]),
+            &Account::default(),
+        )]);
+        assert!(
+            decoded
+                .check_nullifiers_are_valid(&[(nullifier, current_digest)])
+                .is_ok()
+        );
+    }
+
+    #[test]
+    fn test_nullifier_set_merges_recent_nullifiers() {
+        let nullifiers = (0..2 * NULLIFIER_MERGE_THRESHOLD as u32)
+            .map(|i| {
+                let mut npk = [0; 32];
+                npk[..4].copy_from_slice(&i.to_le_bytes());
+                Nullifier::for_account_initialization(&NullifierPublicKey(npk))
+            })
+            .collect::<Vec<_>>();
+
+        let mut set = NullifierSet::new();
+        for chunk in nullifiers.chunks(100) {
+            set.extend(chunk.to_vec());
+        }
+        // Re-adding known nullifiers does not duplicate them
+        set.extend(nullifiers[..10].to_vec());
+
+        assert!(!set.sorted.is_empty());
+        assert_eq!(set.len(), nullifiers.len());
+        assert!(nullifiers.iter().all(|nullifier| set.contains(nullifier)));
+
+        let bytes = borsh::to_vec(&set).unwrap();
+        let decoded: NullifierSet = borsh::from_slice(&bytes).unwrap();
+        assert!(decoded.recent.is_empty());
+        assert_eq!(decoded, set);
+    }
+
+    #[test]
+    fn test_nullifier_set_rejects_duplicates() {
+        let nullifier = Nullifier::for_account_initialization(&NullifierPublicKey([1; 32]));
+        let other = Nullifier::for_account_initialization(&NullifierPublicKey([2; 32]));
+        let bytes = borsh::to_vec(&vec![nullifier.clone(), other, nullifier]).unwrap();
+
+        assert!(borsh::from_slice::<NullifierSet>(&bytes).is_err());
+    }
+
+    #[test]
+    fn test_discarded_speculation_restores_state() {
+        let key = PrivateKey::try_new([1; 32]).unwrap();
+        let from = AccountId::from(&PublicKey::new_from_private_key(&key));
+        let to = AccountId::new([2; 32]);
+        let mut state = V02State::new_with_genesis_accounts(&[(from, 100)], &[]);
+        // Every further digest evicts one from the window
+        state.set_root_history_window(2);
+        state.extend_commitments(&[Commitment::new(
+            &NullifierPublicKey([3; 32]),
+            &Account::default(),
+        )]);
+        let original = state.clone();
+
+        state.begin_speculation();
+        let tx = transfer_transaction(from, key, 0, to, 5);
+        state.transition_from_public_transaction(&tx).unwrap();
+        state.extend_commitments(&[
+            Commitment::new(&NullifierPublicKey([4; 32]), &Account::default()),
+            Commitment::new(&NullifierPublicKey([5; 32]), &Account::default()),
+        ]);
+        state.extend_nullifiers(vec![Nullifier::for_account_initialization(
+            &NullifierPublicKey([6; 32]),
+        )]);
+        state.insert_program(Program::pinata());
+
+        // A nested speculation is discarded on its own
+        state.begin_speculation();
+        state.extend_commitments(&[Commitment::new(
+            &NullifierPublicKey([7; 32]),
+            &Account::default(),
+        )]);
+        let before_nested = state.commitment_set_digest();
+        state.discard_speculation();
+        assert_ne!(state.commitment_set_digest(), before_nested);
+        assert_eq!(state.private_state.0.commitments.len(), 4);
+
+        state.discard_speculation();
+        assert_eq!(state, original);
+        assert_eq!(
+            state.commitment_set_digest(),
+            original.commitment_set_digest()
+        );
+    }
+
+    #[test]
+    fn test_committed_speculation_keeps_changes() {
+        let key = PrivateKey::try_new([1; 32]).unwrap();
+        let from = AccountId::from(&PublicKey::new_from_private_key(&key));
+        let to = AccountId::new([2; 32]);
+        let mut state = V02State::new_with_genesis_accounts(&[(from, 100)], &[]);
+
+        state.begin_speculation();
+        let tx = transfer_transaction(from, key, 0, to, 5);
+        state.transition_from_public_transaction(&tx).unwrap();
+        state.commit_speculation();
+        // Nothing is left to discard
+        state.discard_speculation();
+
+        assert_eq!(state.get_account_by_id(to).balance, 5);
+        assert!(state.speculation.journal.is_empty());
+    }
+
+    #[test]
+    fn test_applied_state_diff_catches_up_copy() {
+        let key = PrivateKey::try_new([1; 32]).unwrap();
+        let from = AccountId::from(&PublicKey::new_from_private_key(&key));
+        let to = AccountId::new([2; 32]);
+        let mut state = V02State::new_with_genesis_accounts(&[(from, 100)], &[]);
+        let mut copy = state.clone();
+
+        state.clear_state_diff();
+        let tx = transfer_transaction(from, key, 0, to, 5);
+        state.transition_from_public_transaction(&tx).unwrap();
+        state.extend_commitments(&[Commitment::new(
+            &NullifierPublicKey([3; 32]),
+            &Account::default(),
+        )]);
+        state.extend_nullifiers(vec![Nullifier::for_account_initialization(
+            &NullifierPublicKey([4; 32]),
+        )]);
+
+        copy.apply_state_diff(&state.state_diff());
+        assert_eq!(copy, state);
+
+        // Applying the full state skips what the copy already has
+        state.diff_tracker.0 = None;
+        copy.apply_state_diff(&state.state_diff());
+        assert_eq!(copy, state);
+        assert_eq!(copy.commitment_set_digest(), state.commitment_set_digest());
+    }
 }
@@ -0,0 +1,112 @@
+//! Benchmark of building blocks from the mempool.
+//!
+//! Run with `cargo bench -p sequencer_core --features mock`.
+
+use std::{path::Path, time::Duration};
+
+use bedrock_client::BackoffConfig;
+use common::{
+    block::AccountInitialData,
+    test_utils::{create_transaction_native_token_transfer, sequencer_sign_key_for_testing},
+};
+use criterion::{BatchSize, BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use logos_blockchain_core::mantle::ops::channel::ChannelId;
+use nssa::{AccountId, PrivateKey, PublicKey};
+use sequencer_core::{
+    SequencerCoreWithMockClients,
+    config::{BedrockConfig, SequencerConfig},
+};
+
+fn sender_key() -> PrivateKey {
+    PrivateKey::try_new([1; 32]).unwrap()
+}
+
+fn sender() -> AccountId {
+    AccountId::from(&PublicKey::new_from_private_key(&sender_key()))
+}
+
+fn sequencer_config(home: &Path, max_num_tx_in_block: usize) -> SequencerConfig {
+    SequencerConfig {
+        home: home.to_path_buf(),
+        override_rust_log: None,
+        genesis_id: 1,
+        is_genesis_random: false,
+        max_num_tx_in_block,
+        max_block_size: bytesize::ByteSize::mib(16),
+        mempool_max_size: 2 * max_num_tx_in_block,
+        mempool_max_nonce_gap: max_num_tx_in_block as u128,
+        mempool_max_txs_per_sender: max_num_tx_in_block,
+        mempool_gapped_tx_ttl: Duration::from_secs(600),
+        block_create_timeout: Duration::from_secs(1),
+        port: 8080,
+        initial_accounts: vec![AccountInitialData {
+            account_id: sender(),
+            balance: u128::MAX / 2,
+        }],
+        initial_commitments: vec![],
+        root_history_window: nssa::DEFAULT_ROOT_HISTORY_WINDOW,
+        signing_key: *sequencer_sign_key_for_testing().value(),
+        bedrock_config: BedrockConfig {
+            backoff: BackoffConfig {
+                start_delay: Duration::from_millis(100),
+                max_retries: 5,
+            },
+            channel_id: ChannelId::from([0; 32]),
+            node_url: "http://not-used-in-benchmarks".parse().unwrap(),
+            auth: None,
+            settlement_queue_size: 256,
+            settlement_batch_size: 16,
+        },
+        retry_pending_blocks_timeout: Duration::from_secs(60 * 4),
+        indexer_rpc_url: "ws://localhost:8779".parse().unwrap(),
+    }
+}
+
+fn produce_new_block_with_mempool_transactions(c: &mut Criterion) {
+    let runtime = tokio::runtime::Runtime::new().unwrap();
+    let _guard = runtime.enter();
+
+    let mut group = c.benchmark_group("produce_new_block_with_mempool_transactions");
+    group.sample_size(20);
+
+    for txs_per_block in [10, 100, 1000] {
+        let home = tempfile::tempdir().unwrap();
+        let config = sequencer_config(home.path(), txs_per_block);
+        let (mut sequencer, mempool_handle) =
+            runtime.block_on(SequencerCoreWithMockClients::start_from_config(config));
+        let mut nonce = 0;
+
+        group.throughput(Throughput::Elements(txs_per_block as u64));
+        group.bench_function(BenchmarkId::from_parameter(txs_per_block), |b| {
+            b.iter_batched(
+                || {
+                    // The previous block consumed every queued nonce
+                    let next_nonce = nonce;
+                    for _ in 0..txs_per_block {
+                        let tx = create_transaction_native_token_transfer(
+                            sender(),
+                            nonce,
+                            AccountId::new([2; 32]),
+                            1,
+                            sender_key(),
+                        );
+                        let tx = tx.transaction_stateless_check().unwrap();
+                        mempool_handle.push(tx, |_| next_nonce).unwrap();
+                        nonce += 1;
+                    }
+                },
+                |()| {
+                    sequencer
+                        .produce_new_block_with_mempool_transactions()
+                        .unwrap()
+                },
+                BatchSize::PerIteration,
+            )
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, produce_new_block_with_mempool_transactions);
+criterion_main!(benches);
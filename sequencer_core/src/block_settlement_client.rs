@@ -1,6 +1,15 @@
+use std::{
+    sync::{
+        Arc,
+        atomic::{AtomicUsize, Ordering},
+    },
+    time::Duration,
+};
+
 use anyhow::{Context, Result};
 use bedrock_client::BedrockClient;
 pub use common::block::Block;
+use common::{block::MantleMsgId, metrics::BEDROCK_SUBMISSION_SECONDS};
 pub use logos_blockchain_core::mantle::{MantleTx, SignedMantleTx, ops::channel::MsgId};
 use logos_blockchain_core::mantle::{
     Op, OpProof, Transaction, TxHash, ledger,
@@ -8,9 +17,13 @@ use logos_blockchain_core::mantle::{
 };
 pub use logos_blockchain_key_management_system_service::keys::Ed25519Key;
 use logos_blockchain_key_management_system_service::keys::Ed25519PublicKey;
+use tokio::sync::mpsc::{self, error::TrySendError};
 
 use crate::config::BedrockConfig;
 
+/// Number of times a queued block is submitted before it is left to the pending blocks retry
+pub const SETTLEMENT_MAX_ATTEMPTS: u32 = 3;
+
 #[expect(async_fn_in_trait, reason = "We don't care about Send/Sync here")]
 pub trait BlockSettlementClientTrait: Clone {
     //// Create a new client.
@@ -118,6 +131,172 @@ impl BlockSettlementClientTrait for BlockSettlementClient {
     }
 }
 
+/// Signed inscription of a produced block, waiting to be submitted
+struct Settlement {
+    block_id: u64,
+    tx: SignedMantleTx,
+    msg_id: MantleMsgId,
+}
+
+/// Producer side of the settlement pipeline.
+///
+/// Block production enqueues inscriptions without waiting for Bedrock, a
+/// [`SettlementSubmitter`] task posts them in order.
+pub struct SettlementQueue {
+    sender: mpsc::Sender<Settlement>,
+    backlog: Arc<AtomicUsize>,
+}
+
+impl SettlementQueue {
+    /// Queue the inscription of block `block_id` for submission.
+    ///
+    /// Does not wait: if the queue is full the block stays pending in the store and is
+    /// submitted by the pending blocks retry instead.
+    pub fn enqueue(&self, block_id: u64, tx: SignedMantleTx, msg_id: MsgId) {
+        // Counted before sending so that the submitter never sees a smaller backlog
+        self.backlog.fetch_add(1, Ordering::Relaxed);
+        match self.sender.try_send(Settlement {
+            block_id,
+            tx,
+            msg_id: msg_id.into(),
+        }) {
+            Ok(()) => {}
+            Err(TrySendError::Full(_)) => {
+                self.backlog.fetch_sub(1, Ordering::Relaxed);
+                log::warn!(
+                    "Settlement queue is full, block {block_id} is left to the pending blocks retry"
+                );
+            }
+            Err(TrySendError::Closed(_)) => {
+                self.backlog.fetch_sub(1, Ordering::Relaxed);
+                log::warn!(
+                    "Settlement submitter is not running, block {block_id} is left to the pending blocks retry"
+                );
+            }
+        }
+    }
+
+    /// Number of queued blocks not yet submitted to Bedrock.
+    pub fn backlog(&self) -> usize {
+        self.backlog.load(Ordering::Relaxed)
+    }
+}
+
+/// Consumer side of the settlement pipeline, run as a dedicated task.
+pub struct SettlementSubmitter<BC: BlockSettlementClientTrait> {
+    client: BC,
+    receiver: mpsc::Receiver<Settlement>,
+    backlog: Arc<AtomicUsize>,
+    batch_size: usize,
+    retry_delay: Duration,
+    last_msg_id: Option<MantleMsgId>,
+}
+
+/// Create the two ends of the settlement pipeline for `client`.
+pub fn settlement_pipeline<BC: BlockSettlementClientTrait>(
+    client: BC,
+    config: &BedrockConfig,
+) -> (SettlementQueue, SettlementSubmitter<BC>) {
+    let (sender, receiver) = mpsc::channel(config.settlement_queue_size.max(1));
+    let backlog = Arc::new(AtomicUsize::new(0));
+    (
+        SettlementQueue {
+            sender,
+            backlog: Arc::clone(&backlog),
+        },
+        SettlementSubmitter {
+            client,
+            receiver,
+            backlog,
+            batch_size: config.settlement_batch_size.max(1),
+            retry_delay: config.backoff.start_delay,
+            last_msg_id: None,
+        },
+    )
+}
+
+impl<BC: BlockSettlementClientTrait> SettlementSubmitter<BC> {
+    /// Submit queued blocks until the queue is closed.
+    pub async fn run(mut self) -> Result<()> {
+        while self.submit_next_batch().await {}
+        Ok(())
+    }
+
+    /// Wait for queued blocks and submit all that are available, up to the batch size.
+    ///
+    /// Blocks are submitted one after the other in queue order, so every inscription is posted
+    /// after its parent. A failed submission is retried with a growing delay before moving on to
+    /// the next block. Returns `false` once the queue is closed.
+    pub async fn submit_next_batch(&mut self) -> bool {
+        let mut batch = Vec::with_capacity(self.batch_size);
+        if self.receiver.recv_many(&mut batch, self.batch_size).await == 0 {
+            return false;
+        }
+
+        if batch.len() > 1 {
+            log::info!(
+                "Submitting blocks {} to {} to Bedrock",
+                batch[0].block_id,
+                batch[batch.len() - 1].block_id
+            );
+        }
+
+        for settlement in batch {
+            self.submit_with_retries(settlement).await;
+            self.backlog.fetch_sub(1, Ordering::Relaxed);
+        }
+        true
+    }
+
+    async fn submit_with_retries(&mut self, settlement: Settlement) {
+        let Settlement {
+            block_id,
+            tx,
+            msg_id,
+        } = settlement;
+
+        if let (Some(last_msg_id), Some(Op::ChannelInscribe(inscribe))) =
+            (self.last_msg_id, tx.mantle_tx.ops.first())
+            && MantleMsgId::from(inscribe.parent) != last_msg_id
+        {
+            log::warn!(
+                "Block {block_id} does not extend the last submitted block, \
+                 the blocks in between are left to the pending blocks retry"
+            );
+        }
+
+        let mut delay = self.retry_delay;
+        for attempt in 1..=SETTLEMENT_MAX_ATTEMPTS {
+            let timer = BEDROCK_SUBMISSION_SECONDS.start_timer();
+            let res = self.client.submit_inscribe_tx_to_bedrock(tx.clone()).await;
+            timer.observe_duration();
+
+            match res {
+                Ok(()) => {
+                    self.last_msg_id = Some(msg_id);
+                    return;
+                }
+                Err(err) if attempt < SETTLEMENT_MAX_ATTEMPTS => {
+                    log::warn!(
+                        "Failed to post block {block_id} to Bedrock (attempt {attempt}), \
+                         retrying in {delay:?}: {err:#}"
+                    );
+                    tokio::time::sleep(delay).await;
+                    delay *= 2;
+                }
+                Err(err) => {
+                    log::error!(
+                        "Failed to post block {block_id} to Bedrock, \
+                         leaving it to the pending blocks retry: {err:#}"
+                    );
+                }
+            }
+        }
+        // Following blocks still extend this one once it is resubmitted
+        self.last_msg_id = Some(msg_id);
+    }
+}
+
 fn empty_ledger_signature(
     tx_hash: &TxHash,
 ) -> logos_blockchain_key_management_system_service::keys::ZkSignature {
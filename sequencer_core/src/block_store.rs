@@ -1,4 +1,8 @@
-use std::{collections::HashMap, path::Path};
+use std::{
+    collections::{HashMap, VecDeque},
+    path::Path,
+    sync::Arc,
+};
 
 use anyhow::Result;
 use common::{
@@ -6,13 +10,17 @@ use common::{
     block::{Block, BlockMeta, MantleMsgId},
     transaction::NSSATransaction,
 };
-use nssa::V02State;
+use nssa::{StateDiff, V02State};
 use storage::sequencer::RocksDBIO;
 
+/// Number of recently stored transactions whose block id is kept in memory
+pub const TX_HASH_CACHE_SIZE: usize = 10_000;
+
 pub struct SequencerStore {
-    dbio: RocksDBIO,
-    // TODO: Consider adding the hashmap to the database for faster recovery.
-    tx_hash_to_block_map: HashMap<HashType, u64>,
+    /// Shared with the read view
+    dbio: Arc<RocksDBIO>,
+    /// Block ids of recently stored transactions, on top of the tx hash index in the DB
+    tx_hash_cache: TxHashCache,
     genesis_id: u64,
     signing_key: nssa::PrivateKey,
 }
@@ -27,20 +35,14 @@ impl SequencerStore {
         genesis_block: Option<(&Block, MantleMsgId)>,
         signing_key: nssa::PrivateKey,
     ) -> Result<Self> {
-        let tx_hash_to_block_map = if let Some((block, _msg_id)) = &genesis_block {
-            block_to_transactions_map(block)
-        } else {
-            HashMap::new()
-        };
-
         let dbio = RocksDBIO::open_or_create(location, genesis_block)?;
 
         let genesis_id = dbio.get_meta_first_block_in_db()?;
 
         Ok(Self {
-            dbio,
+            dbio: Arc::new(dbio),
             genesis_id,
-            tx_hash_to_block_map,
+            tx_hash_cache: TxHashCache::new(TX_HASH_CACHE_SIZE),
             signing_key,
         })
     }
@@ -55,6 +57,7 @@ impl SequencerStore {
     }
 
     pub fn delete_block_at_id(&mut self, block_id: u64) -> Result<()> {
+        self.tx_hash_cache.remove_block(block_id);
         Ok(self.dbio.delete_block(block_id)?)
     }
 
@@ -64,16 +67,15 @@ impl SequencerStore {
 
     /// Returns the transaction corresponding to the given hash, if it exists in the blockchain.
     pub fn get_transaction_by_hash(&self, hash: HashType) -> Option<NSSATransaction> {
-        let block_id = self.tx_hash_to_block_map.get(&hash);
-        let block = block_id.map(|&id| self.get_block_at_id(id));
-        if let Some(Ok(block)) = block {
-            for transaction in block.body.transactions.into_iter() {
-                if transaction.hash() == hash {
-                    return Some(transaction);
-                }
-            }
-        }
-        None
+        let block_id = match self.tx_hash_cache.get(&hash) {
+            Some(block_id) => Some(block_id),
+            None => self.dbio.get_block_id_by_tx_hash(hash).ok().flatten(),
+        }?;
+        find_transaction(&self.dbio, block_id, hash)
+    }
+
+    pub(crate) fn dbio(&self) -> Arc<RocksDBIO> {
+        Arc::clone(&self.dbio)
     }
 
     pub fn latest_block_meta(&self) -> Result<BlockMeta> {
@@ -92,30 +94,86 @@ impl SequencerStore {
         self.dbio.get_all_blocks().map(|res| Ok(res?))
     }
 
+    /// Store `block` and the state changes made since the previous update, and return them.
     pub(crate) fn update(
         &mut self,
         block: &Block,
         msg_id: MantleMsgId,
-        state: &V02State,
-    ) -> Result<()> {
-        let new_transactions_map = block_to_transactions_map(block);
-        self.dbio.atomic_update(block, msg_id, state)?;
-        self.tx_hash_to_block_map.extend(new_transactions_map);
-        Ok(())
+        state: &mut V02State,
+    ) -> Result<StateDiff> {
+        let diff = state.state_diff();
+        self.dbio.atomic_update(block, msg_id, &diff)?;
+        state.clear_state_diff();
+        self.tx_hash_cache.insert_block(block);
+        Ok(diff)
     }
 
     pub fn get_nssa_state(&self) -> Option<V02State> {
-        self.dbio.get_nssa_state().ok()
+        let mut state = self.dbio.get_nssa_state().ok()?;
+        // Everything loaded is already persisted, only later changes need to be written
+        state.clear_state_diff();
+        Some(state)
     }
 }
 
-pub(crate) fn block_to_transactions_map(block: &Block) -> HashMap<HashType, u64> {
+/// Find the transaction with hash `hash` in the stored block `block_id`.
+pub(crate) fn find_transaction(
+    dbio: &RocksDBIO,
+    block_id: u64,
+    hash: HashType,
+) -> Option<NSSATransaction> {
+    let block = dbio.get_block(block_id).ok()?;
     block
         .body
         .transactions
-        .iter()
-        .map(|transaction| (transaction.hash(), block.header.block_id))
-        .collect()
+        .into_iter()
+        .find(|transaction| transaction.hash() == hash)
+}
+
+/// Bounded map of tx hashes to block ids, evicting the oldest stored transactions first.
+struct TxHashCache {
+    capacity: usize,
+    block_ids: HashMap<HashType, u64>,
+    order: VecDeque<HashType>,
+}
+
+impl TxHashCache {
+    fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            block_ids: HashMap::new(),
+            order: VecDeque::new(),
+        }
+    }
+
+    fn get(&self, tx_hash: &HashType) -> Option<u64> {
+        self.block_ids.get(tx_hash).copied()
+    }
+
+    fn insert_block(&mut self, block: &Block) {
+        for transaction in &block.body.transactions {
+            let tx_hash = transaction.hash();
+            if self
+                .block_ids
+                .insert(tx_hash, block.header.block_id)
+                .is_none()
+            {
+                self.order.push_back(tx_hash);
+            }
+        }
+
+        while self.order.len() > self.capacity {
+            if let Some(tx_hash) = self.order.pop_front() {
+                self.block_ids.remove(&tx_hash);
+            }
+        }
+    }
+
+    fn remove_block(&mut self, block_id: u64) {
+        self.block_ids.retain(|_, id| *id != block_id);
+        let block_ids = &self.block_ids;
+        self.order.retain(|tx_hash| block_ids.contains_key(tx_hash));
+    }
 }
 
 #[cfg(test)]
@@ -155,10 +213,19 @@ mod tests {
         let retrieved_tx = node_store.get_transaction_by_hash(tx.hash());
         assert_eq!(None, retrieved_tx);
         // Add the block with the transaction
-        let dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
-        node_store.update(&block, [1; 32], &dummy_state).unwrap();
+        let mut dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
+        node_store
+            .update(&block, [1; 32], &mut dummy_state)
+            .unwrap();
         // Try again
         let retrieved_tx = node_store.get_transaction_by_hash(tx.hash());
+        assert_eq!(Some(tx.clone()), retrieved_tx);
+
+        // The tx hash index survives a restart
+        drop(node_store);
+        let node_store =
+            SequencerStore::open_db_restart(path, sequencer_sign_key_for_testing()).unwrap();
+        let retrieved_tx = node_store.get_transaction_by_hash(tx.hash());
         assert_eq!(Some(tx), retrieved_tx);
     }
 
@@ -220,9 +287,9 @@ mod tests {
         let block_hash = block.header.hash;
         let block_msg_id = [1; 32];
 
-        let dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
+        let mut dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
         node_store
-            .update(&block, block_msg_id, &dummy_state)
+            .update(&block, block_msg_id, &mut dummy_state)
             .unwrap();
 
         // Verify that the latest block meta now equals the new block's hash and msg_id
@@ -258,8 +325,10 @@ mod tests {
         let block = common::test_utils::produce_dummy_block(1, None, vec![tx.clone()]);
         let block_id = block.header.block_id;
 
-        let dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
-        node_store.update(&block, [1; 32], &dummy_state).unwrap();
+        let mut dummy_state = V02State::new_with_genesis_accounts(&[], &[]);
+        node_store
+            .update(&block, [1; 32], &mut dummy_state)
+            .unwrap();
 
         // Verify initial status is Pending
         let retrieved_block = node_store.get_block_at_id(block_id).unwrap();
@@ -278,4 +347,53 @@ mod tests {
             common::block::BedrockStatus::Finalized
         ));
     }
+
+    #[test]
+    fn test_state_is_restored_from_incremental_updates() {
+        let temp_dir = tempdir().unwrap();
+        let path = temp_dir.path();
+
+        let signing_key = sequencer_sign_key_for_testing();
+
+        let genesis_block_hashable_data = HashableBlockData {
+            block_id: 0,
+            prev_block_hash: HashType([0; 32]),
+            timestamp: 0,
+            transactions: vec![],
+        };
+
+        let genesis_block = genesis_block_hashable_data.into_pending_block(&signing_key, [0; 32]);
+        let mut node_store = SequencerStore::open_db_with_genesis(
+            path,
+            Some((&genesis_block, [0; 32])),
+            signing_key,
+        )
+        .unwrap();
+        assert!(node_store.get_nssa_state().is_none());
+
+        let account_id = nssa::AccountId::new([1; 32]);
+        let mut state = V02State::new_with_genesis_accounts(&[(account_id, 100)], &[]);
+
+        // First update writes the whole state
+        let block = common::test_utils::produce_dummy_block(1, None, vec![]);
+        node_store.update(&block, [1; 32], &mut state).unwrap();
+
+        // Second update writes only the pinata changes
+        let pinata_id = nssa::AccountId::new([2; 32]);
+        state.add_pinata_program(pinata_id);
+        let block = common::test_utils::produce_dummy_block(2, None, vec![]);
+        node_store.update(&block, [2; 32], &mut state).unwrap();
+
+        let restored = node_store.get_nssa_state().unwrap();
+        assert_eq!(restored.get_account_by_id(account_id).balance, 100);
+        assert_eq!(
+            restored.get_account_by_id(pinata_id),
+            state.get_account_by_id(pinata_id)
+        );
+        assert_eq!(
+            restored.commitment_set_digest(),
+            state.commitment_set_digest()
+        );
+        assert!(restored.state_diff().accounts.is_empty());
+    }
 }
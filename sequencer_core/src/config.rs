@@ -35,6 +35,15 @@ pub struct SequencerConfig {
     pub max_block_size: ByteSize,
     /// Mempool maximum size
     pub mempool_max_size: usize,
+    /// How far ahead of the next nonce of their signer transactions are admitted to the mempool
+    #[serde(default = "default_mempool_max_nonce_gap")]
+    pub mempool_max_nonce_gap: u128,
+    /// Maximum number of transactions of one signer in the mempool
+    #[serde(default = "default_mempool_max_txs_per_sender")]
+    pub mempool_max_txs_per_sender: usize,
+    /// Time after which transactions still waiting behind a nonce gap are dropped
+    #[serde(with = "humantime_serde", default = "default_mempool_gapped_tx_ttl")]
+    pub mempool_gapped_tx_ttl: Duration,
     /// Interval in which blocks produced
     #[serde(with = "humantime_serde")]
     pub block_create_timeout: Duration,
@@ -47,6 +56,11 @@ pub struct SequencerConfig {
     pub initial_accounts: Vec<AccountInitialData>,
     /// List of initial commitments
     pub initial_commitments: Vec<CommitmentsInitialData>,
+    /// Number of most recent commitment set digests that private transactions may prove against
+    ///
+    /// Must match the indexer.
+    #[serde(default = "default_root_history_window")]
+    pub root_history_window: usize,
     /// Sequencer own signing key
     pub signing_key: [u8; 32],
     /// Bedrock configuration options
@@ -66,9 +80,25 @@ pub struct BedrockConfig {
     pub node_url: Url,
     /// Bedrock auth
     pub auth: Option<BasicAuth>,
+    /// Maximum number of produced blocks waiting to be submitted to Bedrock
+    ///
+    /// Blocks that do not fit are left to the pending blocks retry.
+    #[serde(default = "default_settlement_queue_size")]
+    pub settlement_queue_size: usize,
+    /// Maximum number of queued blocks submitted in one round
+    #[serde(default = "default_settlement_batch_size")]
+    pub settlement_batch_size: usize,
 }
 
 impl SequencerConfig {
+    pub fn mempool_sender_limits(&self) -> mempool::SenderLimits {
+        mempool::SenderLimits {
+            max_nonce_gap: self.mempool_max_nonce_gap,
+            max_items: self.mempool_max_txs_per_sender,
+            gapped_ttl: self.mempool_gapped_tx_ttl,
+        }
+    }
+
     pub fn from_path(config_home: &Path) -> Result<SequencerConfig> {
         let file = File::open(config_home)?;
         let reader = BufReader::new(file);
@@ -80,3 +110,27 @@ impl SequencerConfig {
 fn default_max_block_size() -> ByteSize {
     ByteSize::mib(1)
 }
+
+fn default_mempool_max_nonce_gap() -> u128 {
+    mempool::SenderLimits::default().max_nonce_gap
+}
+
+fn default_mempool_max_txs_per_sender() -> usize {
+    mempool::SenderLimits::default().max_items
+}
+
+fn default_mempool_gapped_tx_ttl() -> Duration {
+    mempool::SenderLimits::default().gapped_ttl
+}
+
+fn default_root_history_window() -> usize {
+    nssa::DEFAULT_ROOT_HISTORY_WINDOW
+}
+
+fn default_settlement_queue_size() -> usize {
+    256
+}
+
+fn default_settlement_batch_size() -> usize {
+    16
+}
@@ -7,7 +7,8 @@ use common::PINATA_BASE58;
 use common::{
     HashType,
     block::{BedrockStatus, Block, HashableBlockData},
-    transaction::NSSATransaction,
+    metrics::{BLOCK_BUILD_SECONDS, MEMPOOL_DEPTH},
+    transaction::{NSSATransaction, VerifiedTransaction},
 };
 use config::SequencerConfig;
 use log::{error, info, warn};
@@ -15,9 +16,13 @@ use logos_blockchain_key_management_system_service::keys::{ED25519_SECRET_KEY_SI
 use mempool::{MemPool, MemPoolHandle};
 
 use crate::{
-    block_settlement_client::{BlockSettlementClient, BlockSettlementClientTrait, MsgId},
+    block_settlement_client::{
+        BlockSettlementClient, BlockSettlementClientTrait, MsgId, SettlementQueue,
+        SettlementSubmitter, settlement_pipeline,
+    },
     block_store::SequencerStore,
     indexer_client::{IndexerClient, IndexerClientTrait},
+    read_view::SequencerReadView,
 };
 
 pub mod block_settlement_client;
@@ -26,6 +31,7 @@ pub mod config;
 pub mod indexer_client;
 #[cfg(feature = "mock")]
 pub mod mock;
+pub mod read_view;
 
 #[cfg(feature = "mock")]
 pub use mock::SequencerCoreWithMockClients;
@@ -36,10 +42,14 @@ pub struct SequencerCore<
 > {
     state: nssa::V02State,
     store: SequencerStore,
-    mempool: MemPool<NSSATransaction>,
+    read_view: SequencerReadView,
+    mempool: MemPool<VerifiedTransaction>,
     sequencer_config: SequencerConfig,
     chain_height: u64,
     block_settlement_client: BC,
+    settlement_queue: SettlementQueue,
+    /// Taken by the task that submits queued blocks
+    settlement_submitter: Option<SettlementSubmitter<BC>>,
     indexer_client: IC,
 }
 
@@ -51,7 +61,7 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
     /// initializing its state with the accounts defined in the configuration file.
     pub async fn start_from_config(
         config: SequencerConfig,
-    ) -> (Self, MemPoolHandle<NSSATransaction>) {
+    ) -> (Self, MemPoolHandle<VerifiedTransaction>) {
         let hashable_data = HashableBlockData {
             block_id: config.genesis_id,
             transactions: vec![],
@@ -90,7 +100,6 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
             .latest_block_meta()
             .expect("Failed to read latest block meta from store");
 
-        #[cfg_attr(not(feature = "testnet"), allow(unused_mut))]
         let mut state = match store.get_nssa_state() {
             Some(state) => {
                 info!("Found local database. Loading state and pending blocks from it.");
@@ -124,65 +133,80 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
                 nssa::V02State::new_with_genesis_accounts(&init_accs, &initial_commitments)
             }
         };
+        state.set_root_history_window(config.root_history_window);
 
         #[cfg(feature = "testnet")]
         state.add_pinata_program(PINATA_BASE58.parse().unwrap());
 
-        let (mempool, mempool_handle) = MemPool::new(config.mempool_max_size);
+        let (mempool, mempool_handle) =
+            MemPool::with_sender_limits(config.mempool_max_size, config.mempool_sender_limits());
+        let (settlement_queue, settlement_submitter) =
+            settlement_pipeline(block_settlement_client.clone(), &config.bedrock_config);
+
+        let read_view = SequencerReadView::new(
+            state.clone(),
+            latest_block_meta.id,
+            store.dbio(),
+            store.genesis_id(),
+            config.initial_accounts.clone(),
+        );
 
         let sequencer_core = Self {
             state,
             store,
+            read_view,
             mempool,
             chain_height: latest_block_meta.id,
             sequencer_config: config,
             block_settlement_client,
+            settlement_queue,
+            settlement_submitter: Some(settlement_submitter),
             indexer_client,
         };
 
         (sequencer_core, mempool_handle)
     }
 
+    /// Execute a mempool transaction on the state.
+    ///
+    /// Signatures are not verified again, mempool transactions are [`VerifiedTransaction`]s.
     fn execute_check_transaction_on_state(
         &mut self,
-        tx: NSSATransaction,
+        tx: VerifiedTransaction,
     ) -> Result<NSSATransaction, nssa::error::NssaError> {
-        match &tx {
-            NSSATransaction::Public(tx) => self.state.transition_from_public_transaction(tx),
-            NSSATransaction::PrivacyPreserving(tx) => self
-                .state
-                .transition_from_privacy_preserving_transaction(tx),
-            NSSATransaction::ProgramDeployment(tx) => self
-                .state
-                .transition_from_program_deployment_transaction(tx),
-        }
-        .inspect_err(|err| warn!("Error at transition {err:#?}"))?;
-
-        Ok(tx)
+        tx.execute_on_state(&mut self.state)
     }
 
-    pub async fn produce_new_block(&mut self) -> Result<u64> {
-        let (tx, _msg_id) = self
+    /// Produces a new block and queues it for submission to Bedrock.
+    ///
+    /// Does not wait for Bedrock, the block is posted by the [`SettlementSubmitter`] task.
+    pub fn produce_new_block(&mut self) -> Result<u64> {
+        let (tx, msg_id) = self
             .produce_new_block_with_mempool_transactions()
             .context("Failed to produce new block with mempool transactions")?;
-        match self
-            .block_settlement_client
-            .submit_inscribe_tx_to_bedrock(tx)
-            .await
-        {
-            Ok(()) => {}
-            Err(err) => {
-                error!("Failed to post block data to Bedrock with error: {err:#}");
-            }
-        }
+        self.settlement_queue.enqueue(self.chain_height, tx, msg_id);
 
         Ok(self.chain_height)
     }
 
     /// Produces new block from transactions in mempool and packs it into a SignedMantleTx.
+    ///
+    /// Transactions are applied speculatively, so a block that fails to be built or stored
+    /// leaves the state as it was.
     pub fn produce_new_block_with_mempool_transactions(
         &mut self,
     ) -> Result<(SignedMantleTx, MsgId)> {
+        self.state.begin_speculation();
+        let res = self.build_and_store_block();
+        if res.is_ok() {
+            self.state.commit_speculation();
+        } else {
+            self.state.discard_speculation();
+        }
+        res
+    }
+
+    fn build_and_store_block(&mut self) -> Result<(SignedMantleTx, MsgId)> {
         let now = Instant::now();
 
         let new_block_height = self.chain_height + 1;
@@ -198,28 +222,36 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
 
         let curr_time = chrono::Utc::now().timestamp_millis() as u64;
 
-        while let Some(tx) = self.mempool.pop() {
+        // Block size is tracked incrementally: the encoding of a block without transactions plus
+        // the encoded length of every transaction added so far.
+        let mut block_size = borsh::object_length(&HashableBlockData {
+            block_id: new_block_height,
+            transactions: vec![],
+            prev_block_hash: latest_block_meta.hash,
+            timestamp: curr_time,
+        })
+        .context("Failed to serialize block for size check")?;
+
+        // Duplicates are rejected on admission. Transactions are taken in nonce order per signer,
+        // stale ones are dropped and the ones after a nonce gap are left in the mempool.
+        self.mempool
+            .recheck_gapped(|account_id| self.state.get_account_nonce(*account_id));
+        while let Some(tx) = self
+            .mempool
+            .pop(|account_id| self.state.get_account_nonce(*account_id))
+        {
             let tx_hash = tx.hash();
 
             // Check if block size exceeds limit
-            let temp_valid_transactions =
-                [valid_transactions.as_slice(), std::slice::from_ref(&tx)].concat();
-            let temp_hashable_data = HashableBlockData {
-                block_id: new_block_height,
-                transactions: temp_valid_transactions,
-                prev_block_hash: latest_block_meta.hash,
-                timestamp: curr_time,
-            };
-
-            let block_size = borsh::to_vec(&temp_hashable_data)
-                .context("Failed to serialize block for size check")?
-                .len();
-
-            if block_size > max_block_size {
+            let tx_size = borsh::object_length(tx.transaction())
+                .context("Failed to serialize transaction for size check")?;
+            let new_block_size = block_size + tx_size;
+
+            if new_block_size > max_block_size {
                 // Block would exceed size limit, remove last transaction and push back
                 warn!(
                     "Transaction with hash {tx_hash} deferred to next block: \
-                     block size {block_size} bytes would exceed limit of {max_block_size} bytes",
+                     block size {new_block_size} bytes would exceed limit of {max_block_size} bytes",
                 );
 
                 self.mempool.push_front(tx);
@@ -229,6 +261,7 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
             match self.execute_check_transaction_on_state(tx) {
                 Ok(valid_tx) => {
                     valid_transactions.push(valid_tx);
+                    block_size = new_block_size;
 
                     info!("Validated transaction with hash {tx_hash}, including it in block");
 
@@ -266,14 +299,19 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
                 )
             })?;
 
-        self.store.update(&block, msg_id.into(), &self.state)?;
+        let diff = self.store.update(&block, msg_id.into(), &mut self.state)?;
 
         self.chain_height = new_block_height;
+        self.read_view.publish(&diff, new_block_height);
+
+        let elapsed = now.elapsed();
+        BLOCK_BUILD_SECONDS.observe(elapsed.as_secs_f64());
+        MEMPOOL_DEPTH.set(self.mempool.len() as i64);
 
         log::info!(
-            "Created block with {} transactions in {} seconds",
+            "Created block with {} transactions in {} ms",
             hashable_data.transactions.len(),
-            now.elapsed().as_secs()
+            elapsed.as_millis()
         );
         Ok((tx, msg_id))
     }
@@ -286,6 +324,11 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
         &self.store
     }
 
+    /// Handle to read the state and blocks without holding on to the sequencer.
+    pub fn read_view(&self) -> SequencerReadView {
+        self.read_view.clone()
+    }
+
     pub fn chain_height(&self) -> u64 {
         self.chain_height
     }
@@ -319,6 +362,8 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
     }
 
     /// Returns the list of stored pending blocks.
+    ///
+    /// Includes blocks still waiting in the settlement queue, see [`Self::settlement_backlog`].
     pub fn get_pending_blocks(&self) -> Result<Vec<Block>> {
         Ok(self
             .store
@@ -329,6 +374,18 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> SequencerCore<BC, I
             .collect())
     }
 
+    /// Number of produced blocks queued for submission to Bedrock and not submitted yet.
+    pub fn settlement_backlog(&self) -> usize {
+        self.settlement_queue.backlog()
+    }
+
+    /// Take the submitter of queued blocks, to be run as a dedicated task.
+    ///
+    /// Returns `None` if it was already taken.
+    pub fn take_settlement_submitter(&mut self) -> Option<SettlementSubmitter<BC>> {
+        self.settlement_submitter.take()
+    }
+
     pub fn block_settlement_client(&self) -> BC {
         self.block_settlement_client.clone()
     }
@@ -360,16 +417,18 @@ fn load_or_create_signing_key(path: &Path) -> Result<Ed25519Key> {
 
 #[cfg(all(test, feature = "mock"))]
 mod tests {
-    use std::{pin::pin, str::FromStr as _, time::Duration};
+    use std::{str::FromStr as _, time::Duration};
 
     use base58::ToBase58;
     use bedrock_client::BackoffConfig;
     use common::{
-        block::AccountInitialData, test_utils::sequencer_sign_key_for_testing,
-        transaction::NSSATransaction,
+        HashType,
+        block::{AccountInitialData, HashableBlockData},
+        test_utils::sequencer_sign_key_for_testing,
+        transaction::{NSSATransaction, VerifiedTransaction},
     };
     use logos_blockchain_core::mantle::ops::channel::ChannelId;
-    use mempool::MemPoolHandle;
+    use mempool::{MemPoolError, MemPoolHandle};
     use nssa::{AccountId, PrivateKey};
 
     use crate::{
@@ -377,6 +436,18 @@ mod tests {
         mock::SequencerCoreWithMockClients,
     };
 
+    /// Push `tx` checked against the nonces of the sequencer state, as the RPC does.
+    fn push_tx(
+        sequencer: &SequencerCoreWithMockClients,
+        mempool_handle: &MemPoolHandle<VerifiedTransaction>,
+        tx: NSSATransaction,
+    ) -> Result<(), MemPoolError> {
+        let tx = tx.transaction_stateless_check().unwrap();
+        mempool_handle.push(tx, |account_id| {
+            sequencer.state().get_account_nonce(*account_id)
+        })
+    }
+
     fn setup_sequencer_config_variable_initial_accounts(
         initial_accounts: Vec<AccountInitialData>,
     ) -> SequencerConfig {
@@ -391,10 +462,14 @@ mod tests {
             max_num_tx_in_block: 10,
             max_block_size: bytesize::ByteSize::mib(1),
             mempool_max_size: 10000,
+            mempool_max_nonce_gap: 64,
+            mempool_max_txs_per_sender: 64,
+            mempool_gapped_tx_ttl: Duration::from_secs(600),
             block_create_timeout: Duration::from_secs(1),
             port: 8080,
             initial_accounts,
             initial_commitments: vec![],
+            root_history_window: nssa::DEFAULT_ROOT_HISTORY_WINDOW,
             signing_key: *sequencer_sign_key_for_testing().value(),
             bedrock_config: BedrockConfig {
                 backoff: BackoffConfig {
@@ -404,6 +479,8 @@ mod tests {
                 channel_id: ChannelId::from([0; 32]),
                 node_url: "http://not-used-in-unit-tests".parse().unwrap(),
                 auth: None,
+                settlement_queue_size: 256,
+                settlement_batch_size: 16,
             },
             retry_pending_blocks_timeout: Duration::from_secs(60 * 4),
             indexer_rpc_url: "ws://localhost:8779".parse().unwrap(),
@@ -444,19 +521,25 @@ mod tests {
         nssa::PrivateKey::try_new([2; 32]).unwrap()
     }
 
-    async fn common_setup() -> (SequencerCoreWithMockClients, MemPoolHandle<NSSATransaction>) {
+    async fn common_setup() -> (
+        SequencerCoreWithMockClients,
+        MemPoolHandle<VerifiedTransaction>,
+    ) {
         let config = setup_sequencer_config();
         common_setup_with_config(config).await
     }
 
     async fn common_setup_with_config(
         config: SequencerConfig,
-    ) -> (SequencerCoreWithMockClients, MemPoolHandle<NSSATransaction>) {
+    ) -> (
+        SequencerCoreWithMockClients,
+        MemPoolHandle<VerifiedTransaction>,
+    ) {
         let (mut sequencer, mempool_handle) =
             SequencerCoreWithMockClients::start_from_config(config).await;
 
         let tx = common::test_utils::produce_dummy_empty_transaction();
-        mempool_handle.push(tx).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, tx).unwrap();
 
         sequencer
             .produce_new_block_with_mempool_transactions()
@@ -626,30 +709,42 @@ mod tests {
     }
 
     #[tokio::test]
-    async fn test_push_tx_into_mempool_blocks_until_mempool_is_full() {
+    async fn test_push_tx_into_full_mempool_is_rejected() {
         let config = SequencerConfig {
             mempool_max_size: 1,
             ..setup_sequencer_config()
         };
+        let acc1 = config.initial_accounts[0].account_id;
+        let acc2 = config.initial_accounts[1].account_id;
         let (mut sequencer, mempool_handle) = common_setup_with_config(config).await;
 
-        let tx = common::test_utils::produce_dummy_empty_transaction();
+        let txs = (0..2)
+            .map(|nonce| {
+                common::test_utils::create_transaction_native_token_transfer(
+                    acc1,
+                    nonce,
+                    acc2,
+                    10,
+                    create_signing_key_for_account1(),
+                )
+            })
+            .collect::<Vec<_>>();
 
         // Fill the mempool
-        mempool_handle.push(tx.clone()).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, txs[0].clone()).unwrap();
 
-        // Check that pushing another transaction will block
-        let mut push_fut = pin!(mempool_handle.push(tx.clone()));
-        let poll = futures::poll!(push_fut.as_mut());
-        assert!(poll.is_pending());
+        // Pushing another transaction fails instead of waiting for room
+        assert_eq!(
+            push_tx(&sequencer, &mempool_handle, txs[1].clone()),
+            Err(MemPoolError::Full)
+        );
 
         // Empty the mempool by producing a block
         sequencer
             .produce_new_block_with_mempool_transactions()
             .unwrap();
 
-        // Resolve the pending push
-        assert!(push_fut.await.is_ok());
+        assert!(push_tx(&sequencer, &mempool_handle, txs[1].clone()).is_ok());
     }
 
     #[tokio::test]
@@ -658,13 +753,153 @@ mod tests {
         let genesis_height = sequencer.chain_height;
 
         let tx = common::test_utils::produce_dummy_empty_transaction();
-        mempool_handle.push(tx).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, tx).unwrap();
 
         let result = sequencer.produce_new_block_with_mempool_transactions();
         assert!(result.is_ok());
         assert_eq!(sequencer.chain_height, genesis_height + 1);
     }
 
+    #[tokio::test]
+    async fn test_produced_blocks_are_queued_for_settlement() {
+        let (mut sequencer, _mempool_handle) = common_setup().await;
+        let mut submitter = sequencer.take_settlement_submitter().unwrap();
+        assert!(sequencer.take_settlement_submitter().is_none());
+
+        // Block production does not wait for the submitter
+        sequencer.produce_new_block().unwrap();
+        sequencer.produce_new_block().unwrap();
+        assert_eq!(sequencer.settlement_backlog(), 2);
+
+        // Both queued blocks are submitted in one batch
+        assert!(submitter.submit_next_batch().await);
+        assert_eq!(sequencer.settlement_backlog(), 0);
+    }
+
+    #[tokio::test]
+    async fn test_read_view_follows_produced_blocks() {
+        let (mut sequencer, mempool_handle) = common_setup().await;
+        let read_view = sequencer.read_view();
+
+        let acc1 = sequencer.sequencer_config.initial_accounts[0].account_id;
+        let acc2 = sequencer.sequencer_config.initial_accounts[1].account_id;
+        let tx = common::test_utils::create_transaction_native_token_transfer(
+            acc1,
+            0,
+            acc2,
+            100,
+            create_signing_key_for_account1(),
+        );
+        push_tx(&sequencer, &mempool_handle, tx.clone()).unwrap();
+
+        sequencer
+            .produce_new_block_with_mempool_transactions()
+            .unwrap();
+
+        assert_eq!(read_view.chain_height(), sequencer.chain_height);
+        assert_eq!(
+            read_view.with_state(|state| state.get_account_by_id(acc2).balance),
+            sequencer.state.get_account_by_id(acc2).balance
+        );
+        assert_eq!(read_view.get_transaction_by_hash(tx.hash()), Some(tx));
+    }
+
+    #[tokio::test]
+    async fn test_produce_new_block_respects_max_block_size() {
+        let mut config = setup_sequencer_config();
+        let acc1 = config.initial_accounts[0].account_id;
+        let acc2 = config.initial_accounts[1].account_id;
+
+        let txs = (0..3)
+            .map(|nonce| {
+                common::test_utils::create_transaction_native_token_transfer(
+                    acc1,
+                    nonce,
+                    acc2,
+                    10,
+                    create_signing_key_for_account1(),
+                )
+            })
+            .collect::<Vec<_>>();
+
+        // Limit the block to exactly the encoded size of a block with two of the transactions
+        let two_tx_block_size = borsh::to_vec(&HashableBlockData {
+            block_id: 0,
+            transactions: txs[..2].to_vec(),
+            prev_block_hash: HashType([0; 32]),
+            timestamp: 0,
+        })
+        .unwrap()
+        .len();
+        config.max_block_size = bytesize::ByteSize::b(two_tx_block_size as u64);
+
+        let (mut sequencer, mempool_handle) = common_setup_with_config(config).await;
+        for tx in txs.iter().cloned() {
+            push_tx(&sequencer, &mempool_handle, tx).unwrap();
+        }
+
+        sequencer
+            .produce_new_block_with_mempool_transactions()
+            .unwrap();
+        let block = sequencer
+            .store
+            .get_block_at_id(sequencer.chain_height)
+            .unwrap();
+        assert_eq!(block.body.transactions, txs[..2].to_vec());
+
+        // The deferred transaction goes into the next block
+        sequencer
+            .produce_new_block_with_mempool_transactions()
+            .unwrap();
+        let block = sequencer
+            .store
+            .get_block_at_id(sequencer.chain_height)
+            .unwrap();
+        assert_eq!(block.body.transactions, txs[2..].to_vec());
+    }
+
+    #[tokio::test]
+    async fn test_nonce_gapped_transaction_waits_for_the_gap() {
+        let (mut sequencer, mempool_handle) = common_setup().await;
+
+        let acc1 = sequencer.sequencer_config.initial_accounts[0].account_id;
+        let acc2 = sequencer.sequencer_config.initial_accounts[1].account_id;
+        let txs = (0..2)
+            .map(|nonce| {
+                common::test_utils::create_transaction_native_token_transfer(
+                    acc1,
+                    nonce,
+                    acc2,
+                    10,
+                    create_signing_key_for_account1(),
+                )
+            })
+            .collect::<Vec<_>>();
+
+        // Nonce 1 is not executed while nonce 0 is missing
+        push_tx(&sequencer, &mempool_handle, txs[1].clone()).unwrap();
+        sequencer
+            .produce_new_block_with_mempool_transactions()
+            .unwrap();
+        let block = sequencer
+            .store
+            .get_block_at_id(sequencer.chain_height)
+            .unwrap();
+        assert!(block.body.transactions.is_empty());
+        assert_eq!(mempool_handle.len(), 1);
+
+        push_tx(&sequencer, &mempool_handle, txs[0].clone()).unwrap();
+        sequencer
+            .produce_new_block_with_mempool_transactions()
+            .unwrap();
+        let block = sequencer
+            .store
+            .get_block_at_id(sequencer.chain_height)
+            .unwrap();
+        assert_eq!(block.body.transactions, txs);
+        assert!(mempool_handle.is_empty());
+    }
+
     #[tokio::test]
     async fn test_replay_transactions_are_rejected_in_the_same_block() {
         let (mut sequencer, mempool_handle) = common_setup().await;
@@ -680,9 +915,12 @@ mod tests {
 
         let tx_original = tx.clone();
         let tx_replay = tx.clone();
-        // Pushing two copies of the same tx to the mempool
-        mempool_handle.push(tx_original).await.unwrap();
-        mempool_handle.push(tx_replay).await.unwrap();
+        // Pushing two copies of the same tx to the mempool, the copy is rejected
+        push_tx(&sequencer, &mempool_handle, tx_original).unwrap();
+        assert_eq!(
+            push_tx(&sequencer, &mempool_handle, tx_replay),
+            Err(MemPoolError::Duplicate)
+        );
 
         // Create block
         sequencer
@@ -711,7 +949,7 @@ mod tests {
         );
 
         // The transaction should be included the first time
-        mempool_handle.push(tx.clone()).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, tx.clone()).unwrap();
         sequencer
             .produce_new_block_with_mempool_transactions()
             .unwrap();
@@ -722,7 +960,7 @@ mod tests {
         assert_eq!(block.body.transactions, vec![tx.clone()]);
 
         // Add same transaction should fail
-        mempool_handle.push(tx.clone()).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, tx.clone()).unwrap();
         sequencer
             .produce_new_block_with_mempool_transactions()
             .unwrap();
@@ -756,7 +994,7 @@ mod tests {
                 signing_key,
             );
 
-            mempool_handle.push(tx.clone()).await.unwrap();
+            push_tx(&sequencer, &mempool_handle, tx.clone()).unwrap();
             sequencer
                 .produce_new_block_with_mempool_transactions()
                 .unwrap();
@@ -847,7 +1085,7 @@ mod tests {
                 signing_key,
             );
 
-            mempool_handle.push(tx).await.unwrap();
+            push_tx(&sequencer, &mempool_handle, tx).unwrap();
             sequencer
                 .produce_new_block_with_mempool_transactions()
                 .unwrap();
@@ -870,7 +1108,7 @@ mod tests {
             signing_key,
         );
 
-        mempool_handle.push(tx.clone()).await.unwrap();
+        push_tx(&sequencer, &mempool_handle, tx.clone()).unwrap();
 
         // Step 4: Produce new block
         sequencer
@@ -913,13 +1151,13 @@ mod tests {
 
             // Produce multiple blocks to advance chain height
             let tx = common::test_utils::produce_dummy_empty_transaction();
-            mempool_handle.push(tx).await.unwrap();
+            push_tx(&sequencer, &mempool_handle, tx).unwrap();
             sequencer
                 .produce_new_block_with_mempool_transactions()
                 .unwrap();
 
             let tx = common::test_utils::produce_dummy_empty_transaction();
-            mempool_handle.push(tx).await.unwrap();
+            push_tx(&sequencer, &mempool_handle, tx).unwrap();
             sequencer
                 .produce_new_block_with_mempool_transactions()
                 .unwrap();
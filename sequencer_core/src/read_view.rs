@@ -0,0 +1,112 @@
+//! Read-only view of the sequencer for serving queries without locking the [`SequencerCore`].
+//!
+//! The view holds its own copy of the state, brought up to date with the state diff of every
+//! stored block, and reads blocks straight from the database.
+//!
+//! [`SequencerCore`]: crate::SequencerCore
+
+use std::sync::{Arc, RwLock};
+
+use anyhow::Result;
+use common::{
+    HashType,
+    block::{AccountInitialData, Block},
+    transaction::NSSATransaction,
+};
+use nssa::{StateDiff, V02State};
+use storage::sequencer::RocksDBIO;
+use tokio::sync::watch;
+
+use crate::block_store::find_transaction;
+
+struct PublishedState {
+    state: V02State,
+    chain_height: u64,
+}
+
+/// Cheaply cloneable handle to the state of the last stored block and to the stored blocks.
+#[derive(Clone)]
+pub struct SequencerReadView {
+    published: Arc<RwLock<PublishedState>>,
+    /// Chain height, watched by block subscriptions
+    chain_height_sender: Arc<watch::Sender<u64>>,
+    dbio: Arc<RocksDBIO>,
+    genesis_id: u64,
+    initial_accounts: Arc<[AccountInitialData]>,
+}
+
+impl SequencerReadView {
+    pub(crate) fn new(
+        state: V02State,
+        chain_height: u64,
+        dbio: Arc<RocksDBIO>,
+        genesis_id: u64,
+        initial_accounts: Vec<AccountInitialData>,
+    ) -> Self {
+        Self {
+            published: Arc::new(RwLock::new(PublishedState {
+                state,
+                chain_height,
+            })),
+            chain_height_sender: Arc::new(watch::channel(chain_height).0),
+            dbio,
+            genesis_id,
+            initial_accounts: initial_accounts.into(),
+        }
+    }
+
+    /// Apply the changes of a newly stored block.
+    ///
+    /// Readers are blocked only while the diff is applied, not while the block is built.
+    pub(crate) fn publish(&self, diff: &StateDiff, chain_height: u64) {
+        let mut published = self.published.write().expect("Read view lock poisoned");
+        published.state.apply_state_diff(diff);
+        published.chain_height = chain_height;
+        drop(published);
+
+        self.chain_height_sender.send_replace(chain_height);
+    }
+
+    /// Receiver of the chain height, notified after every published block.
+    pub fn subscribe_chain_height(&self) -> watch::Receiver<u64> {
+        self.chain_height_sender.subscribe()
+    }
+
+    /// Run `f` on the state after the last stored block.
+    ///
+    /// Keep `f` short, as it delays publishing the next block.
+    pub fn with_state<T>(&self, f: impl FnOnce(&V02State) -> T) -> T {
+        let published = self.published.read().expect("Read view lock poisoned");
+        f(&published.state)
+    }
+
+    pub fn chain_height(&self) -> u64 {
+        self.published
+            .read()
+            .expect("Read view lock poisoned")
+            .chain_height
+    }
+
+    pub fn genesis_id(&self) -> u64 {
+        self.genesis_id
+    }
+
+    pub fn initial_accounts(&self) -> &[AccountInitialData] {
+        &self.initial_accounts
+    }
+
+    pub fn get_block_at_id(&self, id: u64) -> Result<Block> {
+        Ok(self.dbio.get_block(id)?)
+    }
+
+    /// Blocks `start_block_id..=end_block_id`, failing if any of them is not stored.
+    pub fn get_block_range(&self, start_block_id: u64, end_block_id: u64) -> Result<Vec<Block>> {
+        Ok(self.dbio.get_block_range(start_block_id, end_block_id)?)
+    }
+
+    /// Returns the transaction corresponding to the given hash, if it exists in the blockchain.
+    pub fn get_transaction_by_hash(&self, hash: HashType) -> Option<NSSATransaction> {
+        let block_id = self.dbio.get_block_id_by_tx_hash(hash).ok().flatten()?;
+        find_transaction(&self.dbio, block_id, hash)
+    }
+}
@@ -2,22 +2,22 @@ pub mod net_utils;
 pub mod process;
 pub mod types;
 
-use std::sync::Arc;
+use std::{marker::PhantomData, sync::Arc};
 
 use common::{
     rpc_primitives::errors::{RpcError, RpcErrorKind},
-    transaction::NSSATransaction,
+    transaction::VerifiedTransaction,
 };
 use mempool::MemPoolHandle;
 pub use net_utils::*;
 use sequencer_core::{
-    SequencerCore,
     block_settlement_client::{BlockSettlementClient, BlockSettlementClientTrait},
     indexer_client::{IndexerClient, IndexerClientTrait},
+    read_view::SequencerReadView,
 };
 use serde::Serialize;
 use serde_json::Value;
-use tokio::sync::Mutex;
+use tokio::sync::Semaphore;
 
 use self::types::err_rpc::RpcErr;
 
@@ -26,9 +26,14 @@ pub struct JsonHandler<
     BC: BlockSettlementClientTrait = BlockSettlementClient,
     IC: IndexerClientTrait = IndexerClient,
 > {
-    sequencer_state: Arc<Mutex<SequencerCore<BC, IC>>>,
-    mempool_handle: MemPoolHandle<NSSATransaction>,
+    /// Queries are served from the read view, without locking the sequencer
+    sequencer_view: SequencerReadView,
+    mempool_handle: MemPoolHandle<VerifiedTransaction>,
     max_block_size: usize,
+    /// Permits of the block streams that can still be opened
+    block_streams: Arc<Semaphore>,
+    /// Clients of the sequencer the view belongs to
+    _clients: PhantomData<fn() -> (BC, IC)>,
 }
 
 fn respond<T: Serialize>(val: T) -> Result<Value, RpcErr> {
@@ -1,13 +1,21 @@
-use std::{io, net::SocketAddr, sync::Arc};
+use std::{io, marker::PhantomData, net::SocketAddr, sync::Arc};
 
 use actix_cors::Cors;
-use actix_web::{App, Error as HttpError, HttpResponse, HttpServer, http, middleware, web};
+use actix_web::{
+    App, Error as HttpError, HttpResponse, HttpResponseBuilder, HttpServer, http, middleware, web,
+};
 use common::{
-    rpc_primitives::{RpcConfig, message::Message},
-    transaction::NSSATransaction,
+    metrics,
+    rpc_primitives::{
+        BLOCK_RANGE_BINARY_PATH, BLOCK_STREAM_PATH, COMPACT_BLOCK_RANGE_PATH, MAX_BLOCKS_PER_READ,
+        RpcConfig,
+        message::Message,
+        requests::{GetBlockRangeDataRequest, GetCompactBlockRangeRequest, SubscribeBlocksRequest},
+    },
+    transaction::VerifiedTransaction,
 };
-use futures::{Future, FutureExt};
-use log::info;
+use futures::{Future, FutureExt, StreamExt as _};
+use log::{info, warn};
 use mempool::MemPoolHandle;
 #[cfg(not(feature = "standalone"))]
 use sequencer_core::SequencerCore;
@@ -20,9 +28,12 @@ use super::JsonHandler;
 #[cfg(feature = "standalone")]
 type JsonHandler = super::JsonHandlerWithMockClients;
 
-use tokio::sync::Mutex;
+use tokio::sync::{Mutex, Semaphore};
 
-use crate::process::Process;
+use crate::{
+    process::Process,
+    types::err_rpc::{BlockRangeError, RpcErr},
+};
 
 pub const SHUTDOWN_TIMEOUT_SECS: u64 = 10;
 
@@ -39,6 +50,105 @@ pub(crate) fn rpc_handler<P: Process>(
     response.boxed()
 }
 
+/// Serve a block range as the borsh encoding of `Vec<HashableBlockData>`.
+///
+/// Lets block pollers skip the base64 and JSON layers of `get_block_range`.
+pub(crate) async fn block_range_handler<P: Process>(
+    request: web::Json<GetBlockRangeDataRequest>,
+    handler: web::Data<P>,
+) -> HttpResponse {
+    block_range_response(
+        HttpResponse::Ok(),
+        handler.process_block_range(&request).await,
+    )
+}
+
+/// Serve unfiltered compact blocks of a range given as query parameters.
+///
+/// Stored blocks never change, so clients and proxies may cache the response for good.
+pub(crate) async fn compact_block_range_get_handler<P: Process>(
+    range: web::Query<GetBlockRangeDataRequest>,
+    handler: web::Data<P>,
+) -> HttpResponse {
+    let request = GetCompactBlockRangeRequest {
+        start_block_id: range.start_block_id,
+        end_block_id: range.end_block_id,
+        view_tags: None,
+    };
+    let mut response = HttpResponse::Ok();
+    response.insert_header((
+        http::header::CACHE_CONTROL,
+        "public, max-age=31536000, immutable",
+    ));
+    block_range_response(
+        response,
+        handler.process_compact_block_range(&request).await,
+    )
+}
+
+/// Serve compact blocks of a range, optionally keeping only the outputs of given view tags.
+pub(crate) async fn compact_block_range_post_handler<P: Process>(
+    request: web::Json<GetCompactBlockRangeRequest>,
+    handler: web::Data<P>,
+) -> HttpResponse {
+    block_range_response(
+        HttpResponse::Ok(),
+        handler.process_compact_block_range(&request).await,
+    )
+}
+
+/// Respond with the encoded blocks, or with the status of the failure.
+///
+/// Only ranges reaching outside of the stored blocks are not found, failures to read stored
+/// blocks are internal errors.
+fn block_range_response(
+    mut ok: HttpResponseBuilder,
+    result: Result<Vec<u8>, BlockRangeError>,
+) -> HttpResponse {
+    match result {
+        Ok(bytes) => ok.content_type("application/octet-stream").body(bytes),
+        Err(BlockRangeError::TooLong) => HttpResponse::BadRequest().body(format!(
+            "Block ranges are limited to {MAX_BLOCKS_PER_READ} blocks"
+        )),
+        Err(BlockRangeError::NotFound) => {
+            HttpResponse::NotFound().body("Block range is not stored yet")
+        }
+        Err(BlockRangeError::Internal(RpcErr(err))) => {
+            warn!(target:NETWORK, "Block range read failed: {err}");
+            HttpResponse::InternalServerError().body(err.message)
+        }
+    }
+}
+
+/// Stream blocks to a subscriber as they are produced, framed as described at
+/// [`BLOCK_STREAM_PATH`].
+pub(crate) async fn block_stream_handler<P: Process>(
+    request: web::Json<SubscribeBlocksRequest>,
+    handler: web::Data<P>,
+) -> HttpResponse {
+    let Some(blocks) = handler.subscribe_blocks(request.from_block_id) else {
+        return HttpResponse::ServiceUnavailable().body("Too many block streams are open");
+    };
+    let blocks = blocks.map(|frames| match frames {
+        Ok(frames) => Ok(web::Bytes::from(frames)),
+        Err(RpcErr(err)) => {
+            warn!(target:NETWORK, "Block stream failed: {}", err.message);
+            Err(actix_web::error::ErrorInternalServerError(err.message))
+        }
+    });
+
+    HttpResponse::Ok()
+        .content_type("application/octet-stream")
+        .streaming(blocks)
+}
+
+/// Export metrics for Prometheus to scrape.
+pub(crate) async fn metrics_handler() -> HttpResponse {
+    HttpResponse::Ok()
+        .content_type(metrics::CONTENT_TYPE)
+        .body(metrics::encode())
+}
+
 fn get_cors(cors_allowed_origins: &[String]) -> Cors {
     let mut cors = Cors::permissive();
     if cors_allowed_origins != ["*".to_string()] {
@@ -55,7 +165,7 @@ fn get_cors(cors_allowed_origins: &[String]) -> Cors {
 pub async fn new_http_server(
     config: RpcConfig,
     seuquencer_core: Arc<Mutex<SequencerCore>>,
-    mempool_handle: MemPoolHandle<NSSATransaction>,
+    mempool_handle: MemPoolHandle<VerifiedTransaction>,
 ) -> io::Result<(actix_web::dev::Server, SocketAddr)> {
     let RpcConfig {
         addr,
@@ -63,16 +173,19 @@ pub async fn new_http_server(
         limits_config,
     } = config;
     info!(target:NETWORK, "Starting HTTP server at {addr}");
-    let max_block_size = seuquencer_core
-        .lock()
-        .await
-        .sequencer_config()
-        .max_block_size
-        .as_u64() as usize;
+    let (max_block_size, sequencer_view) = {
+        let sequencer_core = seuquencer_core.lock().await;
+        (
+            sequencer_core.sequencer_config().max_block_size.as_u64() as usize,
+            sequencer_core.read_view(),
+        )
+    };
     let handler = web::Data::new(JsonHandler {
-        sequencer_state: seuquencer_core.clone(),
+        sequencer_view,
         mempool_handle,
         max_block_size,
+        block_streams: Arc::new(Semaphore::new(limits_config.max_block_streams)),
+        _clients: PhantomData,
     });
 
     // HTTP server
@@ -86,6 +199,25 @@ pub async fn new_http_server(
             )
             .wrap(middleware::Logger::default())
             .service(web::resource("/").route(web::post().to(rpc_handler::<JsonHandler>)))
+            .service(
+                web::resource(format!("/{BLOCK_RANGE_BINARY_PATH}"))
+                    .wrap(middleware::Compress::default())
+                    .route(web::post().to(block_range_handler::<JsonHandler>)),
+            )
+            .service(
+                web::resource(format!("/{COMPACT_BLOCK_RANGE_PATH}"))
+                    .wrap(middleware::Compress::default())
+                    .route(web::get().to(compact_block_range_get_handler::<JsonHandler>))
+                    .route(web::post().to(compact_block_range_post_handler::<JsonHandler>)),
+            )
+            .service(
+                web::resource(format!("/{BLOCK_STREAM_PATH}"))
+                    .route(web::post().to(block_stream_handler::<JsonHandler>)),
+            )
+            .service(
+                web::resource(format!("/{}", metrics::METRICS_PATH))
+                    .route(web::get().to(metrics_handler)),
+            )
     })
     .bind(addr)?
     .shutdown_timeout(SHUTDOWN_TIMEOUT_SECS)
@@ -1,36 +1,44 @@
-use std::collections::HashMap;
+use std::{collections::HashMap, sync::Arc};
 
-use actix_web::Error as HttpError;
+use actix_web::{Error as HttpError, web};
+use anyhow::Context as _;
 use base64::{Engine, engine::general_purpose};
 use common::{
-    block::{AccountInitialData, HashableBlockData},
+    block::{AccountInitialData, Block, CompactBlock, HashableBlockData},
+    metrics::{MEMPOOL_DEPTH, RPC_REQUEST_SECONDS},
     rpc_primitives::{
+        MAX_ACCOUNTS_PER_REQUEST, MAX_BLOCKS_PER_READ,
         errors::RpcError,
         message::{Message, Request},
         parser::RpcRequest,
         requests::{
             GetAccountBalanceRequest, GetAccountBalanceResponse, GetAccountRequest,
             GetAccountResponse, GetAccountsNoncesRequest, GetAccountsNoncesResponse,
-            GetBlockDataRequest, GetBlockDataResponse, GetBlockRangeDataRequest,
-            GetBlockRangeDataResponse, GetGenesisIdRequest, GetGenesisIdResponse,
-            GetInitialTestnetAccountsRequest, GetLastBlockRequest, GetLastBlockResponse,
-            GetProgramIdsRequest, GetProgramIdsResponse, GetProofForCommitmentRequest,
-            GetProofForCommitmentResponse, GetTransactionByHashRequest,
-            GetTransactionByHashResponse, HelloRequest, HelloResponse, SendTxRequest,
-            SendTxResponse,
+            GetAccountsRequest, GetAccountsResponse, GetBlockDataRequest, GetBlockDataResponse,
+            GetBlockRangeDataRequest, GetBlockRangeDataResponse, GetCompactBlockRangeRequest,
+            GetGenesisIdRequest, GetGenesisIdResponse, GetInitialTestnetAccountsRequest,
+            GetLastBlockRequest, GetLastBlockResponse, GetProgramIdsRequest, GetProgramIdsResponse,
+            GetProofForCommitmentRequest, GetProofForCommitmentResponse,
+            GetTransactionByHashRequest, GetTransactionByHashResponse, HelloRequest, HelloResponse,
+            SendTxRequest, SendTxResponse,
         },
     },
     transaction::{NSSATransaction, TransactionMalformationError},
 };
-use itertools::Itertools as _;
+use futures::stream::{self, BoxStream, StreamExt as _};
 use log::warn;
 use nssa::{self, program::Program};
 use sequencer_core::{
     block_settlement_client::BlockSettlementClientTrait, indexer_client::IndexerClientTrait,
+    read_view::SequencerReadView,
 };
 use serde_json::Value;
+use tokio::sync::{OwnedSemaphorePermit, watch};
 
-use super::{JsonHandler, respond, types::err_rpc::RpcErr};
+use super::{
+    JsonHandler, respond,
+    types::err_rpc::{BlockRangeError, RpcErr},
+};
 
 pub const HELLO: &str = "hello";
 pub const SEND_TX: &str = "send_tx";
@@ -42,6 +50,7 @@ pub const GET_ACCOUNT_BALANCE: &str = "get_account_balance";
 pub const GET_TRANSACTION_BY_HASH: &str = "get_transaction_by_hash";
 pub const GET_ACCOUNTS_NONCES: &str = "get_accounts_nonces";
 pub const GET_ACCOUNT: &str = "get_account";
+pub const GET_ACCOUNTS: &str = "get_accounts";
 pub const GET_PROOF_FOR_COMMITMENT: &str = "get_proof_for_commitment";
 pub const GET_PROGRAM_IDS: &str = "get_program_ids";
 
@@ -51,8 +60,54 @@ pub const TRANSACTION_SUBMITTED: &str = "Transaction submitted";
 
 pub const GET_INITIAL_TESTNET_ACCOUNTS: &str = "get_initial_testnet_accounts";
 
+/// Methods timed under their own name, others are timed as `unknown` to bound the label set
+const TIMED_METHODS: [&str; 14] = [
+    HELLO,
+    SEND_TX,
+    GET_BLOCK,
+    GET_BLOCK_RANGE,
+    GET_GENESIS,
+    GET_LAST_BLOCK,
+    GET_INITIAL_TESTNET_ACCOUNTS,
+    GET_ACCOUNT_BALANCE,
+    GET_ACCOUNTS_NONCES,
+    GET_ACCOUNT,
+    GET_ACCOUNTS,
+    GET_TRANSACTION_BY_HASH,
+    GET_PROOF_FOR_COMMITMENT,
+    GET_PROGRAM_IDS,
+];
+
+fn method_label(method: &str) -> &'static str {
+    TIMED_METHODS
+        .into_iter()
+        .find(|known| *known == method)
+        .unwrap_or("unknown")
+}
+
 pub trait Process: Send + Sync + 'static {
     fn process(&self, message: Message) -> impl Future<Output = Result<Message, HttpError>> + Send;
+
+    /// Borsh encoding of `Vec<HashableBlockData>` for the requested range.
+    fn process_block_range(
+        &self,
+        request: &GetBlockRangeDataRequest,
+    ) -> impl Future<Output = Result<Vec<u8>, BlockRangeError>> + Send;
+
+    /// Borsh encoding of `Vec<CompactBlock>` for the requested range.
+    fn process_compact_block_range(
+        &self,
+        request: &GetCompactBlockRangeRequest,
+    ) -> impl Future<Output = Result<Vec<u8>, BlockRangeError>> + Send;
+
+    /// Length prefixed borsh encodings of `HashableBlockData`, from `from_block_id` on.
+    ///
+    /// The stream waits for new blocks at the chain tip and never ends on its own. `None` if the
+    /// max number of streams are already open.
+    fn subscribe_blocks(
+        &self,
+        from_block_id: u64,
+    ) -> Option<BoxStream<'static, Result<Vec<u8>, RpcErr>>>;
 }
 
 impl<
@@ -63,6 +118,9 @@ impl<
     async fn process(&self, message: Message) -> Result<Message, HttpError> {
         let id = message.id();
         if let Message::Request(request) = message {
+            let _timer = RPC_REQUEST_SECONDS
+                .with_label_values(&[method_label(&request.method)])
+                .start_timer();
             let message_inner = self
                 .process_request_internal(request)
                 .await
@@ -74,6 +132,161 @@ impl<
             )))
         }
     }
+
+    /// Blocks are encoded from the stored blocks, without cloning their transactions.
+    async fn process_block_range(
+        &self,
+        request: &GetBlockRangeDataRequest,
+    ) -> Result<Vec<u8>, BlockRangeError> {
+        let _timer = RPC_REQUEST_SECONDS
+            .with_label_values(&["block_range"])
+            .start_timer();
+        let (start_block_id, end_block_id) = (request.start_block_id, request.end_block_id);
+        check_block_range(&self.sequencer_view, start_block_id, end_block_id)?;
+
+        let view = self.sequencer_view.clone();
+        Ok(web::block(move || {
+            encode_hashable_blocks(&view.get_block_range(start_block_id, end_block_id)?)
+        })
+        .await??)
+    }
+
+    /// Compact blocks are derived from the stored blocks on every request.
+    async fn process_compact_block_range(
+        &self,
+        request: &GetCompactBlockRangeRequest,
+    ) -> Result<Vec<u8>, BlockRangeError> {
+        let _timer = RPC_REQUEST_SECONDS
+            .with_label_values(&["compact_block_range"])
+            .start_timer();
+        let (start_block_id, end_block_id) = (request.start_block_id, request.end_block_id);
+        check_block_range(&self.sequencer_view, start_block_id, end_block_id)?;
+
+        let view = self.sequencer_view.clone();
+        let view_tags = request.view_tags.clone();
+        Ok(web::block(move || {
+            let blocks = view
+                .get_block_range(start_block_id, end_block_id)?
+                .iter()
+                .map(|block| {
+                    let mut block = CompactBlock::from(block);
+                    if let Some(view_tags) = &view_tags {
+                        block.retain_view_tags(view_tags);
+                    }
+                    block
+                })
+                .collect::<Vec<_>>();
+            Ok::<_, RpcErr>(borsh::to_vec(&blocks).context("Failed to encode compact blocks")?)
+        })
+        .await??)
+    }
+
+    /// Blocks are read from the store whenever the read view publishes a new chain height, so a
+    /// slow subscriber only delays itself.
+    fn subscribe_blocks(
+        &self,
+        from_block_id: u64,
+    ) -> Option<BoxStream<'static, Result<Vec<u8>, RpcErr>>> {
+        let permit = Arc::clone(&self.block_streams).try_acquire_owned().ok()?;
+        let view = self.sequencer_view.clone();
+        let stream = BlockStream {
+            chain_height: view.subscribe_chain_height(),
+            next_block_id: from_block_id.max(view.genesis_id()),
+            view,
+            _permit: permit,
+        };
+
+        Some(stream::try_unfold(stream, next_block_frames).boxed())
+    }
+}
+
+/// Reject ranges longer than [`MAX_BLOCKS_PER_READ`] and ranges of blocks not stored yet.
+///
+/// An empty range, with `start_block_id > end_block_id`, is accepted and served as no blocks.
+fn check_block_range(
+    view: &SequencerReadView,
+    start_block_id: u64,
+    end_block_id: u64,
+) -> Result<(), BlockRangeError> {
+    if start_block_id > end_block_id {
+        return Ok(());
+    }
+    if end_block_id - start_block_id >= MAX_BLOCKS_PER_READ {
+        return Err(BlockRangeError::TooLong);
+    }
+    if start_block_id < view.genesis_id() || end_block_id > view.chain_height() {
+        return Err(BlockRangeError::NotFound);
+    }
+    Ok(())
+}
+
+/// Reject account queries longer than [`MAX_ACCOUNTS_PER_REQUEST`], the size clients chunk at.
+fn check_accounts_count(account_ids: &[nssa::AccountId]) -> Result<(), RpcErr> {
+    if account_ids.len() > MAX_ACCOUNTS_PER_REQUEST {
+        return Err(RpcErr(RpcError::invalid_params(format!(
+            "Account queries are limited to {MAX_ACCOUNTS_PER_REQUEST} accounts, got {}",
+            account_ids.len()
+        ))));
+    }
+    Ok(())
+}
+
+/// Borsh encoding of the `Vec<HashableBlockData>` of `blocks`.
+fn encode_hashable_blocks(blocks: &[Block]) -> Result<Vec<u8>, RpcErr> {
+    let count =
+        u32::try_from(blocks.len()).map_err(|_| anyhow::anyhow!("Block range is too long"))?;
+
+    let mut bytes = count.to_le_bytes().to_vec();
+    for block in blocks {
+        bytes.extend_from_slice(&block.hashable_data_bytes());
+    }
+    Ok(bytes)
+}
+
+/// Position of a block stream
+struct BlockStream {
+    view: SequencerReadView,
+    chain_height: watch::Receiver<u64>,
+    next_block_id: u64,
+    /// Released when the stream is dropped
+    _permit: OwnedSemaphorePermit,
+}
+
+/// Frames of the blocks from the next block to send up to the chain height, waiting for the next
+/// block if there are none.
+///
+/// Blocks are read and encoded on the blocking thread pool.
+async fn next_block_frames(
+    mut stream: BlockStream,
+) -> Result<Option<(Vec<u8>, BlockStream)>, RpcErr> {
+    let height = loop {
+        let height = *stream.chain_height.borrow_and_update();
+        if stream.next_block_id <= height {
+            break height;
+        }
+        if stream.chain_height.changed().await.is_err() {
+            return Ok(None);
+        }
+    };
+
+    let start_block_id = stream.next_block_id;
+    let end_block_id = height.min(start_block_id + MAX_BLOCKS_PER_READ - 1);
+    let view = stream.view.clone();
+    let frames = web::block(move || {
+        let mut frames = Vec::new();
+        for block in &view.get_block_range(start_block_id, end_block_id)? {
+            let block = block.hashable_data_bytes();
+            let len =
+                u32::try_from(block.len()).map_err(|_| anyhow::anyhow!("Block is too large"))?;
+            frames.extend_from_slice(&len.to_le_bytes());
+            frames.extend_from_slice(&block);
+        }
+        Ok::<_, RpcErr>(frames)
+    })
+    .await??;
+
+    stream.next_block_id = end_block_id + 1;
+    Ok(Some((frames, stream)))
 }
 
 impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC> {
@@ -111,16 +324,19 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
             .into());
         }
 
-        let authenticated_tx = tx
-            .transaction_stateless_check()
+        // Signature checks run on the blocking thread pool, so concurrent submissions are verified
+        // in parallel without stalling the RPC workers. The mempool only takes verified
+        // transactions, so the block builder does not verify signatures again.
+        let authenticated_tx = web::block(move || tx.transaction_stateless_check())
+            .await?
             .inspect_err(|err| warn!("Error at pre_check {err:#?}"))?;
 
-        // TODO: Do we need a timeout here? It will be usable if we have too many transactions to
-        // process
-        self.mempool_handle
-            .push(authenticated_tx)
-            .await
-            .expect("Mempool is closed, this is a bug");
+        // Admission does not wait for room, a full mempool is reported to the client
+        self.mempool_handle.push(authenticated_tx, |account_id| {
+            self.sequencer_view
+                .with_state(|state| state.get_account_nonce(*account_id))
+        })?;
+        MEMPOOL_DEPTH.set(self.mempool_handle.len() as i64);
 
         let response = SendTxResponse {
             status: TRANSACTION_SUBMITTED.to_string(),
@@ -133,13 +349,9 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_block_data(&self, request: Request) -> Result<Value, RpcErr> {
         let get_block_req = GetBlockDataRequest::parse(Some(request.params))?;
 
-        let block = {
-            let state = self.sequencer_state.lock().await;
-
-            state
-                .block_store()
-                .get_block_at_id(get_block_req.block_id)?
-        };
+        let block = self
+            .sequencer_view
+            .get_block_at_id(get_block_req.block_id)?;
 
         let response = GetBlockDataResponse {
             block: borsh::to_vec(&HashableBlockData::from(block)).unwrap(),
@@ -151,16 +363,14 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_block_range_data(&self, request: Request) -> Result<Value, RpcErr> {
         let get_block_req = GetBlockRangeDataRequest::parse(Some(request.params))?;
 
-        let blocks = {
-            let state = self.sequencer_state.lock().await;
-            (get_block_req.start_block_id..=get_block_req.end_block_id)
-                .map(|block_id| state.block_store().get_block_at_id(block_id))
-                .map_ok(|block| {
-                    borsh::to_vec(&HashableBlockData::from(block))
-                        .expect("derived BorshSerialize should never fail")
-                })
-                .collect::<Result<Vec<_>, _>>()?
-        };
+        let view = self.sequencer_view.clone();
+        let blocks = web::block(move || {
+            view.get_block_range(get_block_req.start_block_id, get_block_req.end_block_id)
+        })
+        .await??
+        .iter()
+        .map(Block::hashable_data_bytes)
+        .collect();
 
         let response = GetBlockRangeDataResponse { blocks };
 
@@ -170,11 +380,7 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_genesis(&self, request: Request) -> Result<Value, RpcErr> {
         let _get_genesis_req = GetGenesisIdRequest::parse(Some(request.params))?;
 
-        let genesis_id = {
-            let state = self.sequencer_state.lock().await;
-
-            state.block_store().genesis_id()
-        };
+        let genesis_id = self.sequencer_view.genesis_id();
 
         let response = GetGenesisIdResponse { genesis_id };
 
@@ -184,11 +390,7 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_last_block(&self, request: Request) -> Result<Value, RpcErr> {
         let _get_last_block_req = GetLastBlockRequest::parse(Some(request.params))?;
 
-        let last_block = {
-            let state = self.sequencer_state.lock().await;
-
-            state.chain_height()
-        };
+        let last_block = self.sequencer_view.chain_height();
 
         let response = GetLastBlockResponse { last_block };
 
@@ -201,11 +403,8 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
         let _get_initial_testnet_accounts_request =
             GetInitialTestnetAccountsRequest::parse(Some(request.params))?;
 
-        let initial_accounts: Vec<AccountInitialData> = {
-            let state = self.sequencer_state.lock().await;
-
-            state.sequencer_config().initial_accounts.clone()
-        };
+        let initial_accounts: Vec<AccountInitialData> =
+            self.sequencer_view.initial_accounts().to_vec();
 
         respond(initial_accounts)
     }
@@ -216,11 +415,9 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
         let get_account_req = GetAccountBalanceRequest::parse(Some(request.params))?;
         let account_id = get_account_req.account_id;
 
-        let balance = {
-            let state = self.sequencer_state.lock().await;
-            let account = state.state().get_account_by_id(account_id);
-            account.balance
-        };
+        let balance = self
+            .sequencer_view
+            .with_state(|state| state.get_account_by_id(account_id).balance);
 
         let response = GetAccountBalanceResponse { balance };
 
@@ -232,15 +429,14 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_accounts_nonces(&self, request: Request) -> Result<Value, RpcErr> {
         let get_account_nonces_req = GetAccountsNoncesRequest::parse(Some(request.params))?;
         let account_ids = get_account_nonces_req.account_ids;
+        check_accounts_count(&account_ids)?;
 
-        let nonces = {
-            let state = self.sequencer_state.lock().await;
-
+        let nonces = self.sequencer_view.with_state(|state| {
             account_ids
                 .into_iter()
-                .map(|account_id| state.state().get_account_by_id(account_id).nonce)
+                .map(|account_id| state.get_account_by_id(account_id).nonce)
                 .collect()
-        };
+        });
 
         let response = GetAccountsNoncesResponse { nonces };
 
@@ -254,30 +450,44 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
 
         let account_id = get_account_nonces_req.account_id;
 
-        let account = {
-            let state = self.sequencer_state.lock().await;
-
-            state.state().get_account_by_id(account_id)
-        };
+        let account = self
+            .sequencer_view
+            .with_state(|state| state.get_account_by_id(account_id));
 
         let response = GetAccountResponse { account };
 
         respond(response)
     }
 
+    /// Returns account structs for given account_ids, in request order.
+    /// Each account_id must be a valid hex string of the correct length.
+    async fn process_get_accounts(&self, request: Request) -> Result<Value, RpcErr> {
+        let get_accounts_req = GetAccountsRequest::parse(Some(request.params))?;
+        let account_ids = get_accounts_req.account_ids;
+        check_accounts_count(&account_ids)?;
+
+        let accounts = self.sequencer_view.with_state(|state| {
+            account_ids
+                .into_iter()
+                .map(|account_id| state.get_account_by_id(account_id))
+                .collect()
+        });
+
+        let response = GetAccountsResponse { accounts };
+
+        respond(response)
+    }
+
     /// Returns the transaction corresponding to the given hash, if it exists in the blockchain.
     /// The hash must be a valid hex string of the correct length.
     async fn process_get_transaction_by_hash(&self, request: Request) -> Result<Value, RpcErr> {
         let get_transaction_req = GetTransactionByHashRequest::parse(Some(request.params))?;
         let hash = get_transaction_req.hash;
 
-        let transaction = {
-            let state = self.sequencer_state.lock().await;
-            state
-                .block_store()
-                .get_transaction_by_hash(hash)
-                .map(|tx| borsh::to_vec(&tx).unwrap())
-        };
+        let transaction = self
+            .sequencer_view
+            .get_transaction_by_hash(hash)
+            .map(|tx| borsh::to_vec(&tx).unwrap());
         let base64_encoded = transaction.map(|tx| general_purpose::STANDARD.encode(tx));
         let response = GetTransactionByHashResponse {
             transaction: base64_encoded,
@@ -289,12 +499,9 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
     async fn process_get_proof_by_commitment(&self, request: Request) -> Result<Value, RpcErr> {
         let get_proof_req = GetProofForCommitmentRequest::parse(Some(request.params))?;
 
-        let membership_proof = {
-            let state = self.sequencer_state.lock().await;
-            state
-                .state()
-                .get_proof_for_commitment(&get_proof_req.commitment)
-        };
+        let membership_proof = self
+            .sequencer_view
+            .with_state(|state| state.get_proof_for_commitment(&get_proof_req.commitment));
         let response = GetProofForCommitmentResponse { membership_proof };
         respond(response)
     }
@@ -330,6 +537,7 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
             GET_ACCOUNT_BALANCE => self.process_get_account_balance(request).await,
             GET_ACCOUNTS_NONCES => self.process_get_accounts_nonces(request).await,
             GET_ACCOUNT => self.process_get_account(request).await,
+            GET_ACCOUNTS => self.process_get_accounts(request).await,
             GET_TRANSACTION_BY_HASH => self.process_get_transaction_by_hash(request).await,
             GET_PROOF_FOR_COMMITMENT => self.process_get_proof_by_commitment(request).await,
             GET_PROGRAM_IDS => self.process_get_program_ids(request).await,
@@ -340,13 +548,15 @@ impl<BC: BlockSettlementClientTrait, IC: IndexerClientTrait> JsonHandler<BC, IC>
 
 #[cfg(test)]
 mod tests {
-    use std::{str::FromStr as _, sync::Arc, time::Duration};
+    use std::{marker::PhantomData, str::FromStr as _, sync::Arc, time::Duration};
 
     use base58::ToBase58;
     use base64::{Engine, engine::general_purpose};
     use bedrock_client::BackoffConfig;
     use common::{
-        block::AccountInitialData, config::BasicAuth, test_utils::sequencer_sign_key_for_testing,
+        block::{AccountInitialData, HashableBlockData},
+        config::BasicAuth,
+        test_utils::sequencer_sign_key_for_testing,
         transaction::NSSATransaction,
     };
     use nssa::AccountId;
@@ -356,9 +566,9 @@ mod tests {
     };
     use serde_json::Value;
     use tempfile::tempdir;
-    use tokio::sync::Mutex;
+    use tokio::sync::Semaphore;
 
-    use crate::rpc_handler;
+    use crate::{block_range_handler, rpc_handler};
 
     type JsonHandlerWithMockClients =
         crate::JsonHandler<MockBlockSettlementClient, MockIndexerClient>;
@@ -396,10 +606,14 @@ mod tests {
             max_num_tx_in_block: 10,
             max_block_size: bytesize::ByteSize::mib(1),
             mempool_max_size: 1000,
+            mempool_max_nonce_gap: 64,
+            mempool_max_txs_per_sender: 64,
+            mempool_gapped_tx_ttl: Duration::from_secs(600),
             block_create_timeout: Duration::from_secs(1),
             port: 8080,
             initial_accounts,
             initial_commitments: vec![],
+            root_history_window: nssa::DEFAULT_ROOT_HISTORY_WINDOW,
             signing_key: *sequencer_sign_key_for_testing().value(),
             retry_pending_blocks_timeout: Duration::from_secs(60 * 4),
             bedrock_config: BedrockConfig {
@@ -413,6 +627,8 @@ mod tests {
                     username: "user".to_string(),
                     password: None,
                 }),
+                settlement_queue_size: 256,
+                settlement_batch_size: 16,
             },
             indexer_rpc_url: "ws://localhost:8779".parse().unwrap(),
         }
@@ -447,22 +663,22 @@ mod tests {
         );
 
         mempool_handle
-            .push(tx.clone())
-            .await
-            .expect("Mempool is closed, this is a bug");
+            .push(tx.clone().transaction_stateless_check().unwrap(), |_| 0)
+            .expect("Mempool should have room for the test transaction");
 
         sequencer_core
             .produce_new_block_with_mempool_transactions()
             .unwrap();
 
         let max_block_size = sequencer_core.sequencer_config().max_block_size.as_u64() as usize;
-        let sequencer_core = Arc::new(Mutex::new(sequencer_core));
 
         (
             JsonHandlerWithMockClients {
-                sequencer_state: sequencer_core,
+                sequencer_view: sequencer_core.read_view(),
                 mempool_handle,
                 max_block_size,
+                block_streams: Arc::new(Semaphore::new(1)),
+                _clients: PhantomData,
             },
             initial_accounts,
             tx,
@@ -674,6 +890,51 @@ mod tests {
         assert_eq!(response, expected_response);
     }
 
+    #[actix_web::test]
+    async fn test_get_accounts_for_existent_and_non_existent_accounts() {
+        let (json_handler, initial_accounts, _) = components_for_tests().await;
+
+        let acc1_id = initial_accounts[0].account_id;
+        let acc2_id = initial_accounts[1].account_id;
+
+        let request = serde_json::json!({
+            "jsonrpc": "2.0",
+            "method": "get_accounts",
+            "params": { "account_ids": [acc1_id, "11".repeat(16), acc2_id] },
+            "id": 1
+        });
+
+        let response = call_rpc_handler_with_json(json_handler, request).await;
+
+        let accounts = response["result"]["accounts"].as_array().unwrap();
+        assert_eq!(accounts.len(), 3);
+        assert_eq!(accounts[0]["balance"], 10000 - 10);
+        assert_eq!(accounts[0]["nonce"], 1);
+        assert_eq!(accounts[1]["balance"], 0);
+        assert_eq!(accounts[1]["nonce"], 0);
+        assert_eq!(accounts[2]["balance"], 20000);
+        assert_eq!(accounts[2]["nonce"], 0);
+    }
+
+    #[actix_web::test]
+    async fn test_get_accounts_rejects_too_many_accounts() {
+        use common::rpc_primitives::MAX_ACCOUNTS_PER_REQUEST;
+
+        for method in ["get_accounts", "get_accounts_nonces"] {
+            let (json_handler, _, _) = components_for_tests().await;
+            let request = serde_json::json!({
+                "jsonrpc": "2.0",
+                "method": method,
+                "params": { "account_ids": vec!["11".repeat(16); MAX_ACCOUNTS_PER_REQUEST + 1] },
+                "id": 1
+            });
+
+            let response = call_rpc_handler_with_json(json_handler, request).await;
+
+            assert_eq!(response["error"]["code"], -32602);
+        }
+    }
+
     #[actix_web::test]
     async fn test_get_transaction_by_hash_for_non_existent_hash() {
         let (json_handler, _, _) = components_for_tests().await;
@@ -782,4 +1043,196 @@ mod tests {
 
         assert_eq!(response, expected_response);
     }
+
+    #[actix_web::test]
+    async fn test_binary_block_range_matches_json_block_range() {
+        use actix_web::{App, test, web};
+
+        let (json_handler, _, tx) = components_for_tests().await;
+        let start_block_id = json_handler.sequencer_view.genesis_id();
+        let end_block_id = json_handler.sequencer_view.chain_height();
+        let range_params = serde_json::json!({
+            "start_block_id": start_block_id,
+            "end_block_id": end_block_id,
+        });
+
+        let app = test::init_service(
+            App::new()
+                .app_data(web::Data::new(json_handler))
+                .route(
+                    "/",
+                    web::post().to(rpc_handler::<JsonHandlerWithMockClients>),
+                )
+                .route(
+                    "/block_range",
+                    web::post().to(block_range_handler::<JsonHandlerWithMockClients>),
+                ),
+        )
+        .await;
+
+        let req = test::TestRequest::post()
+            .uri("/")
+            .set_json(serde_json::json!({
+                "jsonrpc": "2.0",
+                "method": "get_block_range",
+                "params": range_params,
+                "id": 1
+            }))
+            .to_request();
+        let response: Value = test::read_body_json(test::call_service(&app, req).await).await;
+        let json_blocks = response["result"]["blocks"]
+            .as_array()
+            .unwrap()
+            .iter()
+            .map(|block| {
+                let bytes = general_purpose::STANDARD
+                    .decode(block.as_str().unwrap())
+                    .unwrap();
+                borsh::from_slice::<HashableBlockData>(&bytes).unwrap()
+            })
+            .collect::<Vec<_>>();
+
+        let req = test::TestRequest::post()
+            .uri("/block_range")
+            .set_json(range_params)
+            .to_request();
+        let body = test::read_body(test::call_service(&app, req).await).await;
+        let binary_blocks = borsh::from_slice::<Vec<HashableBlockData>>(&body).unwrap();
+
+        assert_eq!(binary_blocks, json_blocks);
+        assert_eq!(
+            binary_blocks.len() as u64,
+            end_block_id - start_block_id + 1
+        );
+        assert_eq!(binary_blocks.last().unwrap().transactions, vec![tx]);
+    }
+
+    #[actix_web::test]
+    async fn test_compact_block_range_matches_stored_blocks() {
+        use common::{block::CompactBlock, rpc_primitives::requests::GetCompactBlockRangeRequest};
+
+        use crate::process::Process as _;
+
+        let (json_handler, _, _) = components_for_tests().await;
+        let start_block_id = json_handler.sequencer_view.genesis_id();
+        let end_block_id = json_handler.sequencer_view.chain_height();
+
+        let expected_blocks = json_handler
+            .sequencer_view
+            .get_block_range(start_block_id, end_block_id)
+            .unwrap()
+            .iter()
+            .map(CompactBlock::from)
+            .collect::<Vec<_>>();
+
+        let body = json_handler
+            .process_compact_block_range(&GetCompactBlockRangeRequest {
+                start_block_id,
+                end_block_id,
+                view_tags: None,
+            })
+            .await
+            .unwrap();
+        let compact_blocks = borsh::from_slice::<Vec<CompactBlock>>(&body).unwrap();
+        assert_eq!(compact_blocks, expected_blocks);
+
+        let body = json_handler
+            .process_compact_block_range(&GetCompactBlockRangeRequest {
+                start_block_id,
+                end_block_id,
+                view_tags: Some(vec![]),
+            })
+            .await
+            .unwrap();
+        let filtered_blocks = borsh::from_slice::<Vec<CompactBlock>>(&body).unwrap();
+        assert_eq!(filtered_blocks.len(), expected_blocks.len());
+        assert!(filtered_blocks.iter().all(|block| block.outputs.is_empty()));
+    }
+
+    #[actix_web::test]
+    async fn test_block_range_must_be_short_and_stored() {
+        use common::rpc_primitives::{MAX_BLOCKS_PER_READ, requests::GetBlockRangeDataRequest};
+
+        use crate::{process::Process as _, types::err_rpc::BlockRangeError};
+
+        let (json_handler, _, _) = components_for_tests().await;
+        let genesis_id = json_handler.sequencer_view.genesis_id();
+        let chain_height = json_handler.sequencer_view.chain_height();
+
+        let too_long = json_handler
+            .process_block_range(&GetBlockRangeDataRequest {
+                start_block_id: genesis_id,
+                end_block_id: genesis_id + MAX_BLOCKS_PER_READ,
+            })
+            .await;
+        assert!(matches!(too_long, Err(BlockRangeError::TooLong)));
+
+        let not_stored = json_handler
+            .process_block_range(&GetBlockRangeDataRequest {
+                start_block_id: genesis_id,
+                end_block_id: chain_height + 1,
+            })
+            .await;
+        assert!(matches!(not_stored, Err(BlockRangeError::NotFound)));
+
+        let empty = json_handler
+            .process_block_range(&GetBlockRangeDataRequest {
+                start_block_id: chain_height + 1,
+                end_block_id: chain_height,
+            })
+            .await
+            .unwrap();
+        assert!(
+            borsh::from_slice::<Vec<HashableBlockData>>(&empty)
+                .unwrap()
+                .is_empty()
+        );
+    }
+
+    #[actix_web::test]
+    async fn test_block_stream_sends_stored_blocks_then_waits() {
+        use futures::{FutureExt as _, StreamExt as _};
+
+        use crate::process::Process as _;
+
+        let (json_handler, _, tx) = components_for_tests().await;
+        let genesis_id = json_handler.sequencer_view.genesis_id();
+        let chain_height = json_handler.sequencer_view.chain_height();
+
+        let mut blocks_stream = json_handler.subscribe_blocks(0).unwrap();
+        let frames = blocks_stream.next().await.unwrap().unwrap();
+
+        let mut blocks = Vec::new();
+        let mut rest = frames.as_slice();
+        while let Some((len, tail)) = rest.split_first_chunk::<4>() {
+            let (block, tail) = tail.split_at(u32::from_le_bytes(*len) as usize);
+            blocks.push(borsh::from_slice::<HashableBlockData>(block).unwrap());
+            rest = tail;
+        }
+
+        assert_eq!(
+            blocks
+                .iter()
+                .map(|block| block.block_id)
+                .collect::<Vec<_>>(),
+            (genesis_id..=chain_height).collect::<Vec<_>>()
+        );
+        assert_eq!(blocks.last().unwrap().transactions, vec![tx]);
+
+        // Nothing more until a new block is published
+        assert!(blocks_stream.next().now_or_never().is_none());
+    }
+
+    #[actix_web::test]
+    async fn test_block_streams_are_capped() {
+        use crate::process::Process as _;
+
+        let (json_handler, _, _) = components_for_tests().await;
+
+        let blocks_stream = json_handler.subscribe_blocks(0).unwrap();
+        assert!(json_handler.subscribe_blocks(0).is_none());
+
+        drop(blocks_stream);
+        assert!(json_handler.subscribe_blocks(0).is_some());
+    }
 }
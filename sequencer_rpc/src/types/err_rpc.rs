@@ -4,6 +4,7 @@ use common::{
 };
 use log::debug;
 
+#[derive(Debug)]
 pub struct RpcErr(pub RpcError);
 
 pub type RpcErrInternal = anyhow::Error;
@@ -42,12 +43,54 @@ impl RpcErrKind for RpcErrInternal {
     }
 }
 
+/// The blocking thread pool is shut down or the task panicked
+impl RpcErrKind for actix_web::error::BlockingError {
+    fn into_rpc_err(self) -> RpcError {
+        RpcError::new_internal_error(None, &self.to_string())
+    }
+}
+
+impl RpcErrKind for mempool::MemPoolError {
+    fn into_rpc_err(self) -> RpcError {
+        match self {
+            mempool::MemPoolError::Full | mempool::MemPoolError::SenderQueueFull => {
+                RpcError::server_error(Some(self.to_string()))
+            }
+            mempool::MemPoolError::Duplicate
+            | mempool::MemPoolError::Underpriced
+            | mempool::MemPoolError::NonceGapTooLarge => RpcError::invalid_params(self.to_string()),
+        }
+    }
+}
+
 impl RpcErrKind for TransactionMalformationError {
     fn into_rpc_err(self) -> RpcError {
         RpcError::invalid_params(Some(serde_json::to_value(self).unwrap()))
     }
 }
 
+/// Failure to serve a range of the binary block range endpoints
+#[derive(Debug)]
+pub enum BlockRangeError {
+    /// The range is longer than [`common::rpc_primitives::MAX_BLOCKS_PER_READ`]
+    TooLong,
+    /// Some block of the range is not stored
+    NotFound,
+    Internal(RpcErr),
+}
+
+impl<T: RpcErrKind> From<T> for BlockRangeError {
+    fn from(e: T) -> Self {
+        Self::Internal(e.into())
+    }
+}
+
+impl From<RpcErr> for BlockRangeError {
+    fn from(e: RpcErr) -> Self {
+        Self::Internal(e)
+    }
+}
+
 #[allow(clippy::needless_pass_by_value)]
 pub fn from_rpc_err_into_anyhow_err(rpc_err: RpcError) -> anyhow::Error {
     debug!("Rpc error cast to anyhow error : err {rpc_err:?}");
@@ -3,18 +3,27 @@ use std::{net::SocketAddr, path::PathBuf, sync::Arc, time::Duration};
 use actix_web::dev::ServerHandle;
 use anyhow::{Context as _, Result};
 use clap::Parser;
-use common::rpc_primitives::RpcConfig;
+use common::{
+    metrics::{self, LOCK_WAIT_SECONDS},
+    rpc_primitives::RpcConfig,
+};
 use futures::{FutureExt as _, never::Never};
 #[cfg(not(feature = "standalone"))]
 use log::warn;
 use log::{error, info};
+#[cfg(not(feature = "standalone"))]
+use sequencer_core::SequencerCore;
 #[cfg(feature = "standalone")]
 use sequencer_core::SequencerCoreWithMockClients as SequencerCore;
-use sequencer_core::config::SequencerConfig;
-#[cfg(not(feature = "standalone"))]
-use sequencer_core::{SequencerCore, block_settlement_client::BlockSettlementClientTrait as _};
+use sequencer_core::{
+    block_settlement_client::{BlockSettlementClientTrait, SettlementSubmitter},
+    config::SequencerConfig,
+};
 use sequencer_rpc::new_http_server;
-use tokio::{sync::Mutex, task::JoinHandle};
+use tokio::{
+    sync::{Mutex, MutexGuard},
+    task::JoinHandle,
+};
 
 pub const RUST_LOG: &str = "RUST_LOG";
 
@@ -32,6 +41,7 @@ pub struct SequencerHandle {
     addr: SocketAddr,
     http_server_handle: ServerHandle,
     main_loop_handle: JoinHandle<Result<Never>>,
+    settlement_loop_handle: JoinHandle<Result<Never>>,
     retry_pending_blocks_loop_handle: JoinHandle<Result<Never>>,
     listen_for_bedrock_blocks_loop_handle: JoinHandle<Result<Never>>,
 }
@@ -45,6 +55,7 @@ impl SequencerHandle {
             addr: _,
             http_server_handle: _,
             main_loop_handle,
+            settlement_loop_handle,
             retry_pending_blocks_loop_handle,
             listen_for_bedrock_blocks_loop_handle,
         } = self;
@@ -55,6 +66,11 @@ impl SequencerHandle {
                    .context("Main loop task panicked")?
                    .context("Main loop exited unexpectedly")
             }
+            res = settlement_loop_handle => {
+                res
+                   .context("Settlement loop task panicked")?
+                   .context("Settlement loop exited unexpectedly")
+            }
             res = retry_pending_blocks_loop_handle => {
                 res
                    .context("Retry pending blocks loop task panicked")?
@@ -70,6 +86,7 @@ impl SequencerHandle {
 
     pub fn is_finished(&self) -> bool {
         self.main_loop_handle.is_finished()
+            || self.settlement_loop_handle.is_finished()
             || self.retry_pending_blocks_loop_handle.is_finished()
             || self.listen_for_bedrock_blocks_loop_handle.is_finished()
     }
@@ -85,11 +102,13 @@ impl Drop for SequencerHandle {
             addr: _,
             http_server_handle,
             main_loop_handle,
+            settlement_loop_handle,
             retry_pending_blocks_loop_handle,
             listen_for_bedrock_blocks_loop_handle,
         } = self;
 
         main_loop_handle.abort();
+        settlement_loop_handle.abort();
         retry_pending_blocks_loop_handle.abort();
         listen_for_bedrock_blocks_loop_handle.abort();
 
@@ -103,7 +122,12 @@ pub async fn startup_sequencer(app_config: SequencerConfig) -> Result<SequencerH
     let retry_pending_blocks_timeout = app_config.retry_pending_blocks_timeout;
     let port = app_config.port;
 
-    let (sequencer_core, mempool_handle) = SequencerCore::start_from_config(app_config).await;
+    metrics::init();
+
+    let (mut sequencer_core, mempool_handle) = SequencerCore::start_from_config(app_config).await;
+    let settlement_submitter = sequencer_core
+        .take_settlement_submitter()
+        .expect("Settlement submitter of a new sequencer core should be available");
 
     info!("Sequencer core set up");
 
@@ -127,6 +151,9 @@ pub async fn startup_sequencer(app_config: SequencerConfig) -> Result<SequencerH
             .expect("Failed to submit pending blocks on startup");
     }
 
+    info!("Starting settlement loop");
+    let settlement_loop_handle = tokio::spawn(settlement_loop(settlement_submitter));
+
     info!("Starting main sequencer loop");
     let main_loop_handle = tokio::spawn(main_loop(Arc::clone(&seq_core_wrapped), block_timeout));
 
@@ -144,11 +171,20 @@ pub async fn startup_sequencer(app_config: SequencerConfig) -> Result<SequencerH
         addr,
         http_server_handle,
         main_loop_handle,
+        settlement_loop_handle,
         retry_pending_blocks_loop_handle,
         listen_for_bedrock_blocks_loop_handle,
     })
 }
 
+/// Lock the sequencer core, timing the wait for the loops sharing it.
+async fn lock_sequencer(seq_core: &Mutex<SequencerCore>) -> MutexGuard<'_, SequencerCore> {
+    let _timer = LOCK_WAIT_SECONDS
+        .with_label_values(&["sequencer_core"])
+        .start_timer();
+    seq_core.lock().await
+}
+
 async fn main_loop(seq_core: Arc<Mutex<SequencerCore>>, block_timeout: Duration) -> Result<Never> {
     loop {
         tokio::time::sleep(block_timeout).await;
@@ -156,17 +192,26 @@ async fn main_loop(seq_core: Arc<Mutex<SequencerCore>>, block_timeout: Duration)
         info!("Collecting transactions from mempool, block creation");
 
         let id = {
-            let mut state = seq_core.lock().await;
+            let mut state = lock_sequencer(&seq_core).await;
 
-            state.produce_new_block().await?
+            state.produce_new_block()?
         };
 
-        info!("Block with id {id} created");
+        info!("Block with id {id} created and queued for settlement");
 
         info!("Waiting for new transactions");
     }
 }
 
+/// Submit produced blocks to Bedrock in the background, so that block production never waits for
+/// it.
+async fn settlement_loop<BC: BlockSettlementClientTrait>(
+    submitter: SettlementSubmitter<BC>,
+) -> Result<Never> {
+    submitter.run().await?;
+    anyhow::bail!("Settlement queue closed")
+}
+
 #[cfg(not(feature = "standalone"))]
 async fn retry_pending_blocks(seq_core: &Arc<Mutex<SequencerCore>>) -> Result<()> {
     use std::time::Instant;
@@ -174,11 +219,16 @@ async fn retry_pending_blocks(seq_core: &Arc<Mutex<SequencerCore>>) -> Result<()
     use log::debug;
 
     let (mut pending_blocks, block_settlement_client) = {
-        let sequencer_core = seq_core.lock().await;
+        let sequencer_core = lock_sequencer(seq_core).await;
         let client = sequencer_core.block_settlement_client();
         let pending_blocks = sequencer_core
             .get_pending_blocks()
             .expect("Sequencer should be able to retrieve pending blocks");
+        debug!(
+            "{} pending blocks, {} of them not submitted yet",
+            pending_blocks.len(),
+            sequencer_core.settlement_backlog()
+        );
         (pending_blocks, client)
     };
 
@@ -236,7 +286,7 @@ async fn retry_pending_blocks_loop(
 async fn listen_for_bedrock_blocks_loop(seq_core: Arc<Mutex<SequencerCore>>) -> Result<Never> {
     use indexer_service_rpc::RpcClient as _;
 
-    let indexer_client = seq_core.lock().await.indexer_client();
+    let indexer_client = lock_sequencer(&seq_core).await.indexer_client();
 
     let retry_delay = Duration::from_secs(5);
 
@@ -0,0 +1,122 @@
+//! Benchmarks of block storage in the sequencer and state reconstruction in the indexer.
+
+use std::hint::black_box;
+
+use common::{
+    block::Block,
+    test_utils::{create_transaction_native_token_transfer, produce_dummy_block},
+    transaction::NSSATransaction,
+};
+use criterion::{BatchSize, BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use nssa::{AccountId, PrivateKey, PublicKey, V02State};
+use storage::{indexer, sequencer};
+use tempfile::tempdir;
+
+const TXS_PER_BLOCK: u128 = 100;
+
+fn sender_key() -> PrivateKey {
+    PrivateKey::try_new([1; 32]).unwrap()
+}
+
+fn sender() -> AccountId {
+    AccountId::from(&PublicKey::new_from_private_key(&sender_key()))
+}
+
+fn recipient() -> AccountId {
+    AccountId::new([2; 32])
+}
+
+fn initial_state() -> V02State {
+    V02State::new_with_genesis_accounts(&[(sender(), u128::MAX / 2)], &[])
+}
+
+fn genesis_block() -> Block {
+    produce_dummy_block(1, None, vec![])
+}
+
+fn transfers(first_nonce: u128, count: u128) -> Vec<NSSATransaction> {
+    (first_nonce..first_nonce + count)
+        .map(|nonce| {
+            create_transaction_native_token_transfer(sender(), nonce, recipient(), 1, sender_key())
+        })
+        .collect()
+}
+
+fn atomic_update(c: &mut Criterion) {
+    let temp_dir = tempdir().unwrap();
+    let genesis = genesis_block();
+    let dbio =
+        sequencer::RocksDBIO::open_or_create(temp_dir.path(), Some((&genesis, [0; 32]))).unwrap();
+
+    let txs = transfers(0, TXS_PER_BLOCK);
+    let state_diff = {
+        let mut state = initial_state();
+        for tx in &txs {
+            tx.clone()
+                .transaction_stateless_check()
+                .unwrap()
+                .execute_on_state(&mut state)
+                .unwrap();
+        }
+        state.state_diff()
+    };
+
+    let mut block_id = genesis.header.block_id;
+    let mut prev_hash = genesis.header.hash;
+
+    let mut group = c.benchmark_group("atomic_update");
+    group.throughput(Throughput::Elements(TXS_PER_BLOCK as u64));
+    group.bench_function(BenchmarkId::from_parameter(TXS_PER_BLOCK), |b| {
+        b.iter_batched(
+            || {
+                block_id += 1;
+                let block = produce_dummy_block(block_id, Some(prev_hash), txs.clone());
+                prev_hash = block.header.hash;
+                block
+            },
+            |block| {
+                dbio.atomic_update(black_box(&block), [0; 32], &state_diff)
+                    .unwrap()
+            },
+            BatchSize::SmallInput,
+        )
+    });
+    group.finish();
+}
+
+fn calculate_state_for_id(c: &mut Criterion) {
+    let mut group = c.benchmark_group("calculate_state_for_id");
+    group.sample_size(10);
+
+    for replayed_blocks in [10, 100, 1000] {
+        let temp_dir = tempdir().unwrap();
+        let genesis = genesis_block();
+        let dbio = indexer::RocksDBIO::open_or_create(
+            temp_dir.path(),
+            Some((genesis.clone(), initial_state())),
+        )
+        .unwrap();
+
+        let mut prev_hash = genesis.header.hash;
+        let mut last_block_id = genesis.header.block_id;
+        for i in 0..replayed_blocks {
+            last_block_id += 1;
+            let block = produce_dummy_block(last_block_id, Some(prev_hash), transfers(i, 1));
+            prev_hash = block.header.hash;
+            dbio.put_block(block, [0; 32]).unwrap();
+        }
+
+        group.throughput(Throughput::Elements(replayed_blocks as u64));
+        group.bench_function(BenchmarkId::from_parameter(replayed_blocks), |b| {
+            b.iter(|| {
+                dbio.calculate_state_for_id(black_box(last_block_id))
+                    .unwrap()
+            })
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, atomic_update, calculate_state_for_id);
+criterion_main!(benches);
@@ -1,7 +1,11 @@
-use std::{collections::HashMap, ops::Div, path::Path, sync::Arc};
+use std::{collections::HashMap, path::Path, sync::Arc};
 
-use common::{block::Block, transaction::NSSATransaction};
-use nssa::V02State;
+use common::{
+    block::Block,
+    metrics::{DB_WRITE_SECONDS, INDEXER_REPLAY_BLOCKS},
+    transaction::NSSATransaction,
+};
+use nssa::{Account, AccountId, V02State};
 use rocksdb::{
     BoundColumnFamily, ColumnFamilyDescriptor, DBWithThreadMode, MultiThreaded, Options, WriteBatch,
 };
@@ -32,15 +36,19 @@ pub const DB_META_FIRST_BLOCK_SET_KEY: &str = "first_block_set";
 /// Key base for storing metainformation about the last breakpoint
 pub const DB_META_LAST_BREAKPOINT_ID: &str = "last_breakpoint_id";
 
-/// Interval between state breakpoints
-pub const BREAKPOINT_INTERVAL: u64 = 100;
+/// Interval between breakpoints of the legacy breakpoint column family
+const LEGACY_BREAKPOINT_INTERVAL: u64 = 100;
 
 /// Name of block column family
 pub const CF_BLOCK_NAME: &str = "cf_block";
 /// Name of meta column family
 pub const CF_META_NAME: &str = "cf_meta";
 /// Name of breakpoint column family
-pub const CF_BREAKPOINT_NAME: &str = "cf_breakpoint";
+///
+/// Breakpoints are keyed by the id of the first block not applied to them.
+pub const CF_BREAKPOINT_NAME: &str = "cf_breakpoint_at_block";
+/// Name of legacy breakpoint column family, keyed by breakpoint index
+pub const CF_LEGACY_BREAKPOINT_NAME: &str = "cf_breakpoint";
 /// Name of hash to id map column family
 pub const CF_HASH_TO_ID: &str = "cf_hash_to_id";
 /// Name of tx hash to id map column family
@@ -49,13 +57,11 @@ pub const CF_TX_TO_ID: &str = "cf_tx_to_id";
 pub const CF_ACC_META: &str = "cf_acc_meta";
 /// Name of account id to tx hash map column family
 pub const CF_ACC_TO_TX: &str = "cf_acc_to_tx";
+/// Name of final public accounts column family
+pub const CF_ACCOUNTS_NAME: &str = "cf_accounts";
 
 pub type DbResult<T> = Result<T, DbError>;
 
-fn closest_breakpoint_id(block_id: u64) -> u64 {
-    block_id.saturating_sub(1).div(BREAKPOINT_INTERVAL)
-}
-
 pub struct RocksDBIO {
     pub db: DBWithThreadMode<MultiThreaded>,
 }
@@ -68,10 +74,13 @@ impl RocksDBIO {
         let cfb = ColumnFamilyDescriptor::new(CF_BLOCK_NAME, cf_opts.clone());
         let cfmeta = ColumnFamilyDescriptor::new(CF_META_NAME, cf_opts.clone());
         let cfbreakpoint = ColumnFamilyDescriptor::new(CF_BREAKPOINT_NAME, cf_opts.clone());
+        let cflegacybreakpoint =
+            ColumnFamilyDescriptor::new(CF_LEGACY_BREAKPOINT_NAME, cf_opts.clone());
         let cfhti = ColumnFamilyDescriptor::new(CF_HASH_TO_ID, cf_opts.clone());
         let cftti = ColumnFamilyDescriptor::new(CF_TX_TO_ID, cf_opts.clone());
         let cfameta = ColumnFamilyDescriptor::new(CF_ACC_META, cf_opts.clone());
         let cfatt = ColumnFamilyDescriptor::new(CF_ACC_TO_TX, cf_opts.clone());
+        let cfaccounts = ColumnFamilyDescriptor::new(CF_ACCOUNTS_NAME, cf_opts.clone());
 
         let mut db_opts = Options::default();
         db_opts.create_missing_column_families(true);
@@ -79,7 +88,17 @@ impl RocksDBIO {
         let db = DBWithThreadMode::<MultiThreaded>::open_cf_descriptors(
             &db_opts,
             path,
-            vec![cfb, cfmeta, cfbreakpoint, cfhti, cftti, cfameta, cfatt],
+            vec![
+                cfb,
+                cfmeta,
+                cfbreakpoint,
+                cflegacybreakpoint,
+                cfhti,
+                cftti,
+                cfameta,
+                cfatt,
+                cfaccounts,
+            ],
         );
 
         let dbio = Self {
@@ -90,6 +109,8 @@ impl RocksDBIO {
         let is_start_set = dbio.get_meta_is_first_block_set()?;
 
         if is_start_set {
+            dbio.migrate_legacy_breakpoints()?;
+
             Ok(dbio)
         } else if let Some((block, initial_state)) = start_data {
             let block_id = block.header.block_id;
@@ -97,9 +118,10 @@ impl RocksDBIO {
             dbio.put_meta_first_block_in_db(block)?;
             dbio.put_meta_is_first_block_set()?;
 
-            // First breakpoint setup
-            dbio.put_breakpoint(0, initial_state)?;
-            dbio.put_meta_last_breakpoint_id(0)?;
+            dbio.put_final_accounts(&initial_state.state_diff().accounts)?;
+
+            // First breakpoint setup, genesis state does not include the first block
+            dbio.put_breakpoint(block_id, &initial_state)?;
 
             Ok(dbio)
         } else {
@@ -115,10 +137,13 @@ impl RocksDBIO {
         let _cfb = ColumnFamilyDescriptor::new(CF_BLOCK_NAME, cf_opts.clone());
         let _cfmeta = ColumnFamilyDescriptor::new(CF_META_NAME, cf_opts.clone());
         let _cfsnapshot = ColumnFamilyDescriptor::new(CF_BREAKPOINT_NAME, cf_opts.clone());
+        let _cflegacysnapshot =
+            ColumnFamilyDescriptor::new(CF_LEGACY_BREAKPOINT_NAME, cf_opts.clone());
         let _cfhti = ColumnFamilyDescriptor::new(CF_HASH_TO_ID, cf_opts.clone());
         let _cftti = ColumnFamilyDescriptor::new(CF_TX_TO_ID, cf_opts.clone());
         let _cfameta = ColumnFamilyDescriptor::new(CF_ACC_META, cf_opts.clone());
         let _cfatt = ColumnFamilyDescriptor::new(CF_ACC_TO_TX, cf_opts.clone());
+        let _cfaccounts = ColumnFamilyDescriptor::new(CF_ACCOUNTS_NAME, cf_opts.clone());
 
         let mut db_opts = Options::default();
         db_opts.create_missing_column_families(true);
@@ -141,6 +166,10 @@ impl RocksDBIO {
         self.db.cf_handle(CF_BREAKPOINT_NAME).unwrap()
     }
 
+    pub fn legacy_breakpoint_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_LEGACY_BREAKPOINT_NAME).unwrap()
+    }
+
     pub fn hash_to_id_column(&self) -> Arc<BoundColumnFamily<'_>> {
         self.db.cf_handle(CF_HASH_TO_ID).unwrap()
     }
@@ -157,6 +186,10 @@ impl RocksDBIO {
         self.db.cf_handle(CF_ACC_META).unwrap()
     }
 
+    pub fn accounts_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_ACCOUNTS_NAME).unwrap()
+    }
+
     // Meta
 
     pub fn get_meta_first_block_in_db(&self) -> DbResult<u64> {
@@ -371,25 +404,27 @@ impl RocksDBIO {
         Ok(())
     }
 
-    pub fn put_meta_last_breakpoint_id(&self, br_id: u64) -> DbResult<()> {
+    fn put_meta_last_breakpoint_id_batch(
+        &self,
+        br_id: u64,
+        write_batch: &mut WriteBatch,
+    ) -> DbResult<()> {
         let cf_meta = self.meta_column();
-        self.db
-            .put_cf(
-                &cf_meta,
-                borsh::to_vec(&DB_META_LAST_BREAKPOINT_ID).map_err(|err| {
-                    DbError::borsh_cast_message(
-                        err,
-                        Some("Failed to serialize DB_META_LAST_BREAKPOINT_ID".to_string()),
-                    )
-                })?,
-                borsh::to_vec(&br_id).map_err(|err| {
-                    DbError::borsh_cast_message(
-                        err,
-                        Some("Failed to serialize last block id".to_string()),
-                    )
-                })?,
-            )
-            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+        write_batch.put_cf(
+            &cf_meta,
+            borsh::to_vec(&DB_META_LAST_BREAKPOINT_ID).map_err(|err| {
+                DbError::borsh_cast_message(
+                    err,
+                    Some("Failed to serialize DB_META_LAST_BREAKPOINT_ID".to_string()),
+                )
+            })?,
+            borsh::to_vec(&br_id).map_err(|err| {
+                DbError::borsh_cast_message(
+                    err,
+                    Some("Failed to serialize last breakpoint id".to_string()),
+                )
+            })?,
+        );
         Ok(())
     }
 
@@ -413,6 +448,10 @@ impl RocksDBIO {
     // Block
 
     pub fn put_block(&self, block: Block, l1_lib_header: [u8; 32]) -> DbResult<()> {
+        let _timer = DB_WRITE_SECONDS
+            .with_label_values(&["indexer"])
+            .start_timer();
+
         let cf_block = self.block_column();
         let cf_hti = self.hash_to_id_column();
         let cf_tti: Arc<BoundColumnFamily<'_>> = self.tx_hash_to_id_column();
@@ -464,7 +503,7 @@ impl RocksDBIO {
 
         let mut acc_to_tx_map: HashMap<[u8; 32], Vec<[u8; 32]>> = HashMap::new();
 
-        for tx in block.body.transactions {
+        for (tx_index, tx) in block.body.transactions.into_iter().enumerate() {
             let tx_hash = tx.hash();
 
             self.db
@@ -476,10 +515,10 @@ impl RocksDBIO {
                             Some("Failed to serialize tx hash".to_string()),
                         )
                     })?,
-                    borsh::to_vec(&block.header.block_id).map_err(|err| {
+                    borsh::to_vec(&(block.header.block_id, tx_index as u64)).map_err(|err| {
                         DbError::borsh_cast_message(
                             err,
-                            Some("Failed to serialize block id".to_string()),
+                            Some("Failed to serialize tx location".to_string()),
                         )
                     })?,
                 )
@@ -503,10 +542,6 @@ impl RocksDBIO {
             self.put_account_transactions(acc_id, tx_hashes)?;
         }
 
-        if block.header.block_id.is_multiple_of(BREAKPOINT_INTERVAL) {
-            self.put_next_breakpoint()?;
-        }
-
         Ok(())
     }
 
@@ -592,41 +627,38 @@ impl RocksDBIO {
 
     // State
 
-    pub fn put_breakpoint(&self, br_id: u64, breakpoint: V02State) -> DbResult<()> {
+    /// Store the state before block `br_id` is applied as a breakpoint.
+    pub fn put_breakpoint(&self, br_id: u64, breakpoint: &V02State) -> DbResult<()> {
         let cf_br = self.breakpoint_column();
+        let mut write_batch = WriteBatch::new();
 
-        self.db
-            .put_cf(
-                &cf_br,
-                borsh::to_vec(&br_id).map_err(|err| {
-                    DbError::borsh_cast_message(
-                        err,
-                        Some("Failed to serialize breakpoint id".to_string()),
-                    )
-                })?,
-                borsh::to_vec(&breakpoint).map_err(|err| {
-                    DbError::borsh_cast_message(
-                        err,
-                        Some("Failed to serialize breakpoint data".to_string()),
-                    )
-                })?,
-            )
-            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))
+        // Big endian keys keep breakpoints in block order when iterating
+        write_batch.put_cf(
+            &cf_br,
+            br_id.to_be_bytes(),
+            borsh::to_vec(breakpoint).map_err(|err| {
+                DbError::borsh_cast_message(
+                    err,
+                    Some("Failed to serialize breakpoint data".to_string()),
+                )
+            })?,
+        );
+
+        // Last breakpoint id is not set before the first breakpoint
+        if !matches!(self.get_meta_last_breakpoint_id(), Ok(last_br_id) if last_br_id >= br_id) {
+            self.put_meta_last_breakpoint_id_batch(br_id, &mut write_batch)?;
+        }
+
+        self.db.write(write_batch).map_err(|rerr| {
+            DbError::rocksdb_cast_message(rerr, Some("Failed to write batch".to_string()))
+        })
     }
 
     pub fn get_breakpoint(&self, br_id: u64) -> DbResult<V02State> {
         let cf_br = self.breakpoint_column();
         let res = self
             .db
-            .get_cf(
-                &cf_br,
-                borsh::to_vec(&br_id).map_err(|err| {
-                    DbError::borsh_cast_message(
-                        err,
-                        Some("Failed to serialize breakpoint id".to_string()),
-                    )
-                })?,
-            )
+            .get_cf(&cf_br, br_id.to_be_bytes())
             .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
 
         if let Some(data) = res {
@@ -643,40 +675,59 @@ impl RocksDBIO {
         }
     }
 
+    /// Id of the closest breakpoint to reconstruct the state after `block_id` from.
+    ///
+    /// Blocks from the returned id up to `block_id` must be applied to the breakpoint.
+    pub fn closest_breakpoint(&self, block_id: u64) -> DbResult<u64> {
+        let cf_br = self.breakpoint_column();
+        let mut iter = self.db.raw_iterator_cf(&cf_br);
+        iter.seek_for_prev(block_id.saturating_add(1).to_be_bytes());
+        iter.status()
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        let key = iter.key().ok_or_else(|| {
+            DbError::db_interaction_error("No breakpoint found before this block".to_string())
+        })?;
+
+        <[u8; 8]>::try_from(key)
+            .map(u64::from_be_bytes)
+            .map_err(|_| DbError::db_interaction_error("Malformed breakpoint id".to_string()))
+    }
+
+    /// Apply the transactions of blocks `from..=to` to `state`.
+    pub fn apply_blocks(&self, state: &mut V02State, from: u64, to: u64) -> DbResult<()> {
+        INDEXER_REPLAY_BLOCKS.observe((to + 1).saturating_sub(from) as f64);
+
+        for id in from..=to {
+            let block = self.get_block(id)?;
+
+            let transactions = NSSATransaction::verify_signatures_batch(block.body.transactions)
+                .map_err(|invalid| {
+                    DbError::db_interaction_error(format!(
+                        "transaction pre check failed for transactions {invalid:?} of block {id}"
+                    ))
+                })?;
+
+            for transaction in transactions {
+                transaction.execute_on_state(state).map_err(|err| {
+                    DbError::db_interaction_error(format!(
+                        "transaction execution failed with err {err:?}"
+                    ))
+                })?;
+            }
+        }
+
+        Ok(())
+    }
+
     pub fn calculate_state_for_id(&self, block_id: u64) -> DbResult<V02State> {
         let last_block = self.get_meta_last_block_in_db()?;
 
         if block_id <= last_block {
-            let br_id = closest_breakpoint_id(block_id);
+            let br_id = self.closest_breakpoint(block_id)?;
             let mut breakpoint = self.get_breakpoint(br_id)?;
 
-            // ToDo: update it to handle any genesis id
-            // right now works correctly only if genesis_id < BREAKPOINT_INTERVAL
-            let start = if br_id != 0 {
-                BREAKPOINT_INTERVAL * br_id
-            } else {
-                self.get_meta_first_block_in_db()?
-            };
-
-            for id in start..=block_id {
-                let block = self.get_block(id)?;
-
-                for transaction in block.body.transactions {
-                    transaction
-                        .transaction_stateless_check()
-                        .map_err(|err| {
-                            DbError::db_interaction_error(format!(
-                                "transaction pre check failed with err {err:?}"
-                            ))
-                        })?
-                        .execute_check_on_state(&mut breakpoint)
-                        .map_err(|err| {
-                            DbError::db_interaction_error(format!(
-                                "transaction execution failed with err {err:?}"
-                            ))
-                        })?;
-                }
-            }
+            self.apply_blocks(&mut breakpoint, br_id, block_id)?;
 
             Ok(breakpoint)
         } else {
@@ -690,21 +741,101 @@ impl RocksDBIO {
         self.calculate_state_for_id(self.get_meta_last_block_in_db()?)
     }
 
-    pub fn put_next_breakpoint(&self) -> DbResult<()> {
-        let last_block = self.get_meta_last_block_in_db()?;
-        let next_breakpoint_id = self.get_meta_last_breakpoint_id()? + 1;
-        let block_to_break_id = next_breakpoint_id * BREAKPOINT_INTERVAL;
+    /// Move breakpoints of the legacy column family, stored every
+    /// `LEGACY_BREAKPOINT_INTERVAL` blocks by index, to the breakpoint column family.
+    fn migrate_legacy_breakpoints(&self) -> DbResult<()> {
+        let cf_legacy = self.legacy_breakpoint_column();
+        let cf_br = self.breakpoint_column();
+        let first_block_id = self.get_meta_first_block_in_db()?;
+        let mut last_br_id = None;
+        let mut write_batch = WriteBatch::new();
+
+        for entry in self
+            .db
+            .iterator_cf(&cf_legacy, rocksdb::IteratorMode::Start)
+        {
+            let (key, value) = entry.map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+            let index = borsh::from_slice::<u64>(&key).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize legacy breakpoint id".to_string()),
+                )
+            })?;
 
-        if block_to_break_id <= last_block {
-            let next_breakpoint = self.calculate_state_for_id(block_to_break_id)?;
+            // Legacy breakpoint 0 is the genesis state, the others include their last block
+            let br_id = if index == 0 {
+                first_block_id
+            } else {
+                index * LEGACY_BREAKPOINT_INTERVAL + 1
+            };
 
-            self.put_breakpoint(next_breakpoint_id, next_breakpoint)?;
-            self.put_meta_last_breakpoint_id(next_breakpoint_id)
-        } else {
-            Err(DbError::db_interaction_error(
-                "Breakpoint not yet achieved".to_string(),
-            ))
+            write_batch.put_cf(&cf_br, br_id.to_be_bytes(), value);
+            write_batch.delete_cf(&cf_legacy, key);
+            last_br_id = last_br_id.max(Some(br_id));
+        }
+
+        let Some(last_br_id) = last_br_id else {
+            return Ok(());
+        };
+        self.put_meta_last_breakpoint_id_batch(last_br_id, &mut write_batch)?;
+
+        self.db.write(write_batch).map_err(|rerr| {
+            DbError::rocksdb_cast_message(rerr, Some("Failed to write batch".to_string()))
+        })
+    }
+
+    // Final accounts
+
+    /// Overwrite the final values of `accounts` in the account table.
+    pub fn put_final_accounts(&self, accounts: &[(AccountId, Account)]) -> DbResult<()> {
+        let cf_accounts = self.accounts_column();
+        let mut write_batch = WriteBatch::new();
+
+        for (account_id, account) in accounts {
+            write_batch.put_cf(
+                &cf_accounts,
+                borsh::to_vec(account_id).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize account id".to_string()),
+                    )
+                })?,
+                borsh::to_vec(account).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize account".to_string()),
+                    )
+                })?,
+            );
         }
+
+        self.db.write(write_batch).map_err(|rerr| {
+            DbError::rocksdb_cast_message(rerr, Some("Failed to write batch".to_string()))
+        })
+    }
+
+    /// Final value of an account, `None` if the account was never touched.
+    pub fn get_final_account(&self, account_id: &AccountId) -> DbResult<Option<Account>> {
+        let cf_accounts = self.accounts_column();
+        let res = self
+            .db
+            .get_cf(
+                &cf_accounts,
+                borsh::to_vec(account_id).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize account id".to_string()),
+                    )
+                })?,
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        res.map(|data| {
+            borsh::from_slice::<Account>(&data).map_err(|serr| {
+                DbError::borsh_cast_message(serr, Some("Failed to deserialize account".to_string()))
+            })
+        })
+        .transpose()
     }
 
     // Mappings
@@ -754,12 +885,7 @@ impl RocksDBIO {
             .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
 
         if let Some(data) = res {
-            Ok(borsh::from_slice::<u64>(&data).map_err(|serr| {
-                DbError::borsh_cast_message(
-                    serr,
-                    Some("Failed to deserialize block id".to_string()),
-                )
-            })?)
+            Ok(tx_location_from_slice(&data)?.0)
         } else {
             Err(DbError::db_interaction_error(
                 "Block for this tx hash not found".to_string(),
@@ -767,6 +893,99 @@ impl RocksDBIO {
         }
     }
 
+    /// Look up transactions by hash, deserializing each containing block once.
+    pub fn get_transactions_by_hashes(
+        &self,
+        tx_hashes: &[[u8; 32]],
+    ) -> DbResult<Vec<NSSATransaction>> {
+        let cf_tti = self.tx_hash_to_id_column();
+        let cf_block = self.block_column();
+
+        let tx_hash_keys = tx_hashes
+            .iter()
+            .map(|tx_hash| {
+                borsh::to_vec(tx_hash).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize tx hash".to_string()),
+                    )
+                })
+            })
+            .collect::<DbResult<Vec<_>>>()?;
+
+        let locations = self
+            .db
+            .multi_get_cf(tx_hash_keys.iter().map(|key| (&cf_tti, key)))
+            .into_iter()
+            .map(|res| {
+                let data = res
+                    .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?
+                    .ok_or_else(|| {
+                        DbError::db_interaction_error(
+                            "Block for this tx hash not found".to_string(),
+                        )
+                    })?;
+                tx_location_from_slice(&data)
+            })
+            .collect::<DbResult<Vec<_>>>()?;
+
+        let mut block_ids = locations
+            .iter()
+            .map(|(block_id, _)| *block_id)
+            .collect::<Vec<_>>();
+        block_ids.sort_unstable();
+        block_ids.dedup();
+
+        let block_keys = block_ids
+            .iter()
+            .map(|block_id| {
+                borsh::to_vec(block_id).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize block id".to_string()),
+                    )
+                })
+            })
+            .collect::<DbResult<Vec<_>>>()?;
+
+        let mut blocks = HashMap::with_capacity(block_ids.len());
+        for (block_id, res) in block_ids.into_iter().zip(
+            self.db
+                .multi_get_cf(block_keys.iter().map(|key| (&cf_block, key))),
+        ) {
+            let data = res
+                .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?
+                .ok_or_else(|| {
+                    DbError::db_interaction_error("Block on this id not found".to_string())
+                })?;
+            let block = borsh::from_slice::<Block>(&data).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize block data".to_string()),
+                )
+            })?;
+            blocks.insert(block_id, block);
+        }
+
+        tx_hashes
+            .iter()
+            .zip(locations)
+            .map(|(tx_hash, (block_id, tx_index))| {
+                let transactions = &blocks[&block_id].body.transactions;
+                let transaction = match tx_index {
+                    Some(tx_index) => transactions.get(tx_index as usize),
+                    None => transactions.iter().find(|tx| tx.hash().0 == *tx_hash),
+                };
+
+                transaction.cloned().ok_or_else(|| {
+                    DbError::db_interaction_error(format!(
+                        "Missing transaction in block {block_id} with hash {tx_hash:#?}"
+                    ))
+                })
+            })
+            .collect()
+    }
+
     // Accounts meta
 
     fn update_acc_meta_batch(
@@ -821,21 +1040,9 @@ impl RocksDBIO {
         for (tx_id, tx_hash) in tx_hashes.iter().enumerate() {
             let put_id = acc_num_tx + tx_id as u64;
 
-            let mut prefix = borsh::to_vec(&acc_id).map_err(|berr| {
-                DbError::borsh_cast_message(
-                    berr,
-                    Some("Failed to serialize account id".to_string()),
-                )
-            })?;
-            let suffix = borsh::to_vec(&put_id).map_err(|berr| {
-                DbError::borsh_cast_message(berr, Some("Failed to serialize tx id".to_string()))
-            })?;
-
-            prefix.extend_from_slice(&suffix);
-
             write_batch.put_cf(
                 &cf_att,
-                prefix,
+                acc_tx_key(acc_id, put_id)?,
                 borsh::to_vec(tx_hash).map_err(|berr| {
                     DbError::borsh_cast_message(
                         berr,
@@ -863,41 +1070,26 @@ impl RocksDBIO {
         limit: u64,
     ) -> DbResult<Vec<[u8; 32]>> {
         let cf_att = self.account_id_to_tx_hash_column();
-        let mut tx_batch = vec![];
-
-        // ToDo: Multi get this
-
-        for tx_id in offset..(offset + limit) {
-            let mut prefix = borsh::to_vec(&acc_id).map_err(|berr| {
-                DbError::borsh_cast_message(
-                    berr,
-                    Some("Failed to serialize account id".to_string()),
-                )
-            })?;
-            let suffix = borsh::to_vec(&tx_id).map_err(|berr| {
-                DbError::borsh_cast_message(berr, Some("Failed to serialize tx id".to_string()))
-            })?;
+        let num_tx = self.get_acc_meta_num_tx(acc_id)?.unwrap_or(0);
+        let end = offset.saturating_add(limit).min(num_tx);
 
-            prefix.extend_from_slice(&suffix);
+        // The tx id suffix is little endian, so keys of the range are fetched
+        // in one batch instead of iterating over the account prefix.
+        let keys = (offset..end)
+            .map(|tx_id| acc_tx_key(acc_id, tx_id))
+            .collect::<DbResult<Vec<_>>>()?;
 
-            let res = self
-                .db
-                .get_cf(&cf_att, prefix)
-                .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+        let mut tx_batch = Vec::with_capacity(keys.len());
 
-            let tx_hash = if let Some(data) = res {
-                Ok(borsh::from_slice::<[u8; 32]>(&data).map_err(|serr| {
-                    DbError::borsh_cast_message(
-                        serr,
-                        Some("Failed to deserialize tx_hash".to_string()),
-                    )
-                })?)
-            } else {
+        for res in self.db.multi_get_cf(keys.iter().map(|key| (&cf_att, key))) {
+            let Some(data) = res.map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))? else {
                 // Tx hash not found, assuming that previous one was the last
                 break;
-            }?;
+            };
 
-            tx_batch.push(tx_hash);
+            tx_batch.push(borsh::from_slice::<[u8; 32]>(&data).map_err(|serr| {
+                DbError::borsh_cast_message(serr, Some("Failed to deserialize tx_hash".to_string()))
+            })?);
         }
 
         Ok(tx_batch)
@@ -909,29 +1101,38 @@ impl RocksDBIO {
         offset: u64,
         limit: u64,
     ) -> DbResult<Vec<NSSATransaction>> {
-        let mut tx_batch = vec![];
-
-        for tx_hash in self.get_acc_transaction_hashes(acc_id, offset, limit)? {
-            let block_id = self.get_block_id_by_tx_hash(tx_hash)?;
-            let block = self.get_block(block_id)?;
-
-            let transaction = block
-                .body
-                .transactions
-                .iter()
-                .find(|tx| tx.hash().0 == tx_hash)
-                .ok_or(DbError::db_interaction_error(format!(
-                    "Missing transaction in block {} with hash {:#?}",
-                    block.header.block_id, tx_hash
-                )))?;
-
-            tx_batch.push(transaction.clone());
-        }
+        let tx_hashes = self.get_acc_transaction_hashes(acc_id, offset, limit)?;
 
-        Ok(tx_batch)
+        self.get_transactions_by_hashes(&tx_hashes)
     }
 }
 
+fn acc_tx_key(acc_id: [u8; 32], tx_id: u64) -> DbResult<Vec<u8>> {
+    let mut prefix = borsh::to_vec(&acc_id).map_err(|berr| {
+        DbError::borsh_cast_message(berr, Some("Failed to serialize account id".to_string()))
+    })?;
+    let suffix = borsh::to_vec(&tx_id).map_err(|berr| {
+        DbError::borsh_cast_message(berr, Some("Failed to serialize tx id".to_string()))
+    })?;
+
+    prefix.extend_from_slice(&suffix);
+    Ok(prefix)
+}
+
+/// Decode a tx location as the block id and the index in the block.
+///
+/// Locations stored before the index was added only hold the block id.
+fn tx_location_from_slice(data: &[u8]) -> DbResult<(u64, Option<u64>)> {
+    if let Ok(block_id) = borsh::from_slice::<u64>(data) {
+        return Ok((block_id, None));
+    }
+
+    let (block_id, tx_index) = borsh::from_slice::<(u64, u64)>(data).map_err(|serr| {
+        DbError::borsh_cast_message(serr, Some("Failed to deserialize tx location".to_string()))
+    })?;
+    Ok((block_id, Some(tx_index)))
+}
+
 #[cfg(test)]
 mod tests {
     use nssa::AccountId;
@@ -1002,13 +1203,13 @@ mod tests {
         let is_first_set = dbio.get_meta_is_first_block_set().unwrap();
         let last_br_id = dbio.get_meta_last_breakpoint_id().unwrap();
         let last_block = dbio.get_block(1).unwrap();
-        let breakpoint = dbio.get_breakpoint(0).unwrap();
+        let breakpoint = dbio.get_breakpoint(1).unwrap();
         let final_state = dbio.final_state().unwrap();
 
         assert_eq!(last_id, 1);
         assert_eq!(first_id, 1);
         assert!(is_first_set);
-        assert_eq!(last_br_id, 0);
+        assert_eq!(last_br_id, 1);
         assert_eq!(last_block.header.hash, genesis_block().header.hash);
         assert_eq!(
             breakpoint.get_account_by_id(acc1()),
@@ -1039,13 +1240,13 @@ mod tests {
         let is_first_set = dbio.get_meta_is_first_block_set().unwrap();
         let last_br_id = dbio.get_meta_last_breakpoint_id().unwrap();
         let last_block = dbio.get_block(last_id).unwrap();
-        let breakpoint = dbio.get_breakpoint(0).unwrap();
+        let breakpoint = dbio.get_breakpoint(1).unwrap();
         let final_state = dbio.final_state().unwrap();
 
         assert_eq!(last_id, 2);
         assert_eq!(first_id, 1);
         assert!(is_first_set);
-        assert_eq!(last_br_id, 0);
+        assert_eq!(last_br_id, 1);
         assert_ne!(last_block.header.hash, genesis_block().header.hash);
         assert_eq!(
             breakpoint.get_account_by_id(acc1()).balance
@@ -1067,7 +1268,7 @@ mod tests {
         let dbio = RocksDBIO::open_or_create(temdir_path, Some((genesis_block(), initial_state())))
             .unwrap();
 
-        for i in 1..BREAKPOINT_INTERVAL {
+        for i in 1..100 {
             let last_id = dbio.get_meta_last_block_in_db().unwrap();
             let last_block = dbio.get_block(last_id).unwrap();
 
@@ -1078,37 +1279,96 @@ mod tests {
             dbio.put_block(block, [i as u8; 32]).unwrap();
         }
 
+        dbio.put_breakpoint(101, &dbio.final_state().unwrap())
+            .unwrap();
+
+        let last_block = dbio.get_block(100).unwrap();
+        let transfer_tx = transfer(1, 99, true);
+        let block = common::test_utils::produce_dummy_block(
+            101,
+            Some(last_block.header.hash),
+            vec![transfer_tx],
+        );
+        dbio.put_block(block, [100; 32]).unwrap();
+
         let last_id = dbio.get_meta_last_block_in_db().unwrap();
-        let first_id = dbio.get_meta_first_block_in_db().unwrap();
-        let is_first_set = dbio.get_meta_is_first_block_set().unwrap();
         let last_br_id = dbio.get_meta_last_breakpoint_id().unwrap();
-        let last_block = dbio.get_block(last_id).unwrap();
-        let prev_breakpoint = dbio.get_breakpoint(0).unwrap();
-        let breakpoint = dbio.get_breakpoint(1).unwrap();
+        let prev_breakpoint = dbio.get_breakpoint(1).unwrap();
+        let breakpoint = dbio.get_breakpoint(101).unwrap();
         let final_state = dbio.final_state().unwrap();
 
-        assert_eq!(last_id, 100);
-        assert_eq!(first_id, 1);
-        assert!(is_first_set);
-        assert_eq!(last_br_id, 1);
-        assert_ne!(last_block.header.hash, genesis_block().header.hash);
+        assert_eq!(last_id, 101);
+        assert_eq!(last_br_id, 101);
+        assert_eq!(dbio.closest_breakpoint(99).unwrap(), 1);
+        assert_eq!(dbio.closest_breakpoint(100).unwrap(), 101);
+        assert_eq!(dbio.closest_breakpoint(101).unwrap(), 101);
         assert_eq!(
             prev_breakpoint.get_account_by_id(acc1()).balance
-                - final_state.get_account_by_id(acc1()).balance,
+                - breakpoint.get_account_by_id(acc1()).balance,
             99
         );
+        assert_eq!(
+            prev_breakpoint.get_account_by_id(acc1()).balance
+                - final_state.get_account_by_id(acc1()).balance,
+            100
+        );
         assert_eq!(
             final_state.get_account_by_id(acc2()).balance
                 - prev_breakpoint.get_account_by_id(acc2()).balance,
-            99
+            100
         );
+    }
+
+    #[test]
+    fn test_arbitrary_genesis_id() {
+        let temp_dir = tempdir().unwrap();
+        let temdir_path = temp_dir.path();
+
+        let genesis_block = common::test_utils::produce_dummy_block(1000, None, vec![]);
+        let prev_hash = genesis_block.header.hash;
+        let dbio =
+            RocksDBIO::open_or_create(temdir_path, Some((genesis_block, initial_state()))).unwrap();
+
+        let transfer_tx = transfer(1, 0, true);
+        let block =
+            common::test_utils::produce_dummy_block(1001, Some(prev_hash), vec![transfer_tx]);
+        dbio.put_block(block, [1; 32]).unwrap();
+
+        let final_state = dbio.final_state().unwrap();
+
+        assert_eq!(dbio.get_meta_last_breakpoint_id().unwrap(), 1000);
+        assert_eq!(dbio.closest_breakpoint(1001).unwrap(), 1000);
+        assert_eq!(final_state.get_account_by_id(acc1()).balance, 9999);
+        assert!(dbio.calculate_state_for_id(1002).is_err());
+    }
+
+    #[test]
+    fn test_final_accounts() {
+        let temp_dir = tempdir().unwrap();
+        let temdir_path = temp_dir.path();
+
+        let dbio = RocksDBIO::open_or_create(temdir_path, Some((genesis_block(), initial_state())))
+            .unwrap();
+
         assert_eq!(
-            breakpoint.get_account_by_id(acc1()),
-            final_state.get_account_by_id(acc1())
+            dbio.get_final_account(&acc1()).unwrap(),
+            Some(initial_state().get_account_by_id(acc1()))
         );
+
+        let mut state = dbio.final_state().unwrap();
+        transfer(1, 0, true)
+            .execute_check_on_state(&mut state)
+            .unwrap();
+        dbio.put_final_accounts(&[(acc2(), state.get_account_by_id(acc2()))])
+            .unwrap();
+
         assert_eq!(
-            breakpoint.get_account_by_id(acc2()),
-            final_state.get_account_by_id(acc2())
+            dbio.get_final_account(&acc2()).unwrap().unwrap().balance,
+            20001
+        );
+        assert_eq!(
+            dbio.get_final_account(&AccountId::new([7; 32])).unwrap(),
+            None
         );
     }
 
@@ -1320,6 +1580,38 @@ mod tests {
         let acc1_tx_limited_hashes: Vec<[u8; 32]> =
             acc1_tx_limited.into_iter().map(|tx| tx.hash().0).collect();
 
-        assert_eq!(acc1_tx_limited_hashes.as_slice(), &tx_hash_res[1..])
+        assert_eq!(acc1_tx_limited_hashes.as_slice(), &tx_hash_res[1..]);
+
+        let acc1_tx_past_end = dbio.get_acc_transactions(*acc1().value(), 4, 4).unwrap();
+
+        assert!(acc1_tx_past_end.is_empty());
+    }
+
+    #[test]
+    fn test_transactions_by_hashes() {
+        let temp_dir = tempdir().unwrap();
+        let temdir_path = temp_dir.path();
+
+        let dbio = RocksDBIO::open_or_create(temdir_path, Some((genesis_block(), initial_state())))
+            .unwrap();
+
+        let transfer_tx1 = transfer(1, 0, true);
+        let transfer_tx2 = transfer(1, 0, false);
+        let tx_hashes = [transfer_tx2.hash().0, transfer_tx1.hash().0];
+
+        let block = common::test_utils::produce_dummy_block(
+            2,
+            Some(genesis_block().header.hash),
+            vec![transfer_tx1, transfer_tx2],
+        );
+        dbio.put_block(block, [1; 32]).unwrap();
+
+        let transactions = dbio.get_transactions_by_hashes(&tx_hashes).unwrap();
+        let transaction_hashes: Vec<[u8; 32]> =
+            transactions.into_iter().map(|tx| tx.hash().0).collect();
+
+        assert_eq!(transaction_hashes, tx_hashes);
+        assert_eq!(dbio.get_block_id_by_tx_hash(tx_hashes[0]).unwrap(), 2);
+        assert!(dbio.get_transactions_by_hashes(&[[7; 32]]).is_err());
     }
 }
@@ -1,7 +1,11 @@
 use std::{path::Path, sync::Arc};
 
-use common::block::{BedrockStatus, Block, BlockMeta, MantleMsgId};
-use nssa::V02State;
+use common::{
+    HashType,
+    block::{BedrockStatus, Block, BlockMeta, MantleMsgId},
+    metrics::DB_WRITE_SECONDS,
+};
+use nssa::{StateDiff, V02State};
 use rocksdb::{
     BoundColumnFamily, ColumnFamilyDescriptor, DBWithThreadMode, MultiThreaded, Options, WriteBatch,
 };
@@ -20,6 +24,12 @@ pub const BUFF_SIZE_ROCKSDB: usize = usize::MAX;
 /// Keeping small to not run out of memory
 pub const CACHE_SIZE: usize = 1000;
 
+/// Number of stored blocks rewritten per write batch when migrating a legacy DB
+///
+/// Keeps the memory of a migration bounded; every batch is idempotent, so an interrupted
+/// migration restarts from the beginning.
+pub const LEGACY_MIGRATION_BATCH_BLOCKS: usize = 1024;
+
 /// Key base for storing metainformation about id of first block in db
 pub const DB_META_FIRST_BLOCK_IN_DB_KEY: &str = "first_block_in_db";
 /// Key base for storing metainformation about id of last current block in db
@@ -31,7 +41,16 @@ pub const DB_META_LAST_FINALIZED_BLOCK_ID: &str = "last_finalized_block_id";
 /// Key base for storing metainformation about the latest block meta
 pub const DB_META_LATEST_BLOCK_META_KEY: &str = "latest_block_meta";
 
+/// Key base for storing metainformation which describe if the NSSA state column families are set
+pub const DB_META_NSSA_STATE_SET_KEY: &str = "nssa_state_set";
+
+/// Key base for storing metainformation which describe if the tx hash column family is set
+pub const DB_META_TX_HASH_INDEX_SET_KEY: &str = "tx_hash_index_set";
+
 /// Key base for storing the NSSA state
+///
+/// Legacy layout, storing the whole state as one value. Migrated to the state column families on
+/// open.
 pub const DB_NSSA_STATE_KEY: &str = "nssa_state";
 
 /// Name of block column family
@@ -40,7 +59,18 @@ pub const CF_BLOCK_NAME: &str = "cf_block";
 pub const CF_META_NAME: &str = "cf_meta";
 /// Name of state column family
 pub const CF_NSSA_STATE_NAME: &str = "cf_nssa_state";
-
+/// Name of public accounts column family
+pub const CF_ACCOUNTS_NAME: &str = "cf_accounts";
+/// Name of commitments column family
+pub const CF_COMMITMENTS_NAME: &str = "cf_commitments";
+/// Name of commitment set digests (root history) column family, keyed by position
+pub const CF_ROOT_HISTORY_NAME: &str = "cf_root_history";
+/// Name of nullifiers column family
+pub const CF_NULLIFIERS_NAME: &str = "cf_nullifiers";
+/// Name of programs column family
+pub const CF_PROGRAMS_NAME: &str = "cf_programs";
+/// Name of tx hash to block id map column family
+pub const CF_TX_HASH_TO_ID_NAME: &str = "cf_tx_hash_to_id";
 pub type DbResult<T> = Result<T, DbError>;
 
 pub struct RocksDBIO {
@@ -58,6 +88,12 @@ impl RocksDBIO {
         let cfb = ColumnFamilyDescriptor::new(CF_BLOCK_NAME, cf_opts.clone());
         let cfmeta = ColumnFamilyDescriptor::new(CF_META_NAME, cf_opts.clone());
         let cfstate = ColumnFamilyDescriptor::new(CF_NSSA_STATE_NAME, cf_opts.clone());
+        let cfaccounts = ColumnFamilyDescriptor::new(CF_ACCOUNTS_NAME, cf_opts.clone());
+        let cfcommitments = ColumnFamilyDescriptor::new(CF_COMMITMENTS_NAME, cf_opts.clone());
+        let cfroots = ColumnFamilyDescriptor::new(CF_ROOT_HISTORY_NAME, cf_opts.clone());
+        let cfnullifiers = ColumnFamilyDescriptor::new(CF_NULLIFIERS_NAME, cf_opts.clone());
+        let cfprograms = ColumnFamilyDescriptor::new(CF_PROGRAMS_NAME, cf_opts.clone());
+        let cftxhash = ColumnFamilyDescriptor::new(CF_TX_HASH_TO_ID_NAME, cf_opts.clone());
 
         let mut db_opts = Options::default();
         db_opts.create_missing_column_families(true);
@@ -65,7 +101,17 @@ impl RocksDBIO {
         let db = DBWithThreadMode::<MultiThreaded>::open_cf_descriptors(
             &db_opts,
             path,
-            vec![cfb, cfmeta, cfstate],
+            vec![
+                cfb,
+                cfmeta,
+                cfstate,
+                cfaccounts,
+                cfcommitments,
+                cfroots,
+                cfnullifiers,
+                cfprograms,
+                cftxhash,
+            ],
         );
 
         let dbio = Self {
@@ -76,11 +122,14 @@ impl RocksDBIO {
         let is_start_set = dbio.get_meta_is_first_block_set()?;
 
         if is_start_set {
+            dbio.migrate_legacy_nssa_state()?;
+            dbio.index_legacy_transactions()?;
             Ok(dbio)
         } else if let Some((block, msg_id)) = start_block {
             let block_id = block.header.block_id;
             dbio.put_meta_first_block_in_db(block, msg_id)?;
             dbio.put_meta_is_first_block_set()?;
+            dbio.put_meta_is_tx_hash_index_set()?;
             dbio.put_meta_last_block_in_db(block_id)?;
             dbio.put_meta_last_finalized_block_id(None)?;
             dbio.put_meta_latest_block_meta(&BlockMeta {
@@ -103,6 +152,12 @@ impl RocksDBIO {
         let _cfb = ColumnFamilyDescriptor::new(CF_BLOCK_NAME, cf_opts.clone());
         let _cfmeta = ColumnFamilyDescriptor::new(CF_META_NAME, cf_opts.clone());
         let _cfstate = ColumnFamilyDescriptor::new(CF_NSSA_STATE_NAME, cf_opts.clone());
+        let _cfaccounts = ColumnFamilyDescriptor::new(CF_ACCOUNTS_NAME, cf_opts.clone());
+        let _cfcommitments = ColumnFamilyDescriptor::new(CF_COMMITMENTS_NAME, cf_opts.clone());
+        let _cfroots = ColumnFamilyDescriptor::new(CF_ROOT_HISTORY_NAME, cf_opts.clone());
+        let _cfnullifiers = ColumnFamilyDescriptor::new(CF_NULLIFIERS_NAME, cf_opts.clone());
+        let _cfprograms = ColumnFamilyDescriptor::new(CF_PROGRAMS_NAME, cf_opts.clone());
+        let _cftxhash = ColumnFamilyDescriptor::new(CF_TX_HASH_TO_ID_NAME, cf_opts.clone());
 
         let mut db_opts = Options::default();
         db_opts.create_missing_column_families(true);
@@ -123,6 +178,30 @@ impl RocksDBIO {
         self.db.cf_handle(CF_NSSA_STATE_NAME).unwrap()
     }
 
+    pub fn accounts_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_ACCOUNTS_NAME).unwrap()
+    }
+
+    pub fn commitments_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_COMMITMENTS_NAME).unwrap()
+    }
+
+    pub fn root_history_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_ROOT_HISTORY_NAME).unwrap()
+    }
+
+    pub fn nullifiers_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_NULLIFIERS_NAME).unwrap()
+    }
+
+    pub fn programs_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_PROGRAMS_NAME).unwrap()
+    }
+
+    pub fn tx_hash_to_id_column(&self) -> Arc<BoundColumnFamily<'_>> {
+        self.db.cf_handle(CF_TX_HASH_TO_ID_NAME).unwrap()
+    }
+
     pub fn get_meta_first_block_in_db(&self) -> DbResult<u64> {
         let cf_meta = self.meta_column();
         let res = self
@@ -199,24 +278,267 @@ impl RocksDBIO {
         Ok(res.is_some())
     }
 
-    pub fn put_nssa_state_in_db(&self, state: &V02State, batch: &mut WriteBatch) -> DbResult<()> {
-        let cf_nssa_state = self.nssa_state_column();
+    /// Put the changes of a [`StateDiff`] into the state column families.
+    pub fn put_nssa_state_diff_in_db(
+        &self,
+        diff: &StateDiff,
+        batch: &mut WriteBatch,
+    ) -> DbResult<()> {
+        let cf_accounts = self.accounts_column();
+        for (account_id, account) in &diff.accounts {
+            batch.put_cf(
+                &cf_accounts,
+                borsh::to_vec(account_id).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize account id".to_string()),
+                    )
+                })?,
+                borsh::to_vec(account).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize account".to_string()),
+                    )
+                })?,
+            );
+        }
+
+        let cf_commitments = self.commitments_column();
+        for (index, commitment) in &diff.commitments {
+            // Big endian keys keep commitments in Merkle tree order when iterating
+            batch.put_cf(
+                &cf_commitments,
+                (*index as u64).to_be_bytes(),
+                borsh::to_vec(commitment).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize commitment".to_string()),
+                    )
+                })?,
+            );
+        }
+
+        let cf_roots = self.root_history_column();
+        for (position, digest) in &diff.commitment_set_digests {
+            // Big endian keys keep digests in root history order when iterating
+            batch.put_cf(&cf_roots, position.to_be_bytes(), digest);
+        }
+        // Digests that fell out of the validity window
+        if diff.root_history_start > 0 {
+            batch.delete_range_cf(
+                &cf_roots,
+                0u64.to_be_bytes(),
+                diff.root_history_start.to_be_bytes(),
+            );
+        }
+
+        let cf_nullifiers = self.nullifiers_column();
+        for nullifier in &diff.nullifiers {
+            batch.put_cf(
+                &cf_nullifiers,
+                borsh::to_vec(nullifier).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize nullifier".to_string()),
+                    )
+                })?,
+                b"",
+            );
+        }
+
+        let cf_programs = self.programs_column();
+        for program in &diff.programs {
+            batch.put_cf(
+                &cf_programs,
+                borsh::to_vec(&program.id()).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize program id".to_string()),
+                    )
+                })?,
+                borsh::to_vec(program).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize program".to_string()),
+                    )
+                })?,
+            );
+        }
+
+        let cf_meta = self.meta_column();
         batch.put_cf(
-            &cf_nssa_state,
+            &cf_meta,
+            borsh::to_vec(&DB_META_NSSA_STATE_SET_KEY).map_err(|err| {
+                DbError::borsh_cast_message(
+                    err,
+                    Some("Failed to serialize DB_META_NSSA_STATE_SET_KEY".to_string()),
+                )
+            })?,
+            [1u8; 1],
+        );
+
+        Ok(())
+    }
+
+    pub fn get_meta_is_nssa_state_set(&self) -> DbResult<bool> {
+        let cf_meta = self.meta_column();
+        let res = self
+            .db
+            .get_cf(
+                &cf_meta,
+                borsh::to_vec(&DB_META_NSSA_STATE_SET_KEY).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize DB_META_NSSA_STATE_SET_KEY".to_string()),
+                    )
+                })?,
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        Ok(res.is_some())
+    }
+
+    /// Move a state stored with the legacy single value layout into the state column families.
+    fn migrate_legacy_nssa_state(&self) -> DbResult<()> {
+        let Some(state) = self.get_legacy_nssa_state()? else {
+            return Ok(());
+        };
+
+        let mut batch = WriteBatch::default();
+        self.put_nssa_state_diff_in_db(&state.state_diff(), &mut batch)?;
+        batch.delete_cf(
+            &self.nssa_state_column(),
             borsh::to_vec(&DB_NSSA_STATE_KEY).map_err(|err| {
                 DbError::borsh_cast_message(
                     err,
                     Some("Failed to serialize DB_NSSA_STATE_KEY".to_string()),
                 )
             })?,
-            borsh::to_vec(state).map_err(|err| {
-                DbError::borsh_cast_message(err, Some("Failed to serialize NSSA state".to_string()))
-            })?,
         );
+        self.db.write(batch).map_err(|rerr| {
+            DbError::rocksdb_cast_message(rerr, Some("Failed to migrate NSSA state".to_string()))
+        })
+    }
+
+    fn get_legacy_nssa_state(&self) -> DbResult<Option<V02State>> {
+        let cf_nssa_state = self.nssa_state_column();
+        let res = self
+            .db
+            .get_cf(
+                &cf_nssa_state,
+                borsh::to_vec(&DB_NSSA_STATE_KEY).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize DB_NSSA_STATE_KEY".to_string()),
+                    )
+                })?,
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        res.map(|data| {
+            borsh::from_slice::<V02State>(&data).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize NSSA state".to_string()),
+                )
+            })
+        })
+        .transpose()
+    }
 
+    pub fn put_meta_is_tx_hash_index_set(&self) -> DbResult<()> {
+        let cf_meta = self.meta_column();
+        self.db
+            .put_cf(
+                &cf_meta,
+                borsh::to_vec(&DB_META_TX_HASH_INDEX_SET_KEY).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize DB_META_TX_HASH_INDEX_SET_KEY".to_string()),
+                    )
+                })?,
+                [1u8; 1],
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
         Ok(())
     }
 
+    pub fn get_meta_is_tx_hash_index_set(&self) -> DbResult<bool> {
+        let cf_meta = self.meta_column();
+        let res = self
+            .db
+            .get_cf(
+                &cf_meta,
+                borsh::to_vec(&DB_META_TX_HASH_INDEX_SET_KEY).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize DB_META_TX_HASH_INDEX_SET_KEY".to_string()),
+                    )
+                })?,
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        Ok(res.is_some())
+    }
+
+    /// Build the tx hash column family from stored blocks of a DB created before it existed.
+    fn index_legacy_transactions(&self) -> DbResult<()> {
+        if self.get_meta_is_tx_hash_index_set()? {
+            return Ok(());
+        }
+
+        self.rewrite_stored_blocks("Failed to index transactions", |block, batch| {
+            self.put_block_transactions(block, batch)
+        })?;
+
+        self.put_meta_is_tx_hash_index_set()
+    }
+
+    /// Write what `put` derives from every stored block, in batches of
+    /// [`LEGACY_MIGRATION_BATCH_BLOCKS`] blocks.
+    fn rewrite_stored_blocks(
+        &self,
+        error_message: &str,
+        put: impl Fn(&Block, &mut WriteBatch) -> DbResult<()>,
+    ) -> DbResult<()> {
+        let mut batch = WriteBatch::default();
+        let mut blocks_in_batch = 0;
+        for block in self.get_all_blocks() {
+            put(&block?, &mut batch)?;
+            blocks_in_batch += 1;
+
+            if blocks_in_batch == LEGACY_MIGRATION_BATCH_BLOCKS {
+                self.db.write(std::mem::take(&mut batch)).map_err(|rerr| {
+                    DbError::rocksdb_cast_message(rerr, Some(error_message.to_string()))
+                })?;
+                blocks_in_batch = 0;
+            }
+        }
+        self.db
+            .write(batch)
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, Some(error_message.to_string())))
+    }
+
+    /// Iterate over all values of a column family, decoding keys and values with `decode`.
+    fn collect_column<T>(
+        &self,
+        cf: &Arc<BoundColumnFamily<'_>>,
+        decode: impl Fn(&[u8], &[u8]) -> DbResult<T>,
+    ) -> DbResult<Vec<T>> {
+        self.db
+            .iterator_cf(cf, rocksdb::IteratorMode::Start)
+            .map(|res| {
+                let (key, value) = res.map_err(|rerr| {
+                    DbError::rocksdb_cast_message(
+                        rerr,
+                        Some("Failed to get key value pair".to_string()),
+                    )
+                })?;
+                decode(&key, &value)
+            })
+            .collect()
+    }
+
     pub fn put_meta_first_block_in_db(&self, block: &Block, msg_id: MantleMsgId) -> DbResult<()> {
         let cf_meta = self.meta_column();
         self.db
@@ -443,9 +765,56 @@ impl RocksDBIO {
                 DbError::borsh_cast_message(err, Some("Failed to serialize block data".to_string()))
             })?,
         );
+        self.put_block_transactions(block, batch)
+    }
+
+    fn put_block_transactions(&self, block: &Block, batch: &mut WriteBatch) -> DbResult<()> {
+        let cf_tx_hash = self.tx_hash_to_id_column();
+        let block_id = borsh::to_vec(&block.header.block_id).map_err(|err| {
+            DbError::borsh_cast_message(err, Some("Failed to serialize block id".to_string()))
+        })?;
+
+        for transaction in &block.body.transactions {
+            batch.put_cf(
+                &cf_tx_hash,
+                borsh::to_vec(&transaction.hash()).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize tx hash".to_string()),
+                    )
+                })?,
+                &block_id,
+            );
+        }
         Ok(())
     }
 
+    pub fn get_block_id_by_tx_hash(&self, tx_hash: HashType) -> DbResult<Option<u64>> {
+        let cf_tx_hash = self.tx_hash_to_id_column();
+        let res = self
+            .db
+            .get_cf(
+                &cf_tx_hash,
+                borsh::to_vec(&tx_hash).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize tx hash".to_string()),
+                    )
+                })?,
+            )
+            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+
+        res.map(|data| {
+            borsh::from_slice::<u64>(&data).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize block id".to_string()),
+                )
+            })
+        })
+        .transpose()
+    }
+
     pub fn get_block(&self, block_id: u64) -> DbResult<Block> {
         let cf_block = self.block_column();
         let res = self
@@ -475,54 +844,142 @@ impl RocksDBIO {
         }
     }
 
-    pub fn get_nssa_state(&self) -> DbResult<V02State> {
-        let cf_nssa_state = self.nssa_state_column();
-        let res = self
-            .db
-            .get_cf(
-                &cf_nssa_state,
-                borsh::to_vec(&DB_NSSA_STATE_KEY).map_err(|err| {
+    /// Blocks `start_block_id..=end_block_id`, read in one multi get.
+    ///
+    /// Fails if any block of the range is missing.
+    pub fn get_block_range(&self, start_block_id: u64, end_block_id: u64) -> DbResult<Vec<Block>> {
+        let cf_block = self.block_column();
+        let block_keys = (start_block_id..=end_block_id)
+            .map(|block_id| {
+                borsh::to_vec(&block_id).map_err(|err| {
                     DbError::borsh_cast_message(
                         err,
                         Some("Failed to serialize block id".to_string()),
                     )
-                })?,
+                })
+            })
+            .collect::<DbResult<Vec<_>>>()?;
+
+        (start_block_id..=end_block_id)
+            .zip(
+                self.db
+                    .multi_get_cf(block_keys.iter().map(|key| (&cf_block, key))),
             )
-            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
+            .map(|(block_id, res)| {
+                let data = res
+                    .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?
+                    .ok_or_else(|| {
+                        DbError::db_interaction_error(format!("Block {block_id} not found"))
+                    })?;
+                borsh::from_slice::<Block>(&data).map_err(|serr| {
+                    DbError::borsh_cast_message(
+                        serr,
+                        Some("Failed to deserialize block data".to_string()),
+                    )
+                })
+            })
+            .collect()
+    }
 
-        if let Some(data) = res {
-            Ok(borsh::from_slice::<V02State>(&data).map_err(|serr| {
+    /// Rebuild the NSSA state from the state column families.
+    pub fn get_nssa_state(&self) -> DbResult<V02State> {
+        if !self.get_meta_is_nssa_state_set()? {
+            return Err(DbError::db_interaction_error(
+                "NSSA state not found".to_string(),
+            ));
+        }
+
+        let accounts = self.collect_column(&self.accounts_column(), |key, value| {
+            let account_id = borsh::from_slice(key).map_err(|serr| {
                 DbError::borsh_cast_message(
                     serr,
-                    Some("Failed to deserialize block data".to_string()),
+                    Some("Failed to deserialize account id".to_string()),
                 )
-            })?)
-        } else {
-            Err(DbError::db_interaction_error(
-                "Block on this id not found".to_string(),
-            ))
-        }
+            })?;
+            let account = borsh::from_slice(value).map_err(|serr| {
+                DbError::borsh_cast_message(serr, Some("Failed to deserialize account".to_string()))
+            })?;
+            Ok((account_id, account))
+        })?;
+
+        let commitments = self.collect_column(&self.commitments_column(), |key, value| {
+            let index = u64::from_be_bytes(<[u8; 8]>::try_from(key).map_err(|_| {
+                DbError::db_interaction_error("Invalid commitment index".to_string())
+            })?);
+            let commitment = borsh::from_slice(value).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize commitment".to_string()),
+                )
+            })?;
+            Ok((index as usize, commitment))
+        })?;
+
+        let commitment_set_digests =
+            self.collect_column(&self.root_history_column(), |key, value| {
+                let position = u64::from_be_bytes(<[u8; 8]>::try_from(key).map_err(|_| {
+                    DbError::db_interaction_error("Invalid root history position".to_string())
+                })?);
+                let digest = <[u8; 32]>::try_from(value).map_err(|_| {
+                    DbError::db_interaction_error("Invalid commitment set digest".to_string())
+                })?;
+                Ok((position, digest))
+            })?;
+        let root_history_start = commitment_set_digests
+            .first()
+            .map(|(position, _)| *position)
+            .unwrap_or(0);
+
+        let nullifiers = self.collect_column(&self.nullifiers_column(), |key, _| {
+            borsh::from_slice(key).map_err(|serr| {
+                DbError::borsh_cast_message(
+                    serr,
+                    Some("Failed to deserialize nullifier".to_string()),
+                )
+            })
+        })?;
+
+        let programs = self.collect_column(&self.programs_column(), |_, value| {
+            borsh::from_slice(value).map_err(|serr| {
+                DbError::borsh_cast_message(serr, Some("Failed to deserialize program".to_string()))
+            })
+        })?;
+
+        Ok(V02State::from_state_diff(StateDiff {
+            accounts,
+            commitments,
+            commitment_set_digests,
+            root_history_start,
+            nullifiers,
+            programs,
+        }))
     }
 
     pub fn delete_block(&self, block_id: u64) -> DbResult<()> {
         let cf_block = self.block_column();
+        let cf_tx_hash = self.tx_hash_to_id_column();
         let key = borsh::to_vec(&block_id).map_err(|err| {
             DbError::borsh_cast_message(err, Some("Failed to serialize block id".to_string()))
         })?;
 
-        if self
-            .db
-            .get_cf(&cf_block, &key)
-            .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?
-            .is_none()
-        {
-            return Err(DbError::db_interaction_error(
-                "Block on this id not found".to_string(),
-            ));
+        let block = self.get_block(block_id)?;
+
+        let mut batch = WriteBatch::default();
+        batch.delete_cf(&cf_block, key);
+        for transaction in &block.body.transactions {
+            batch.delete_cf(
+                &cf_tx_hash,
+                borsh::to_vec(&transaction.hash()).map_err(|err| {
+                    DbError::borsh_cast_message(
+                        err,
+                        Some("Failed to serialize tx hash".to_string()),
+                    )
+                })?,
+            );
         }
 
         self.db
-            .delete_cf(&cf_block, key)
+            .write(batch)
             .map_err(|rerr| DbError::rocksdb_cast_message(rerr, None))?;
 
         Ok(())
@@ -580,16 +1037,21 @@ impl RocksDBIO {
             })
     }
 
+    /// Store `block` together with the state changes it produced.
     pub fn atomic_update(
         &self,
         block: &Block,
         msg_id: MantleMsgId,
-        state: &V02State,
+        state_diff: &StateDiff,
     ) -> DbResult<()> {
+        let _timer = DB_WRITE_SECONDS
+            .with_label_values(&["sequencer"])
+            .start_timer();
+
         let block_id = block.header.block_id;
         let mut batch = WriteBatch::default();
         self.put_block(block, msg_id, false, &mut batch)?;
-        self.put_nssa_state_in_db(state, &mut batch)?;
+        self.put_nssa_state_diff_in_db(state_diff, &mut batch)?;
         self.db.write(batch).map_err(|rerr| {
             DbError::rocksdb_cast_message(
                 rerr,
@@ -0,0 +1,119 @@
+/*
+ * Per-call overhead of the wallet FFI, measured from C.
+ *
+ * Only calls served from local wallet state are measured, so no sequencer is needed and the
+ * numbers reflect the cost of crossing the FFI boundary, locking the wallet and converting
+ * arguments and results.
+ *
+ * Build and run from the repository root:
+ *
+ *   cargo build --release -p wallet-ffi
+ *   cc -O2 -I wallet-ffi wallet-ffi/benches/ffi_overhead.c \
+ *      -L target/release -lwallet_ffi -o target/release/ffi_overhead
+ *   LD_LIBRARY_PATH=target/release target/release/ffi_overhead /tmp/ffi_bench 100000
+ *
+ * The first argument is an empty directory for the wallet config and storage, the second the
+ * number of calls per measured function.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "wallet_ffi.h"
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double elapsed_ns, long iterations) {
+  printf("%-40s %10.1f ns/call\n", name, elapsed_ns / (double)iterations);
+}
+
+static int check(enum WalletFfiError error, const char *call) {
+  if (error != SUCCESS) {
+    fprintf(stderr, "%s failed with error %d\n", call, (int)error);
+    return 0;
+  }
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <work dir> <iterations>\n", argv[0]);
+    return 1;
+  }
+
+  long iterations = atol(argv[2]);
+  if (iterations <= 0) {
+    fprintf(stderr, "Iterations must be positive\n");
+    return 1;
+  }
+
+  char config_path[4096];
+  char storage_path[4096];
+  snprintf(config_path, sizeof config_path, "%s/wallet_config.json", argv[1]);
+  snprintf(storage_path, sizeof storage_path, "%s/storage.json", argv[1]);
+
+  struct WalletHandle *handle = wallet_ffi_create_new(config_path, storage_path, "password");
+  if (handle == NULL) {
+    fprintf(stderr, "Failed to create wallet in %s\n", argv[1]);
+    return 1;
+  }
+
+  struct FfiBytes32 account_id;
+  if (!check(wallet_ffi_create_account_public(handle, &account_id),
+             "wallet_ffi_create_account_public")) {
+    wallet_ffi_destroy(handle);
+    return 1;
+  }
+
+  double start;
+  int ok = 1;
+
+  uint64_t block_id;
+  start = now_ns();
+  for (long i = 0; i < iterations && ok; i++) {
+    ok = check(wallet_ffi_get_last_synced_block(handle, &block_id),
+               "wallet_ffi_get_last_synced_block");
+  }
+  report("wallet_ffi_get_last_synced_block", now_ns() - start, iterations);
+
+  struct FfiWalletStats stats;
+  start = now_ns();
+  for (long i = 0; i < iterations && ok; i++) {
+    ok = check(wallet_ffi_get_stats(handle, &stats), "wallet_ffi_get_stats");
+  }
+  report("wallet_ffi_get_stats", now_ns() - start, iterations);
+
+  struct FfiPublicAccountKey public_key;
+  start = now_ns();
+  for (long i = 0; i < iterations && ok; i++) {
+    ok = check(wallet_ffi_get_public_account_key(handle, &account_id, &public_key),
+               "wallet_ffi_get_public_account_key");
+  }
+  report("wallet_ffi_get_public_account_key", now_ns() - start, iterations);
+
+  struct FfiAccountList list;
+  start = now_ns();
+  for (long i = 0; i < iterations && ok; i++) {
+    ok = check(wallet_ffi_list_accounts(handle, &list), "wallet_ffi_list_accounts");
+    if (ok) {
+      wallet_ffi_free_account_list(&list);
+    }
+  }
+  report("wallet_ffi_list_accounts + free", now_ns() - start, iterations);
+
+  start = now_ns();
+  for (long i = 0; i < iterations && ok; i++) {
+    char *addr = wallet_ffi_get_sequencer_addr(handle);
+    ok = addr != NULL;
+    wallet_ffi_free_string(addr);
+  }
+  report("wallet_ffi_get_sequencer_addr + free", now_ns() - start, iterations);
+
+  wallet_ffi_destroy(handle);
+  return ok ? 0 : 1;
+}
@@ -7,7 +7,7 @@ use nssa::AccountId;
 use crate::{
     block_on,
     error::{print_error, WalletFfiError},
-    types::{FfiAccount, FfiAccountList, FfiAccountListEntry, FfiBytes32, WalletHandle},
+    types::{FfiAccount, FfiAccountList, FfiAccountListEntry, FfiBytes32, FfiU128, WalletHandle},
     wallet::get_wallet,
 };
 
@@ -42,7 +42,7 @@ pub unsafe extern "C" fn wallet_ffi_create_account_public(
         return WalletFfiError::NullPointer;
     }
 
-    let mut wallet = match wrapper.core.lock() {
+    let mut wallet = match wrapper.core.write() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -90,7 +90,7 @@ pub unsafe extern "C" fn wallet_ffi_create_account_private(
         return WalletFfiError::NullPointer;
     }
 
-    let mut wallet = match wrapper.core.lock() {
+    let mut wallet = match wrapper.core.write() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -140,7 +140,7 @@ pub unsafe extern "C" fn wallet_ffi_list_accounts(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -258,16 +258,13 @@ pub unsafe extern "C" fn wallet_ffi_get_balance(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let account_id = AccountId::new(unsafe { (*account_id).data });
+
+    let wallet = match wrapper.detach_accounts(&[account_id]) {
         Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+        Err(e) => return e,
     };
 
-    let account_id = AccountId::new(unsafe { (*account_id).data });
-
     let balance = if is_public {
         match block_on(wallet.get_account_balance(account_id)) {
             Ok(Ok(b)) => b,
@@ -328,12 +325,9 @@ pub unsafe extern "C" fn wallet_ffi_get_account_public(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.detach_accounts(&[]) {
         Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+        Err(e) => return e,
     };
 
     let account_id = AccountId::new(unsafe { (*account_id).data });
@@ -354,6 +348,175 @@ pub unsafe extern "C" fn wallet_ffi_get_account_public(
     WalletFfiError::Success
 }
 
+/// Get balances of several accounts at once.
+///
+/// For public accounts, all balances are fetched from the network with a single
+/// request. For private accounts, the locally cached balances are returned.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `account_ids`: Array of `count` account IDs (32 bytes each)
+/// - `count`: Number of accounts to query
+/// - `is_public`: Whether these are public accounts
+/// - `out_balances`: Output array of `count` balances, filled in the order of `account_ids`
+///
+/// # Returns
+/// - `Success` on successful query
+/// - Error code on failure, in which case `out_balances` is left untouched
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+/// - `account_ids` must be a valid pointer to `count` `FfiBytes32` structs
+/// - `out_balances` must be a valid pointer to `count` `FfiU128` structs
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_get_balances(
+    handle: *mut WalletHandle,
+    account_ids: *const FfiBytes32,
+    count: usize,
+    is_public: bool,
+    out_balances: *mut FfiU128,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    if count == 0 {
+        return WalletFfiError::Success;
+    }
+
+    if account_ids.is_null() || out_balances.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
+    }
+
+    let account_ids: Vec<AccountId> = unsafe { std::slice::from_raw_parts(account_ids, count) }
+        .iter()
+        .map(|id| AccountId::new(id.data))
+        .collect();
+
+    let wallet = match wrapper.detach_accounts(&account_ids) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    let balances: Vec<u128> = if is_public {
+        match block_on(wallet.get_accounts_public(account_ids)) {
+            Ok(Ok(accounts)) => accounts.into_iter().map(|acc| acc.balance).collect(),
+            Ok(Err(e)) => {
+                print_error(format!("Failed to get balances: {}", e));
+                return WalletFfiError::NetworkError;
+            }
+            Err(e) => return e,
+        }
+    } else {
+        let mut balances = Vec::with_capacity(count);
+        for account_id in account_ids {
+            match wallet.get_account_private(account_id) {
+                Some(account) => balances.push(account.balance),
+                None => {
+                    print_error(format!("Private account {account_id} not found"));
+                    return WalletFfiError::AccountNotFound;
+                }
+            }
+        }
+        balances
+    };
+
+    if balances.len() != count {
+        print_error(format!(
+            "Expected {count} balances, sequencer returned {}",
+            balances.len()
+        ));
+        return WalletFfiError::NetworkError;
+    }
+
+    let out_balances = unsafe { std::slice::from_raw_parts_mut(out_balances, count) };
+    for (out, balance) in out_balances.iter_mut().zip(balances) {
+        *out = balance.into();
+    }
+
+    WalletFfiError::Success
+}
+
+/// Get full public account data of several accounts from the network.
+///
+/// Accounts are fetched with one request per 4096 accounts.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `account_ids`: Array of `count` account IDs (32 bytes each)
+/// - `count`: Number of accounts to query
+/// - `out_accounts`: Output array of `count` accounts, filled in the order of `account_ids`
+///
+/// # Returns
+/// - `Success` on successful query
+/// - Error code on failure, in which case `out_accounts` is left untouched
+///
+/// # Memory
+/// Each returned account must be freed with `wallet_ffi_free_account_data()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+/// - `account_ids` must be a valid pointer to `count` `FfiBytes32` structs
+/// - `out_accounts` must be a valid pointer to `count` `FfiAccount` structs
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_get_accounts_public(
+    handle: *mut WalletHandle,
+    account_ids: *const FfiBytes32,
+    count: usize,
+    out_accounts: *mut FfiAccount,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    if count == 0 {
+        return WalletFfiError::Success;
+    }
+
+    if account_ids.is_null() || out_accounts.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
+    }
+
+    let account_ids: Vec<AccountId> = unsafe { std::slice::from_raw_parts(account_ids, count) }
+        .iter()
+        .map(|id| AccountId::new(id.data))
+        .collect();
+
+    let wallet = match wrapper.detach_accounts(&[]) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    let accounts = match block_on(wallet.get_accounts_public(account_ids)) {
+        Ok(Ok(accounts)) => accounts,
+        Ok(Err(e)) => {
+            print_error(format!("Failed to get accounts: {}", e));
+            return WalletFfiError::NetworkError;
+        }
+        Err(e) => return e,
+    };
+
+    if accounts.len() != count {
+        print_error(format!(
+            "Expected {count} accounts, sequencer returned {}",
+            accounts.len()
+        ));
+        return WalletFfiError::NetworkError;
+    }
+
+    for (i, account) in accounts.into_iter().enumerate() {
+        unsafe {
+            out_accounts.add(i).write(account.into());
+        }
+    }
+
+    WalletFfiError::Success
+}
+
 /// Get full private account data from the local storage.
 ///
 /// # Parameters
@@ -388,7 +551,7 @@ pub unsafe extern "C" fn wallet_ffi_get_account_private(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -413,7 +576,8 @@ pub unsafe extern "C" fn wallet_ffi_get_account_private(
 ///
 /// # Safety
 /// The account must be either null or a valid account returned by
-/// `wallet_ffi_get_account_public`.
+/// `wallet_ffi_get_account_public`, `wallet_ffi_get_accounts_public` or
+/// `wallet_ffi_get_account_private`.
 #[no_mangle]
 pub unsafe extern "C" fn wallet_ffi_free_account_data(account: *mut FfiAccount) {
     if account.is_null() {
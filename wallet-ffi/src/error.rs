@@ -40,6 +40,10 @@ pub enum WalletFfiError {
     InvalidTypeConversion = 15,
     /// Invalid Key value
     InvalidKeyValue = 16,
+    /// Background job has not finished yet
+    JobPending = 17,
+    /// Background job result was already collected
+    JobResultTaken = 18,
     /// Internal error (catch-all)
     InternalError = 99,
 }
@@ -0,0 +1,197 @@
+//! Background jobs for long-running wallet operations.
+//!
+//! The `*_async` variants of the transfer and sync functions return a job handle
+//! immediately and run the operation on the runtime's blocking thread pool, so the
+//! calling thread is not pinned for the duration of proving or syncing.
+//! Results are collected with `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()`.
+
+use std::{
+    ffi::CString,
+    ptr,
+    sync::{Arc, Condvar, Mutex},
+};
+
+use crate::{
+    error::{print_error, WalletFfiError},
+    get_runtime,
+    types::{FfiJobHandle, FfiTransferResult},
+};
+
+/// Outcome of a finished job: the raw transaction hash for transfers, `None` for sync.
+pub(crate) type JobOutput = Result<Option<Vec<u8>>, WalletFfiError>;
+
+enum JobState {
+    Running,
+    Finished(JobOutput),
+    Collected,
+}
+
+/// Shared state between a running job and its handle.
+pub(crate) struct Job {
+    state: Mutex<JobState>,
+    finished: Condvar,
+}
+
+impl Job {
+    fn finish(&self, output: JobOutput) {
+        let mut state = self.state.lock().unwrap_or_else(|e| e.into_inner());
+        *state = JobState::Finished(output);
+        self.finished.notify_all();
+    }
+}
+
+/// Spawn `task` on the runtime's blocking pool and return an opaque handle to it.
+pub(crate) fn spawn_job(
+    task: impl FnOnce() -> JobOutput + Send + 'static,
+) -> Result<*mut FfiJobHandle, WalletFfiError> {
+    let runtime = get_runtime()?;
+
+    let job = Arc::new(Job {
+        state: Mutex::new(JobState::Running),
+        finished: Condvar::new(),
+    });
+
+    let job_task = Arc::clone(&job);
+    runtime.spawn_blocking(move || job_task.finish(task()));
+
+    Ok(Box::into_raw(Box::new(job)) as *mut FfiJobHandle)
+}
+
+/// Spawn `task` and write the new job handle to `out_job`.
+pub(crate) fn submit_job(
+    out_job: *mut *mut FfiJobHandle,
+    task: impl FnOnce() -> JobOutput + Send + 'static,
+) -> WalletFfiError {
+    match spawn_job(task) {
+        Ok(job) => {
+            unsafe {
+                *out_job = job;
+            }
+            WalletFfiError::Success
+        }
+        Err(e) => e,
+    }
+}
+
+fn get_job(job: *mut FfiJobHandle) -> Result<&'static Arc<Job>, WalletFfiError> {
+    if job.is_null() {
+        print_error("Null job handle");
+        return Err(WalletFfiError::NullPointer);
+    }
+    Ok(unsafe { &*(job as *mut Arc<Job>) })
+}
+
+/// Take the output out of a finished job and write it to `out_result`.
+fn collect(state: &mut JobState, out_result: *mut FfiTransferResult) -> WalletFfiError {
+    let output = match std::mem::replace(state, JobState::Collected) {
+        JobState::Finished(output) => output,
+        JobState::Running => {
+            *state = JobState::Running;
+            return WalletFfiError::JobPending;
+        }
+        JobState::Collected => {
+            print_error("Job result was already collected");
+            return WalletFfiError::JobResultTaken;
+        }
+    };
+
+    let (error, tx_hash) = match output {
+        Ok(tx_hash) => (WalletFfiError::Success, tx_hash),
+        Err(e) => (e, None),
+    };
+
+    if !out_result.is_null() {
+        let tx_hash = tx_hash
+            .and_then(|hash| CString::new(hash).ok())
+            .map(|s| s.into_raw())
+            .unwrap_or(ptr::null_mut());
+
+        unsafe {
+            (*out_result).tx_hash = tx_hash;
+            (*out_result).success = error == WalletFfiError::Success;
+        }
+    }
+
+    error
+}
+
+/// Check whether a background job has finished.
+///
+/// # Parameters
+/// - `job`: Job handle returned by one of the `*_async` functions
+/// - `out_result`: Output pointer for the operation result, may be null for sync jobs
+///
+/// # Returns
+/// - `JobPending` if the job is still running (`out_result` is left untouched)
+/// - `JobResultTaken` if the result was already collected
+/// - Otherwise the error code the blocking variant of the operation would have returned
+///
+/// # Memory
+/// The result must be freed with `wallet_ffi_free_transfer_result()`.
+///
+/// # Safety
+/// - `job` must be a valid job handle that has not been freed
+/// - `out_result` must be null or a valid pointer to a `FfiTransferResult` struct
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_job_poll(
+    job: *mut FfiJobHandle,
+    out_result: *mut FfiTransferResult,
+) -> WalletFfiError {
+    let job = match get_job(job) {
+        Ok(j) => j,
+        Err(e) => return e,
+    };
+
+    let mut state = job.state.lock().unwrap_or_else(|e| e.into_inner());
+    collect(&mut state, out_result)
+}
+
+/// Block the calling thread until a background job has finished.
+///
+/// # Parameters
+/// - `job`: Job handle returned by one of the `*_async` functions
+/// - `out_result`: Output pointer for the operation result, may be null for sync jobs
+///
+/// # Returns
+/// - `JobResultTaken` if the result was already collected
+/// - Otherwise the error code the blocking variant of the operation would have returned
+///
+/// # Memory
+/// The result must be freed with `wallet_ffi_free_transfer_result()`.
+///
+/// # Safety
+/// - `job` must be a valid job handle that has not been freed
+/// - `out_result` must be null or a valid pointer to a `FfiTransferResult` struct
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_job_wait(
+    job: *mut FfiJobHandle,
+    out_result: *mut FfiTransferResult,
+) -> WalletFfiError {
+    let job = match get_job(job) {
+        Ok(j) => j,
+        Err(e) => return e,
+    };
+
+    let state = job.state.lock().unwrap_or_else(|e| e.into_inner());
+    let mut state = job
+        .finished
+        .wait_while(state, |state| matches!(state, JobState::Running))
+        .unwrap_or_else(|e| e.into_inner());
+    collect(&mut state, out_result)
+}
+
+/// Free a job handle.
+///
+/// If the job is still running it keeps running in the background and its
+/// result is discarded.
+///
+/// # Safety
+/// The job must be either null or a valid job handle that has not been freed.
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_free_job(job: *mut FfiJobHandle) {
+    if !job.is_null() {
+        unsafe {
+            drop(Box::from_raw(job as *mut Arc<Job>));
+        }
+    }
+}
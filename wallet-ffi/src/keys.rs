@@ -44,7 +44,7 @@ pub unsafe extern "C" fn wallet_ffi_get_public_account_key(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -109,7 +109,7 @@ pub unsafe extern "C" fn wallet_ffi_get_private_account_keys(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
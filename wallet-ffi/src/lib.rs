@@ -11,8 +11,10 @@
 //!
 //! # Thread Safety
 //!
-//! All functions are thread-safe. The wallet handle uses internal locking
-//! to ensure safe concurrent access.
+//! All functions are thread-safe. The wallet handle uses a reader/writer lock:
+//! queries and transfers run concurrently, while account creation and applying
+//! synced blocks take the lock exclusively for a short time. Block downloads
+//! during a sync happen without holding the lock.
 //!
 //! # Memory Management
 //!
@@ -22,6 +24,7 @@
 
 pub mod account;
 pub mod error;
+pub mod job;
 pub mod keys;
 pub mod pinata;
 pub mod sync;
@@ -60,18 +60,14 @@ pub unsafe extern "C" fn wallet_ffi_claim_pinata(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
-    };
-
     let pinata_id = AccountId::new(unsafe { (*pinata_account_id).data });
     let winner_id = AccountId::new(unsafe { (*winner_account_id).data });
     let solution = u128::from_le_bytes(unsafe { *solution });
 
+    let wallet = match wrapper.detach_accounts(&[pinata_id, winner_id]) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
     let pinata = Pinata(&wallet);
 
     match block_on(pinata.claim(pinata_id, winner_id, solution)) {
@@ -158,14 +154,6 @@ pub unsafe extern "C" fn wallet_ffi_claim_pinata_private_owned_already_initializ
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
-    };
-
     let pinata_id = AccountId::new(unsafe { (*pinata_account_id).data });
     let winner_id = AccountId::new(unsafe { (*winner_account_id).data });
     let solution = u128::from_le_bytes(unsafe { *solution });
@@ -177,6 +165,10 @@ pub unsafe extern "C" fn wallet_ffi_claim_pinata_private_owned_already_initializ
     };
     let proof: MembershipProof = (winner_proof_index, siblings);
 
+    let wallet = match wrapper.detach_accounts(&[pinata_id, winner_id]) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
     let pinata = Pinata(&wallet);
 
     match block_on(
@@ -256,18 +248,14 @@ pub unsafe extern "C" fn wallet_ffi_claim_pinata_private_owned_not_initialized(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
-    };
-
     let pinata_id = AccountId::new(unsafe { (*pinata_account_id).data });
     let winner_id = AccountId::new(unsafe { (*winner_account_id).data });
     let solution = u128::from_le_bytes(unsafe { *solution });
 
+    let wallet = match wrapper.detach_accounts(&[pinata_id, winner_id]) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
     let pinata = Pinata(&wallet);
 
     match block_on(pinata.claim_private_owned_account(pinata_id, winner_id, solution)) {
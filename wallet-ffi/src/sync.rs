@@ -1,12 +1,133 @@
 //! Block synchronization functions.
 
+use std::{ffi::c_void, sync::Arc};
+
+use common::block::CompactBlock;
+use futures::TryStreamExt as _;
+use tokio::sync::oneshot;
+use wallet::SyncCheckpoint;
+
 use crate::{
     block_on,
     error::{print_error, WalletFfiError},
-    types::WalletHandle,
-    wallet::get_wallet,
+    get_runtime,
+    job::submit_job,
+    types::{FfiBlockCallback, FfiBlockSubscription, FfiJobHandle, WalletHandle},
+    wallet::{get_wallet, WalletWrapper},
 };
 
+/// Write the wallet storage to disk.
+///
+/// The storage is serialized under a read lock, which is released before
+/// writing.
+async fn store_wallet(wrapper: &WalletWrapper) -> Result<(), WalletFfiError> {
+    let _store_guard = wrapper.store.lock().await;
+
+    let snapshot = match wrapper.core.read() {
+        Ok(wallet) => wallet.persistent_data_snapshot(),
+        Err(e) => {
+            print_error(format!("Failed to lock wallet: {}", e));
+            return Err(WalletFfiError::InternalError);
+        }
+    };
+    let stored = match snapshot {
+        Ok(snapshot) => snapshot.write().await,
+        Err(e) => Err(e),
+    };
+    if let Err(e) = stored {
+        print_error(format!("Sync failed: {}", e));
+        return Err(WalletFfiError::SyncError);
+    }
+    Ok(())
+}
+
+/// Sync the wallet to `block_id`.
+///
+/// Blocks are downloaded without holding the wallet lock and decrypted under
+/// the read lock; the write lock is only taken to apply the decrypted
+/// accounts of each chunk, so other calls keep running during a sync. Storage is written at the
+/// configured checkpoints, at the end of the sync and when downloading fails.
+fn sync_wallet(wrapper: &WalletWrapper, block_id: u64) -> Result<(), WalletFfiError> {
+    let _sync_guard = match wrapper.sync.lock() {
+        Ok(g) => g,
+        Err(e) => {
+            print_error(format!("Failed to lock wallet sync: {}", e));
+            return Err(WalletFfiError::InternalError);
+        }
+    };
+
+    let before_polling = std::time::Instant::now();
+    let (poller, last_synced_block, mut checkpoint, stats) = {
+        let wallet = match wrapper.core.read() {
+            Ok(w) => w,
+            Err(e) => {
+                print_error(format!("Failed to lock wallet: {}", e));
+                return Err(WalletFfiError::InternalError);
+            }
+        };
+        (
+            wallet.block_poller(),
+            wallet.last_synced_block,
+            SyncCheckpoint::new(wallet.config(), wallet.last_synced_block),
+            wallet.stats(),
+        )
+    };
+
+    if last_synced_block >= block_id {
+        return Ok(());
+    }
+
+    block_on(async {
+        let mut chunks =
+            std::pin::pin!(poller.poll_compact_block_chunks(last_synced_block + 1..=block_id));
+        let mut synced_block = last_synced_block;
+
+        loop {
+            let blocks = match chunks.try_next().await {
+                Ok(Some(blocks)) => blocks,
+                Ok(None) => break,
+                Err(e) => {
+                    print_error(format!("Sync failed: {}", e));
+                    if checkpoint.is_dirty(synced_block) {
+                        store_wallet(wrapper).await?;
+                    }
+                    return Err(WalletFfiError::SyncError);
+                }
+            };
+
+            let decrypted = match wrapper.core.read() {
+                Ok(wallet) => wallet.decrypt_compact_blocks(blocks),
+                Err(e) => {
+                    print_error(format!("Failed to lock wallet: {}", e));
+                    return Err(WalletFfiError::InternalError);
+                }
+            };
+            synced_block = match wrapper.core.write() {
+                Ok(mut wallet) => {
+                    wallet.apply_decrypted_blocks(decrypted);
+                    wallet.last_synced_block
+                }
+                Err(e) => {
+                    print_error(format!("Failed to lock wallet: {}", e));
+                    return Err(WalletFfiError::InternalError);
+                }
+            };
+
+            if checkpoint.is_due(synced_block) {
+                store_wallet(wrapper).await?;
+                checkpoint.mark(synced_block);
+            }
+        }
+
+        if checkpoint.is_dirty(synced_block) {
+            store_wallet(wrapper).await?;
+        }
+
+        stats.record_sync(before_polling.elapsed(), synced_block - last_synced_block);
+        Ok(())
+    })?
+}
+
 /// Synchronize private accounts to a specific block.
 ///
 /// This scans the blockchain from the last synced block to the specified block,
@@ -22,8 +143,8 @@ use crate::{
 /// - Error code on other failures
 ///
 /// # Note
-/// This operation can take a while for large block ranges. The wallet
-/// internally uses a progress bar which may output to stdout.
+/// This operation can take a while for large block ranges. Other calls on
+/// the same handle keep running while blocks are downloaded.
 ///
 /// # Safety
 /// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
@@ -37,22 +158,54 @@ pub unsafe extern "C" fn wallet_ffi_sync_to_block(
         Err(e) => return e,
     };
 
-    let mut wallet = match wrapper.core.lock() {
+    match sync_wallet(wrapper, block_id) {
+        Ok(()) => WalletFfiError::Success,
+        Err(e) => e,
+    }
+}
+
+/// Start `wallet_ffi_sync_to_block` as a background job.
+///
+/// Returns as soon as the job is submitted. Completion is reported through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()`, which return the same
+/// codes as `wallet_ffi_sync_to_block`. The transfer result is not used and
+/// can be passed as null.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `block_id`: Target block number to sync to
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_sync_to_block_async(
+    handle: *mut WalletHandle,
+    block_id: u64,
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
         Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+        Err(e) => return e,
     };
 
-    match block_on(wallet.sync_to_block(block_id)) {
-        Ok(Ok(())) => WalletFfiError::Success,
-        Ok(Err(e)) => {
-            print_error(format!("Sync failed: {}", e));
-            WalletFfiError::SyncError
-        }
-        Err(e) => e,
+    if out_job.is_null() {
+        print_error("Null output pointer");
+        return WalletFfiError::NullPointer;
     }
+
+    submit_job(out_job, move || {
+        sync_wallet(wrapper, block_id).map(|()| None)
+    })
 }
 
 /// Get the last synced block number.
@@ -83,7 +236,7 @@ pub unsafe extern "C" fn wallet_ffi_get_last_synced_block(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -127,15 +280,15 @@ pub unsafe extern "C" fn wallet_ffi_get_current_block_height(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
+    let sequencer_client = match wrapper.core.read() {
+        Ok(w) => Arc::clone(&w.sequencer_client),
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
             return WalletFfiError::InternalError;
         }
     };
 
-    match block_on(wallet.sequencer_client.get_last_block()) {
+    match block_on(sequencer_client.get_last_block()) {
         Ok(Ok(response)) => {
             unsafe {
                 *out_block_height = response.last_block;
@@ -149,3 +302,187 @@ pub unsafe extern "C" fn wallet_ffi_get_current_block_height(
         Err(e) => e,
     }
 }
+
+/// Caller data passed back to a block callback.
+struct CallbackData(*mut c_void);
+
+// The caller guarantees that the data can be used from the subscription thread.
+unsafe impl Send for CallbackData {}
+
+/// Running block subscription, owned by its handle.
+struct BlockSubscription {
+    stop: oneshot::Sender<()>,
+    task: tokio::task::JoinHandle<()>,
+}
+
+/// Apply blocks pushed by the sequencer until stopped or failing.
+///
+/// Storage is written at the configured checkpoints and when the subscription ends. Blocks are
+/// applied in order from the last synced block, so running a sync at the same time is harmless:
+/// blocks already applied by either of them are skipped.
+async fn follow_blocks(
+    wrapper: &WalletWrapper,
+    callback: FfiBlockCallback,
+    user_data: CallbackData,
+    mut stop: oneshot::Receiver<()>,
+) {
+    let (mut subscription, mut checkpoint, mut synced_block) = match wrapper.core.read() {
+        Ok(wallet) => (
+            wallet
+                .sequencer_client
+                .subscribe_blocks(wallet.last_synced_block + 1),
+            SyncCheckpoint::new(wallet.config(), wallet.last_synced_block),
+            wallet.last_synced_block,
+        ),
+        Err(e) => {
+            print_error(format!("Failed to lock wallet: {}", e));
+            callback(user_data.0, 0, WalletFfiError::InternalError);
+            return;
+        }
+    };
+
+    let error = loop {
+        let block = tokio::select! {
+            _ = &mut stop => break None,
+            block = subscription.next_block() => block,
+        };
+        let block = match block {
+            Ok(block) => block,
+            Err(e) => {
+                print_error(format!("Block subscription failed: {}", e));
+                break Some(WalletFfiError::NetworkError);
+            }
+        };
+        let block_id = block.block_id;
+
+        let decrypted = match wrapper.core.read() {
+            Ok(wallet) => wallet.decrypt_compact_blocks(vec![CompactBlock::from(&block)]),
+            Err(e) => {
+                print_error(format!("Failed to lock wallet: {}", e));
+                break Some(WalletFfiError::InternalError);
+            }
+        };
+        synced_block = match wrapper.core.write() {
+            Ok(mut wallet) => {
+                wallet.apply_decrypted_blocks(decrypted);
+                wallet.last_synced_block
+            }
+            Err(e) => {
+                print_error(format!("Failed to lock wallet: {}", e));
+                break Some(WalletFfiError::InternalError);
+            }
+        };
+
+        if checkpoint.is_due(synced_block) {
+            if let Err(e) = store_wallet(wrapper).await {
+                break Some(e);
+            }
+            checkpoint.mark(synced_block);
+        }
+
+        callback(user_data.0, block_id, WalletFfiError::Success);
+    };
+
+    let error = if checkpoint.is_dirty(synced_block) {
+        store_wallet(wrapper).await.err().or(error)
+    } else {
+        error
+    };
+    if let Some(error) = error {
+        callback(user_data.0, synced_block, error);
+    }
+}
+
+/// Subscribe to new blocks pushed by the sequencer.
+///
+/// Blocks after the last synced block are applied to the wallet as soon as
+/// they are produced, without polling, and `callback` is called after each
+/// of them. Call `wallet_ffi_sync_to_block` first to catch up quickly when
+/// the wallet is far behind.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `callback`: Called from a background thread with `user_data`, see `FfiBlockCallback`
+/// - `user_data`: Opaque pointer passed back to `callback`, may be null
+/// - `out_subscription`: Output pointer for the subscription handle
+///
+/// # Returns
+/// - `Success` if the subscription was started
+/// - Error code on failure
+///
+/// # Memory
+/// The subscription must be stopped and freed with `wallet_ffi_unsubscribe_blocks()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed before the subscription is stopped
+/// - `user_data` must be usable from another thread until the subscription is stopped
+/// - `out_subscription` must be a valid pointer to a `FfiBlockSubscription` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_subscribe_blocks(
+    handle: *mut WalletHandle,
+    callback: Option<FfiBlockCallback>,
+    user_data: *mut c_void,
+    out_subscription: *mut *mut FfiBlockSubscription,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    let Some(callback) = callback else {
+        print_error("Null block callback");
+        return WalletFfiError::NullPointer;
+    };
+
+    if out_subscription.is_null() {
+        print_error("Null output pointer");
+        return WalletFfiError::NullPointer;
+    }
+
+    let runtime = match get_runtime() {
+        Ok(r) => r,
+        Err(e) => return e,
+    };
+
+    // The wallet locks are not held across awaits in a way that is `Send`, so the subscription
+    // runs on its own blocking thread, like the background jobs.
+    let (stop, stop_receiver) = oneshot::channel();
+    let user_data = CallbackData(user_data);
+    let task = runtime.spawn_blocking(move || {
+        if let Ok(runtime) = get_runtime() {
+            runtime.block_on(follow_blocks(wrapper, callback, user_data, stop_receiver));
+        }
+    });
+
+    unsafe {
+        *out_subscription =
+            Box::into_raw(Box::new(BlockSubscription { stop, task })) as *mut FfiBlockSubscription;
+    }
+
+    WalletFfiError::Success
+}
+
+/// Stop a block subscription and free its handle.
+///
+/// Waits until the subscription has written the synced blocks to storage.
+///
+/// # Safety
+/// - `subscription` must be either null or a valid subscription handle that has not been freed
+/// - Must not be called from the subscription callback
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_unsubscribe_blocks(subscription: *mut FfiBlockSubscription) {
+    if subscription.is_null() {
+        return;
+    }
+
+    let BlockSubscription { stop, task } =
+        *unsafe { Box::from_raw(subscription as *mut BlockSubscription) };
+    // The task may have stopped on its own already
+    let _ = stop.send(());
+    match block_on(task) {
+        Ok(Ok(())) => {}
+        Ok(Err(e)) => print_error(format!("Block subscription thread failed: {}", e)),
+        Err(e) => print_error(format!("Failed to stop block subscription: {:?}", e)),
+    }
+}
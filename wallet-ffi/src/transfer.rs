@@ -4,16 +4,198 @@ use std::{ffi::CString, ptr};
 
 use common::error::ExecutionFailureKind;
 use nssa::AccountId;
+use nssa_core::{encryption::ViewingPublicKey, NullifierPublicKey};
 use wallet::program_facades::native_token_transfer::NativeTokenTransfer;
 
 use crate::{
     block_on,
     error::{print_error, WalletFfiError},
-    types::{FfiBytes32, FfiTransferResult, WalletHandle},
-    wallet::get_wallet,
+    job::submit_job,
+    types::{FfiBytes32, FfiJobHandle, FfiTransferResult, WalletHandle},
+    wallet::{get_wallet, WalletWrapper},
     FfiPrivateAccountKeys,
 };
 
+/// A transfer or registration with all arguments copied out of caller memory.
+///
+/// Shared by the blocking functions and their `*_async` variants, which run
+/// the same operation on a background job.
+pub(crate) enum TransferOp {
+    Public {
+        from: AccountId,
+        to: AccountId,
+        amount: u128,
+    },
+    Shielded {
+        from: AccountId,
+        to_npk: NullifierPublicKey,
+        to_vpk: ViewingPublicKey,
+        amount: u128,
+    },
+    Deshielded {
+        from: AccountId,
+        to: AccountId,
+        amount: u128,
+    },
+    Private {
+        from: AccountId,
+        to_npk: NullifierPublicKey,
+        to_vpk: ViewingPublicKey,
+        amount: u128,
+    },
+    ShieldedOwned {
+        from: AccountId,
+        to: AccountId,
+        amount: u128,
+    },
+    PrivateOwned {
+        from: AccountId,
+        to: AccountId,
+        amount: u128,
+    },
+    RegisterPublic {
+        account_id: AccountId,
+    },
+    RegisterPrivate {
+        account_id: AccountId,
+    },
+}
+
+impl TransferOp {
+    /// Accounts of this wallet whose keys the operation uses.
+    fn owned_account_ids(&self) -> Vec<AccountId> {
+        match *self {
+            TransferOp::Public { from, to, .. }
+            | TransferOp::Deshielded { from, to, .. }
+            | TransferOp::ShieldedOwned { from, to, .. }
+            | TransferOp::PrivateOwned { from, to, .. } => vec![from, to],
+            TransferOp::Shielded { from, .. } | TransferOp::Private { from, .. } => vec![from],
+            TransferOp::RegisterPublic { account_id }
+            | TransferOp::RegisterPrivate { account_id } => vec![account_id],
+        }
+    }
+
+    /// Run the operation to completion, returning the transaction hash.
+    ///
+    /// The keys of the accounts involved are copied out under a short read
+    /// lock, so syncs and other calls are not blocked while the transaction
+    /// is proven and submitted.
+    pub(crate) fn run(self, wrapper: &WalletWrapper) -> Result<Vec<u8>, WalletFfiError> {
+        let wallet = wrapper.detach_accounts(&self.owned_account_ids())?;
+
+        let transfer = NativeTokenTransfer(&wallet);
+
+        let (what, result) = match self {
+            TransferOp::Public { from, to, amount } => (
+                "Transfer",
+                block_on(transfer.send_public_transfer(from, to, amount))?
+                    .map(|response| response.tx_hash.to_string().into_bytes()),
+            ),
+            TransferOp::Shielded {
+                from,
+                to_npk,
+                to_vpk,
+                amount,
+            } => (
+                "Transfer",
+                block_on(
+                    transfer.send_shielded_transfer_to_outer_account(from, to_npk, to_vpk, amount),
+                )?
+                .map(|(response, _shared_key)| Vec::from(response.tx_hash)),
+            ),
+            TransferOp::Deshielded { from, to, amount } => (
+                "Transfer",
+                block_on(transfer.send_deshielded_transfer(from, to, amount))?
+                    .map(|(response, _shared_key)| Vec::from(response.tx_hash)),
+            ),
+            TransferOp::Private {
+                from,
+                to_npk,
+                to_vpk,
+                amount,
+            } => (
+                "Transfer",
+                block_on(
+                    transfer.send_private_transfer_to_outer_account(from, to_npk, to_vpk, amount),
+                )?
+                .map(|(response, _shared_key)| Vec::from(response.tx_hash)),
+            ),
+            TransferOp::ShieldedOwned { from, to, amount } => (
+                "Transfer",
+                block_on(transfer.send_shielded_transfer(from, to, amount))?
+                    .map(|(response, _shared_key)| Vec::from(response.tx_hash)),
+            ),
+            TransferOp::PrivateOwned { from, to, amount } => (
+                "Transfer",
+                block_on(transfer.send_private_transfer_to_owned_account(from, to, amount))?
+                    .map(|(response, _shared_keys)| Vec::from(response.tx_hash)),
+            ),
+            TransferOp::RegisterPublic { account_id } => (
+                "Registration",
+                block_on(transfer.register_account(account_id))?
+                    .map(|response| response.tx_hash.to_string().into_bytes()),
+            ),
+            TransferOp::RegisterPrivate { account_id } => (
+                "Registration",
+                block_on(transfer.register_account_private(account_id))?
+                    .map(|(response, _secret)| Vec::from(response.tx_hash)),
+            ),
+        };
+
+        result.map_err(|e| {
+            print_error(format!("{what} failed: {:?}", e));
+            map_execution_error(e)
+        })
+    }
+}
+
+/// Read the arguments of a transfer to a foreign private account.
+unsafe fn outer_transfer_op(
+    from: *const FfiBytes32,
+    to_keys: &FfiPrivateAccountKeys,
+    amount: *const [u8; 16],
+) -> Result<(AccountId, NullifierPublicKey, ViewingPublicKey, u128), WalletFfiError> {
+    let from_id = AccountId::new(unsafe { (*from).data });
+    let to_npk = to_keys.npk();
+    let to_vpk = match to_keys.vpk() {
+        Ok(vpk) => vpk,
+        Err(e) => {
+            print_error("Invalid viewing key");
+            return Err(e);
+        }
+    };
+    let amount = u128::from_le_bytes(unsafe { *amount });
+
+    Ok((from_id, to_npk, to_vpk, amount))
+}
+
+/// Write the outcome of a transfer to `out_result` and return its error code.
+fn write_transfer_result(
+    out_result: *mut FfiTransferResult,
+    result: Result<Vec<u8>, WalletFfiError>,
+) -> WalletFfiError {
+    match result {
+        Ok(tx_hash) => {
+            let tx_hash = CString::new(tx_hash)
+                .map(|s| s.into_raw())
+                .unwrap_or(ptr::null_mut());
+
+            unsafe {
+                (*out_result).tx_hash = tx_hash;
+                (*out_result).success = true;
+            }
+            WalletFfiError::Success
+        }
+        Err(e) => {
+            unsafe {
+                (*out_result).tx_hash = ptr::null_mut();
+                (*out_result).success = false;
+            }
+            e
+        }
+    }
+}
+
 /// Send a public token transfer.
 ///
 /// Transfers tokens from one public account to another on the network.
@@ -58,42 +240,66 @@ pub unsafe extern "C" fn wallet_ffi_transfer_public(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::Public {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_id = AccountId::new(unsafe { (*to).data });
-    let amount = u128::from_le_bytes(unsafe { *amount });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.send_public_transfer(from_id, to_id, amount)) {
-        Ok(Ok(response)) => {
-            let tx_hash = CString::new(response.tx_hash.to_string())
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_transfer_public` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to`: Destination account ID
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to` must be a valid pointer to a `FfiBytes32` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_public_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to: *const FfiBytes32,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if from.is_null() || to.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::Public {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Send a shielded token transfer.
@@ -140,51 +346,74 @@ pub unsafe extern "C" fn wallet_ffi_transfer_shielded(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = match unsafe { outer_transfer_op(from, &*to_keys, amount) } {
+        Ok((from, to_npk, to_vpk, amount)) => TransferOp::Shielded {
+            from,
+            to_npk,
+            to_vpk,
+            amount,
+        },
+        Err(e) => return e,
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_npk = (*to_keys).npk();
-    let to_vpk = match (*to_keys).vpk() {
-        Ok(vpk) => vpk,
-        Err(e) => {
-            print_error("Invalid viewing key");
-            return e;
-        }
+    write_transfer_result(out_result, op.run(wrapper))
+}
+
+/// Start `wallet_ffi_transfer_shielded` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to_keys`: Destination account keys
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to_keys` must be a valid pointer to a `FfiPrivateAccountKeys` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_shielded_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to_keys: *const FfiPrivateAccountKeys,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
     };
-    let amount = u128::from_le_bytes(unsafe { *amount });
 
-    let transfer = NativeTokenTransfer(&wallet);
+    if from.is_null() || to_keys.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
+    }
 
-    match block_on(
-        transfer.send_shielded_transfer_to_outer_account(from_id, to_npk, to_vpk, amount),
-    ) {
-        Ok(Ok((response, _shared_key))) => {
-            let tx_hash = CString::new(response.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+    let op = match unsafe { outer_transfer_op(from, &*to_keys, amount) } {
+        Ok((from, to_npk, to_vpk, amount)) => TransferOp::Shielded {
+            from,
+            to_npk,
+            to_vpk,
+            amount,
+        },
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
-    }
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Send a deshielded token transfer.
@@ -231,42 +460,66 @@ pub unsafe extern "C" fn wallet_ffi_transfer_deshielded(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::Deshielded {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_id = AccountId::new(unsafe { (*to).data });
-    let amount = u128::from_le_bytes(unsafe { *amount });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.send_deshielded_transfer(from_id, to_id, amount)) {
-        Ok(Ok((response, _shared_key))) => {
-            let tx_hash = CString::new(response.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_transfer_deshielded` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to`: Destination account ID
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to` must be a valid pointer to a `FfiBytes32` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_deshielded_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to: *const FfiBytes32,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if from.is_null() || to.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::Deshielded {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Send a private token transfer.
@@ -313,50 +566,74 @@ pub unsafe extern "C" fn wallet_ffi_transfer_private(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = match unsafe { outer_transfer_op(from, &*to_keys, amount) } {
+        Ok((from, to_npk, to_vpk, amount)) => TransferOp::Private {
+            from,
+            to_npk,
+            to_vpk,
+            amount,
+        },
+        Err(e) => return e,
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_npk = (*to_keys).npk();
-    let to_vpk = match (*to_keys).vpk() {
-        Ok(vpk) => vpk,
-        Err(e) => {
-            print_error("Invalid viewing key");
-            return e;
-        }
+    write_transfer_result(out_result, op.run(wrapper))
+}
+
+/// Start `wallet_ffi_transfer_private` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to_keys`: Destination account keys
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to_keys` must be a valid pointer to a `FfiPrivateAccountKeys` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_private_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to_keys: *const FfiPrivateAccountKeys,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
     };
-    let amount = u128::from_le_bytes(unsafe { *amount });
 
-    let transfer = NativeTokenTransfer(&wallet);
+    if from.is_null() || to_keys.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
+    }
 
-    match block_on(transfer.send_private_transfer_to_outer_account(from_id, to_npk, to_vpk, amount))
-    {
-        Ok(Ok((response, _shared_key))) => {
-            let tx_hash = CString::new(response.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+    let op = match unsafe { outer_transfer_op(from, &*to_keys, amount) } {
+        Ok((from, to_npk, to_vpk, amount)) => TransferOp::Private {
+            from,
+            to_npk,
+            to_vpk,
+            amount,
+        },
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
-    }
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Send a shielded token transfer to an owned private account.
@@ -406,42 +683,66 @@ pub unsafe extern "C" fn wallet_ffi_transfer_shielded_owned(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::ShieldedOwned {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_id = AccountId::new(unsafe { (*to).data });
-    let amount = u128::from_le_bytes(unsafe { *amount });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.send_shielded_transfer(from_id, to_id, amount)) {
-        Ok(Ok((response, _shared_key))) => {
-            let tx_hash = CString::new(response.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_transfer_shielded_owned` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to`: Destination private account ID (must be owned by this wallet)
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to` must be a valid pointer to a `FfiBytes32` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_shielded_owned_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to: *const FfiBytes32,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if from.is_null() || to.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::ShieldedOwned {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Send a private token transfer to an owned private account.
@@ -491,42 +792,66 @@ pub unsafe extern "C" fn wallet_ffi_transfer_private_owned(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::PrivateOwned {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
     };
 
-    let from_id = AccountId::new(unsafe { (*from).data });
-    let to_id = AccountId::new(unsafe { (*to).data });
-    let amount = u128::from_le_bytes(unsafe { *amount });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.send_private_transfer_to_owned_account(from_id, to_id, amount)) {
-        Ok(Ok((response, _shared_keys))) => {
-            let tx_hash = CString::new(response.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_transfer_private_owned` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `from`: Source account ID (must be owned by this wallet)
+/// - `to`: Destination private account ID (must be owned by this wallet)
+/// - `amount`: Amount to transfer as little-endian [u8; 16]
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `from` must be a valid pointer to a `FfiBytes32` struct
+/// - `to` must be a valid pointer to a `FfiBytes32` struct
+/// - `amount` must be a valid pointer to a `[u8; 16]` array
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_transfer_private_owned_async(
+    handle: *mut WalletHandle,
+    from: *const FfiBytes32,
+    to: *const FfiBytes32,
+    amount: *const [u8; 16],
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Transfer failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if from.is_null() || to.is_null() || amount.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::PrivateOwned {
+        from: AccountId::new(unsafe { (*from).data }),
+        to: AccountId::new(unsafe { (*to).data }),
+        amount: u128::from_le_bytes(unsafe { *amount }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Register a public account on the network.
@@ -566,40 +891,56 @@ pub unsafe extern "C" fn wallet_ffi_register_public_account(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::RegisterPublic {
+        account_id: AccountId::new(unsafe { (*account_id).data }),
     };
 
-    let account_id = AccountId::new(unsafe { (*account_id).data });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.register_account(account_id)) {
-        Ok(Ok(response)) => {
-            let tx_hash = CString::new(response.tx_hash.to_string())
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_register_public_account` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `account_id`: Account ID to register
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `account_id` must be a valid pointer to a `FfiBytes32` struct
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_register_public_account_async(
+    handle: *mut WalletHandle,
+    account_id: *const FfiBytes32,
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Registration failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if account_id.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::RegisterPublic {
+        account_id: AccountId::new(unsafe { (*account_id).data }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Register a private account on the network.
@@ -639,40 +980,56 @@ pub unsafe extern "C" fn wallet_ffi_register_private_account(
         return WalletFfiError::NullPointer;
     }
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
+    let op = TransferOp::RegisterPrivate {
+        account_id: AccountId::new(unsafe { (*account_id).data }),
     };
 
-    let account_id = AccountId::new(unsafe { (*account_id).data });
-
-    let transfer = NativeTokenTransfer(&wallet);
+    write_transfer_result(out_result, op.run(wrapper))
+}
 
-    match block_on(transfer.register_account_private(account_id)) {
-        Ok(Ok((res, _secret))) => {
-            let tx_hash = CString::new(res.tx_hash)
-                .map(|s| s.into_raw())
-                .unwrap_or(ptr::null_mut());
+/// Start `wallet_ffi_register_private_account` as a background job.
+///
+/// Returns as soon as the job is submitted. The transfer result is delivered through
+/// `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `account_id`: Account ID to register
+/// - `out_job`: Output pointer for the job handle
+///
+/// # Returns
+/// - `Success` if the job was started
+/// - Error code on failure
+///
+/// # Memory
+/// The job handle must be freed with `wallet_ffi_free_job()`.
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+///   must not be destroyed while the job is running
+/// - `account_id` must be a valid pointer to a `FfiBytes32` struct
+/// - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_register_private_account_async(
+    handle: *mut WalletHandle,
+    account_id: *const FfiBytes32,
+    out_job: *mut *mut FfiJobHandle,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
 
-            unsafe {
-                (*out_result).tx_hash = tx_hash;
-                (*out_result).success = true;
-            }
-            WalletFfiError::Success
-        }
-        Ok(Err(e)) => {
-            print_error(format!("Registration failed: {:?}", e));
-            unsafe {
-                (*out_result).tx_hash = ptr::null_mut();
-                (*out_result).success = false;
-            }
-            map_execution_error(e)
-        }
-        Err(e) => e,
+    if account_id.is_null() || out_job.is_null() {
+        print_error("Null pointer argument");
+        return WalletFfiError::NullPointer;
     }
+
+    let op = TransferOp::RegisterPrivate {
+        account_id: AccountId::new(unsafe { (*account_id).data }),
+    };
+
+    submit_job(out_job, move || op.run(wrapper).map(Some))
 }
 
 /// Free a transfer result returned by `wallet_ffi_transfer_public` or
@@ -1,7 +1,10 @@
 //! C-compatible type definitions for the FFI layer.
 
 use core::slice;
-use std::{ffi::c_char, ptr};
+use std::{
+    ffi::{c_char, c_void},
+    ptr,
+};
 
 use nssa::{Account, Data};
 use nssa_core::encryption::shared_key_derivation::Secp256k1Point;
@@ -17,6 +20,26 @@ pub struct WalletHandle {
     _private: [u8; 0],
 }
 
+/// Opaque pointer to a background job started by one of the `*_async` functions.
+#[repr(C)]
+pub struct FfiJobHandle {
+    _private: [u8; 0],
+}
+
+/// Opaque pointer to a block subscription started by `wallet_ffi_subscribe_blocks`.
+#[repr(C)]
+pub struct FfiBlockSubscription {
+    _private: [u8; 0],
+}
+
+/// Callback of a block subscription.
+///
+/// Called with `Success` and the block id after each new block was applied to the wallet. If the
+/// subscription fails it is called once more with the error code and the last synced block id,
+/// and the subscription stops.
+pub type FfiBlockCallback =
+    extern "C" fn(user_data: *mut c_void, block_id: u64, error: WalletFfiError);
+
 /// 32-byte array type for AccountId, keys, hashes, etc.
 #[repr(C)]
 #[derive(Clone, Copy, Default)]
@@ -138,6 +161,27 @@ impl Default for FfiTransferResult {
     }
 }
 
+/// Sync and proving timings since the wallet was opened.
+///
+/// Durations are in microseconds. Syncs are counted once they complete, from
+/// the first downloaded block to the last applied one.
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct FfiWalletStats {
+    /// Number of completed syncs
+    pub sync_count: u64,
+    /// Blocks applied by completed syncs
+    pub synced_blocks: u64,
+    pub sync_total_us: u64,
+    pub sync_last_us: u64,
+    pub sync_max_us: u64,
+    /// Number of proofs of private transactions
+    pub proof_count: u64,
+    pub proving_total_us: u64,
+    pub proving_last_us: u64,
+    pub proving_max_us: u64,
+}
+
 // Helper functions to convert between Rust and FFI types
 
 impl FfiBytes32 {
@@ -258,3 +302,23 @@ impl TryFrom<&FfiPublicAccountKey> for nssa::PublicKey {
         Ok(public_key)
     }
 }
+
+impl From<&wallet::stats::WalletStats> for FfiWalletStats {
+    fn from(value: &wallet::stats::WalletStats) -> Self {
+        let sync = value.sync.snapshot();
+        let proving = value.proving.snapshot();
+        Self {
+            sync_count: sync.count,
+            synced_blocks: value
+                .synced_blocks
+                .load(std::sync::atomic::Ordering::Relaxed),
+            sync_total_us: sync.total_micros,
+            sync_last_us: sync.last_micros,
+            sync_max_us: sync.max_micros,
+            proof_count: proving.count,
+            proving_total_us: proving.total_micros,
+            proving_last_us: proving.last_micros,
+            proving_max_us: proving.max_micros,
+        }
+    }
+}
@@ -4,20 +4,58 @@ use std::{
     ffi::{c_char, CStr},
     path::PathBuf,
     ptr,
-    sync::Mutex,
+    sync::{Mutex, RwLock},
 };
 
+use nssa::AccountId;
 use wallet::WalletCore;
 
 use crate::{
     block_on,
     error::{print_error, WalletFfiError},
-    types::WalletHandle,
+    types::{FfiWalletStats, WalletHandle},
 };
 
-/// Internal wrapper around WalletCore with mutex for thread safety.
+/// Internal wrapper around WalletCore with locks for thread safety.
+///
+/// Queries and transfers only read the wallet and share `core`; transfers
+/// copy the keys they need out and release the lock before proving. Syncs are
+/// serialized by `sync` and take the write lock only while applying a block,
+/// so reads are not blocked while blocks are being downloaded. Storage
+/// writes serialize the wallet under the read lock and are serialized by
+/// `store`.
 pub(crate) struct WalletWrapper {
-    pub core: Mutex<WalletCore>,
+    pub core: RwLock<WalletCore>,
+    pub sync: Mutex<()>,
+    pub store: tokio::sync::Mutex<()>,
+}
+
+impl WalletWrapper {
+    fn new(core: WalletCore) -> Self {
+        Self {
+            core: RwLock::new(core),
+            sync: Mutex::new(()),
+            store: tokio::sync::Mutex::new(()),
+        }
+    }
+
+    /// Copy of the wallet holding only the keys of `account_ids`, taken under
+    /// a short read lock.
+    ///
+    /// Calls that wait on the sequencer or on proving run on the copy, so
+    /// syncs and other calls are not blocked behind them.
+    pub(crate) fn detach_accounts(
+        &self,
+        account_ids: &[AccountId],
+    ) -> Result<WalletCore, WalletFfiError> {
+        match self.core.read() {
+            Ok(wallet) => Ok(wallet.detach_accounts(account_ids)),
+            Err(e) => {
+                print_error(format!("Failed to lock wallet: {}", e));
+                Err(WalletFfiError::InternalError)
+            }
+        }
+    }
 }
 
 /// Helper to get the wallet wrapper from an opaque handle.
@@ -116,9 +154,7 @@ pub unsafe extern "C" fn wallet_ffi_create_new(
 
     match WalletCore::new_init_storage(config_path, storage_path, None, password) {
         Ok(core) => {
-            let wrapper = Box::new(WalletWrapper {
-                core: Mutex::new(core),
-            });
+            let wrapper = Box::new(WalletWrapper::new(core));
             Box::into_raw(wrapper) as *mut WalletHandle
         }
         Err(e) => {
@@ -159,9 +195,7 @@ pub unsafe extern "C" fn wallet_ffi_open(
 
     match WalletCore::new_update_chain(config_path, storage_path, None) {
         Ok(core) => {
-            let wrapper = Box::new(WalletWrapper {
-                core: Mutex::new(core),
-            });
+            let wrapper = Box::new(WalletWrapper::new(core));
             Box::into_raw(wrapper) as *mut WalletHandle
         }
         Err(e) => {
@@ -209,21 +243,29 @@ pub unsafe extern "C" fn wallet_ffi_save(handle: *mut WalletHandle) -> WalletFfi
         Err(e) => return e,
     };
 
-    let wallet = match wrapper.core.lock() {
-        Ok(w) => w,
-        Err(e) => {
-            print_error(format!("Failed to lock wallet: {}", e));
-            return WalletFfiError::InternalError;
-        }
-    };
+    let store = async {
+        let _store_guard = wrapper.store.lock().await;
 
-    match block_on(wallet.store_persistent_data()) {
-        Ok(Ok(())) => WalletFfiError::Success,
-        Ok(Err(e)) => {
+        let snapshot = match wrapper.core.read() {
+            Ok(wallet) => wallet.persistent_data_snapshot(),
+            Err(e) => {
+                print_error(format!("Failed to lock wallet: {}", e));
+                return Err(WalletFfiError::InternalError);
+            }
+        };
+        let stored = match snapshot {
+            Ok(snapshot) => snapshot.write().await,
+            Err(e) => Err(e),
+        };
+        stored.map_err(|e| {
             print_error(format!("Failed to save wallet: {}", e));
             WalletFfiError::StorageError
-        }
-        Err(e) => e,
+        })
+    };
+
+    match block_on(store) {
+        Ok(Ok(())) => WalletFfiError::Success,
+        Ok(Err(e)) | Err(e) => e,
     }
 }
 
@@ -246,7 +288,7 @@ pub unsafe extern "C" fn wallet_ffi_get_sequencer_addr(handle: *mut WalletHandle
         Err(_) => return ptr::null_mut(),
     };
 
-    let wallet = match wrapper.core.lock() {
+    let wallet = match wrapper.core.read() {
         Ok(w) => w,
         Err(e) => {
             print_error(format!("Failed to lock wallet: {}", e));
@@ -265,6 +307,49 @@ pub unsafe extern "C" fn wallet_ffi_get_sequencer_addr(handle: *mut WalletHandle
     }
 }
 
+/// Get the sync and proving timings since the wallet was opened.
+///
+/// # Parameters
+/// - `handle`: Valid wallet handle
+/// - `out_stats`: Output pointer for the timings
+///
+/// # Returns
+/// - `Success` on success
+/// - Error code on failure
+///
+/// # Safety
+/// - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+/// - `out_stats` must be a valid pointer to a `FfiWalletStats` struct
+#[no_mangle]
+pub unsafe extern "C" fn wallet_ffi_get_stats(
+    handle: *mut WalletHandle,
+    out_stats: *mut FfiWalletStats,
+) -> WalletFfiError {
+    let wrapper = match get_wallet(handle) {
+        Ok(w) => w,
+        Err(e) => return e,
+    };
+
+    if out_stats.is_null() {
+        print_error("Null output pointer");
+        return WalletFfiError::NullPointer;
+    }
+
+    let stats = match wrapper.core.read() {
+        Ok(w) => w.stats(),
+        Err(e) => {
+            print_error(format!("Failed to lock wallet: {}", e));
+            return WalletFfiError::InternalError;
+        }
+    };
+
+    unsafe {
+        *out_stats = FfiWalletStats::from(stats.as_ref());
+    }
+
+    WalletFfiError::Success
+}
+
 /// Free a string returned by wallet FFI functions.
 ///
 /// # Safety
@@ -2,7 +2,8 @@
  * NSSA Wallet FFI Bindings
  *
  * Thread Safety: All functions are thread-safe. The wallet handle can be
- * shared across threads, but operations are serialized internally.
+ * shared across threads. Read-only calls and transfers run concurrently,
+ * while calls that modify the wallet are serialized internally.
  *
  * Memory Management:
  * - Functions returning pointers allocate memory that must be freed
@@ -103,6 +104,14 @@ typedef enum WalletFfiError {
    * Invalid Key value
    */
   INVALID_KEY_VALUE = 16,
+  /**
+   * Background job has not finished yet
+   */
+  JOB_PENDING = 17,
+  /**
+   * Background job result was already collected
+   */
+  JOB_RESULT_TAKEN = 18,
   /**
    * Internal error (catch-all)
    */
@@ -119,6 +128,29 @@ typedef struct WalletHandle {
   uint8_t _private[0];
 } WalletHandle;
 
+/**
+ * Opaque pointer to a background job started by one of the `*_async` functions.
+ */
+typedef struct FfiJobHandle {
+  uint8_t _private[0];
+} FfiJobHandle;
+
+/**
+ * Opaque pointer to a block subscription started by `wallet_ffi_subscribe_blocks`.
+ */
+typedef struct FfiBlockSubscription {
+  uint8_t _private[0];
+} FfiBlockSubscription;
+
+/**
+ * Callback of a block subscription.
+ *
+ * Called with `Success` and the block id after each new block was applied to the wallet. If the
+ * subscription fails it is called once more with the error code and the last synced block id,
+ * and the subscription stops.
+ */
+typedef void (*FfiBlockCallback)(void *user_data, uint64_t block_id, enum WalletFfiError error);
+
 /**
  * 32-byte array type for AccountId, keys, hashes, etc.
  */
@@ -221,6 +253,33 @@ typedef struct FfiTransferResult {
   bool success;
 } FfiTransferResult;
 
+/**
+ * Sync and proving timings since the wallet was opened.
+ *
+ * Durations are in microseconds. Syncs are counted once they complete, from
+ * the first downloaded block to the last applied one.
+ */
+typedef struct FfiWalletStats {
+  /**
+   * Number of completed syncs
+   */
+  uint64_t sync_count;
+  /**
+   * Blocks applied by completed syncs
+   */
+  uint64_t synced_blocks;
+  uint64_t sync_total_us;
+  uint64_t sync_last_us;
+  uint64_t sync_max_us;
+  /**
+   * Number of proofs of private transactions
+   */
+  uint64_t proof_count;
+  uint64_t proving_total_us;
+  uint64_t proving_last_us;
+  uint64_t proving_max_us;
+} FfiWalletStats;
+
 /**
  * Create a new public account.
  *
@@ -320,6 +379,34 @@ enum WalletFfiError wallet_ffi_get_balance(struct WalletHandle *handle,
                                            bool is_public,
                                            uint8_t (*out_balance)[16]);
 
+/**
+ * Get balances of several accounts at once.
+ *
+ * For public accounts, all balances are fetched from the network with a single
+ * request. For private accounts, the locally cached balances are returned.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `account_ids`: Array of `count` account IDs (32 bytes each)
+ * - `count`: Number of accounts to query
+ * - `is_public`: Whether these are public accounts
+ * - `out_balances`: Output array of `count` balances, filled in the order of `account_ids`
+ *
+ * # Returns
+ * - `Success` on successful query
+ * - Error code on failure, in which case `out_balances` is left untouched
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+ * - `account_ids` must be a valid pointer to `count` `FfiBytes32` structs
+ * - `out_balances` must be a valid pointer to `count` `FfiU128` structs
+ */
+enum WalletFfiError wallet_ffi_get_balances(struct WalletHandle *handle,
+                                            const struct FfiBytes32 *account_ids,
+                                            uintptr_t count,
+                                            bool is_public,
+                                            struct FfiU128 *out_balances);
+
 /**
  * Get full public account data from the network.
  *
@@ -344,6 +431,34 @@ enum WalletFfiError wallet_ffi_get_account_public(struct WalletHandle *handle,
                                                   const struct FfiBytes32 *account_id,
                                                   struct FfiAccount *out_account);
 
+/**
+ * Get full public account data of several accounts from the network.
+ *
+ * Accounts are fetched with one request per 4096 accounts.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `account_ids`: Array of `count` account IDs (32 bytes each)
+ * - `count`: Number of accounts to query
+ * - `out_accounts`: Output array of `count` accounts, filled in the order of `account_ids`
+ *
+ * # Returns
+ * - `Success` on successful query
+ * - Error code on failure, in which case `out_accounts` is left untouched
+ *
+ * # Memory
+ * Each returned account must be freed with `wallet_ffi_free_account_data()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+ * - `account_ids` must be a valid pointer to `count` `FfiBytes32` structs
+ * - `out_accounts` must be a valid pointer to `count` `FfiAccount` structs
+ */
+enum WalletFfiError wallet_ffi_get_accounts_public(struct WalletHandle *handle,
+                                                   const struct FfiBytes32 *account_ids,
+                                                   uintptr_t count,
+                                                   struct FfiAccount *out_accounts);
+
 /**
  * Get full private account data from the local storage.
  *
@@ -373,10 +488,65 @@ enum WalletFfiError wallet_ffi_get_account_private(struct WalletHandle *handle,
  *
  * # Safety
  * The account must be either null or a valid account returned by
- * `wallet_ffi_get_account_public`.
+ * `wallet_ffi_get_account_public`, `wallet_ffi_get_accounts_public` or
+ * `wallet_ffi_get_account_private`.
  */
 void wallet_ffi_free_account_data(struct FfiAccount *account);
 
+/**
+ * Check whether a background job has finished.
+ *
+ * # Parameters
+ * - `job`: Job handle returned by one of the `*_async` functions
+ * - `out_result`: Output pointer for the operation result, may be null for sync jobs
+ *
+ * # Returns
+ * - `JobPending` if the job is still running (`out_result` is left untouched)
+ * - `JobResultTaken` if the result was already collected
+ * - Otherwise the error code the blocking variant of the operation would have returned
+ *
+ * # Memory
+ * The result must be freed with `wallet_ffi_free_transfer_result()`.
+ *
+ * # Safety
+ * - `job` must be a valid job handle that has not been freed
+ * - `out_result` must be null or a valid pointer to a `FfiTransferResult` struct
+ */
+enum WalletFfiError wallet_ffi_job_poll(struct FfiJobHandle *job,
+                                        struct FfiTransferResult *out_result);
+
+/**
+ * Block the calling thread until a background job has finished.
+ *
+ * # Parameters
+ * - `job`: Job handle returned by one of the `*_async` functions
+ * - `out_result`: Output pointer for the operation result, may be null for sync jobs
+ *
+ * # Returns
+ * - `JobResultTaken` if the result was already collected
+ * - Otherwise the error code the blocking variant of the operation would have returned
+ *
+ * # Memory
+ * The result must be freed with `wallet_ffi_free_transfer_result()`.
+ *
+ * # Safety
+ * - `job` must be a valid job handle that has not been freed
+ * - `out_result` must be null or a valid pointer to a `FfiTransferResult` struct
+ */
+enum WalletFfiError wallet_ffi_job_wait(struct FfiJobHandle *job,
+                                        struct FfiTransferResult *out_result);
+
+/**
+ * Free a job handle.
+ *
+ * If the job is still running it keeps running in the background and its
+ * result is discarded.
+ *
+ * # Safety
+ * The job must be either null or a valid job handle that has not been freed.
+ */
+void wallet_ffi_free_job(struct FfiJobHandle *job);
+
 /**
  * Get the public key for a public account.
  *
@@ -597,14 +767,43 @@ enum WalletFfiError wallet_ffi_claim_pinata_private_owned_not_initialized(struct
  * - Error code on other failures
  *
  * # Note
- * This operation can take a while for large block ranges. The wallet
- * internally uses a progress bar which may output to stdout.
+ * This operation can take a while for large block ranges. Other calls on
+ * the same handle keep running while blocks are downloaded.
  *
  * # Safety
  * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
  */
 enum WalletFfiError wallet_ffi_sync_to_block(struct WalletHandle *handle, uint64_t block_id);
 
+/**
+ * Start `wallet_ffi_sync_to_block` as a background job.
+ *
+ * Returns as soon as the job is submitted. Completion is reported through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()`, which return the same
+ * codes as `wallet_ffi_sync_to_block`. The transfer result is not used and
+ * can be passed as null.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `block_id`: Target block number to sync to
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_sync_to_block_async(struct WalletHandle *handle,
+                                                   uint64_t block_id,
+                                                   struct FfiJobHandle **out_job);
+
 /**
  * Get the last synced block number.
  *
@@ -642,6 +841,49 @@ enum WalletFfiError wallet_ffi_get_last_synced_block(struct WalletHandle *handle
 enum WalletFfiError wallet_ffi_get_current_block_height(struct WalletHandle *handle,
                                                         uint64_t *out_block_height);
 
+/**
+ * Subscribe to new blocks pushed by the sequencer.
+ *
+ * Blocks after the last synced block are applied to the wallet as soon as
+ * they are produced, without polling, and `callback` is called after each
+ * of them. Call `wallet_ffi_sync_to_block` first to catch up quickly when
+ * the wallet is far behind.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `callback`: Called from a background thread with `user_data`, see `FfiBlockCallback`
+ * - `user_data`: Opaque pointer passed back to `callback`, may be null
+ * - `out_subscription`: Output pointer for the subscription handle
+ *
+ * # Returns
+ * - `Success` if the subscription was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The subscription must be stopped and freed with `wallet_ffi_unsubscribe_blocks()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed before the subscription is stopped
+ * - `user_data` must be usable from another thread until the subscription is stopped
+ * - `out_subscription` must be a valid pointer to a `FfiBlockSubscription` pointer
+ */
+enum WalletFfiError wallet_ffi_subscribe_blocks(struct WalletHandle *handle,
+                                                FfiBlockCallback callback,
+                                                void *user_data,
+                                                struct FfiBlockSubscription **out_subscription);
+
+/**
+ * Stop a block subscription and free its handle.
+ *
+ * Waits until the subscription has written the synced blocks to storage.
+ *
+ * # Safety
+ * - `subscription` must be either null or a valid subscription handle that has not been freed
+ * - Must not be called from the subscription callback
+ */
+void wallet_ffi_unsubscribe_blocks(struct FfiBlockSubscription *subscription);
+
 /**
  * Send a public token transfer.
  *
@@ -676,6 +918,40 @@ enum WalletFfiError wallet_ffi_transfer_public(struct WalletHandle *handle,
                                                const uint8_t (*amount)[16],
                                                struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_public` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to`: Destination account ID
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to` must be a valid pointer to a `FfiBytes32` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_public_async(struct WalletHandle *handle,
+                                                     const struct FfiBytes32 *from,
+                                                     const struct FfiBytes32 *to,
+                                                     const uint8_t (*amount)[16],
+                                                     struct FfiJobHandle **out_job);
+
 /**
  * Send a shielded token transfer.
  *
@@ -710,6 +986,40 @@ enum WalletFfiError wallet_ffi_transfer_shielded(struct WalletHandle *handle,
                                                  const uint8_t (*amount)[16],
                                                  struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_shielded` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to_keys`: Destination account keys
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to_keys` must be a valid pointer to a `FfiPrivateAccountKeys` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_shielded_async(struct WalletHandle *handle,
+                                                       const struct FfiBytes32 *from,
+                                                       const struct FfiPrivateAccountKeys *to_keys,
+                                                       const uint8_t (*amount)[16],
+                                                       struct FfiJobHandle **out_job);
+
 /**
  * Send a deshielded token transfer.
  *
@@ -744,6 +1054,40 @@ enum WalletFfiError wallet_ffi_transfer_deshielded(struct WalletHandle *handle,
                                                    const uint8_t (*amount)[16],
                                                    struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_deshielded` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to`: Destination account ID
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to` must be a valid pointer to a `FfiBytes32` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_deshielded_async(struct WalletHandle *handle,
+                                                         const struct FfiBytes32 *from,
+                                                         const struct FfiBytes32 *to,
+                                                         const uint8_t (*amount)[16],
+                                                         struct FfiJobHandle **out_job);
+
 /**
  * Send a private token transfer.
  *
@@ -778,6 +1122,40 @@ enum WalletFfiError wallet_ffi_transfer_private(struct WalletHandle *handle,
                                                 const uint8_t (*amount)[16],
                                                 struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_private` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to_keys`: Destination account keys
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to_keys` must be a valid pointer to a `FfiPrivateAccountKeys` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_private_async(struct WalletHandle *handle,
+                                                      const struct FfiBytes32 *from,
+                                                      const struct FfiPrivateAccountKeys *to_keys,
+                                                      const uint8_t (*amount)[16],
+                                                      struct FfiJobHandle **out_job);
+
 /**
  * Send a shielded token transfer to an owned private account.
  *
@@ -815,6 +1193,40 @@ enum WalletFfiError wallet_ffi_transfer_shielded_owned(struct WalletHandle *hand
                                                        const uint8_t (*amount)[16],
                                                        struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_shielded_owned` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to`: Destination private account ID (must be owned by this wallet)
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to` must be a valid pointer to a `FfiBytes32` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_shielded_owned_async(struct WalletHandle *handle,
+                                                             const struct FfiBytes32 *from,
+                                                             const struct FfiBytes32 *to,
+                                                             const uint8_t (*amount)[16],
+                                                             struct FfiJobHandle **out_job);
+
 /**
  * Send a private token transfer to an owned private account.
  *
@@ -852,6 +1264,40 @@ enum WalletFfiError wallet_ffi_transfer_private_owned(struct WalletHandle *handl
                                                       const uint8_t (*amount)[16],
                                                       struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_transfer_private_owned` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `from`: Source account ID (must be owned by this wallet)
+ * - `to`: Destination private account ID (must be owned by this wallet)
+ * - `amount`: Amount to transfer as little-endian [u8; 16]
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `from` must be a valid pointer to a `FfiBytes32` struct
+ * - `to` must be a valid pointer to a `FfiBytes32` struct
+ * - `amount` must be a valid pointer to a `[u8; 16]` array
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_transfer_private_owned_async(struct WalletHandle *handle,
+                                                            const struct FfiBytes32 *from,
+                                                            const struct FfiBytes32 *to,
+                                                            const uint8_t (*amount)[16],
+                                                            struct FfiJobHandle **out_job);
+
 /**
  * Register a public account on the network.
  *
@@ -879,6 +1325,34 @@ enum WalletFfiError wallet_ffi_register_public_account(struct WalletHandle *hand
                                                        const struct FfiBytes32 *account_id,
                                                        struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_register_public_account` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `account_id`: Account ID to register
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `account_id` must be a valid pointer to a `FfiBytes32` struct
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_register_public_account_async(struct WalletHandle *handle,
+                                                             const struct FfiBytes32 *account_id,
+                                                             struct FfiJobHandle **out_job);
+
 /**
  * Register a private account on the network.
  *
@@ -906,6 +1380,34 @@ enum WalletFfiError wallet_ffi_register_private_account(struct WalletHandle *han
                                                         const struct FfiBytes32 *account_id,
                                                         struct FfiTransferResult *out_result);
 
+/**
+ * Start `wallet_ffi_register_private_account` as a background job.
+ *
+ * Returns as soon as the job is submitted. The transfer result is delivered through
+ * `wallet_ffi_job_poll()` or `wallet_ffi_job_wait()` once it completes.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `account_id`: Account ID to register
+ * - `out_job`: Output pointer for the job handle
+ *
+ * # Returns
+ * - `Success` if the job was started
+ * - Error code on failure
+ *
+ * # Memory
+ * The job handle must be freed with `wallet_ffi_free_job()`.
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`, and
+ *   must not be destroyed while the job is running
+ * - `account_id` must be a valid pointer to a `FfiBytes32` struct
+ * - `out_job` must be a valid pointer to a `FfiJobHandle` pointer
+ */
+enum WalletFfiError wallet_ffi_register_private_account_async(struct WalletHandle *handle,
+                                                              const struct FfiBytes32 *account_id,
+                                                              struct FfiJobHandle **out_job);
+
 /**
  * Free a transfer result returned by `wallet_ffi_transfer_public` or
  * `wallet_ffi_register_public_account`.
@@ -1001,6 +1503,24 @@ enum WalletFfiError wallet_ffi_save(struct WalletHandle *handle);
  */
 char *wallet_ffi_get_sequencer_addr(struct WalletHandle *handle);
 
+/**
+ * Get the sync and proving timings since the wallet was opened.
+ *
+ * # Parameters
+ * - `handle`: Valid wallet handle
+ * - `out_stats`: Output pointer for the timings
+ *
+ * # Returns
+ * - `Success` on success
+ * - Error code on failure
+ *
+ * # Safety
+ * - `handle` must be a valid wallet handle from `wallet_ffi_create_new` or `wallet_ffi_open`
+ * - `out_stats` must be a valid pointer to a `FfiWalletStats` struct
+ */
+enum WalletFfiError wallet_ffi_get_stats(struct WalletHandle *handle,
+                                         struct FfiWalletStats *out_stats);
+
 /**
  * Free a string returned by wallet FFI functions.
  *
@@ -0,0 +1,89 @@
+//! Benchmark of syncing private accounts over a synthetic chain of compact blocks.
+//!
+//! Measures everything `WalletCore::sync_to_block` does after fetching the blocks: view tag
+//! matching, trial decryption and account updates.
+
+use common::block::{CompactBlock, CompactOutput};
+use criterion::{BatchSize, BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use nssa_core::{
+    Commitment, EncryptionScheme, NullifierPublicKey, SharedSecretKey,
+    account::Account,
+    encryption::{EphemeralPublicKey, ViewingPublicKey},
+};
+use wallet::WalletCore;
+
+const BLOCKS: u64 = 100;
+const PRIVATE_ACCOUNTS: usize = 16;
+
+/// Private output for some other wallet, as most outputs of a chain are.
+fn synthetic_output(seed: u64, output_index: u32) -> CompactOutput {
+    let mut secret = [7; 32];
+    secret[..8].copy_from_slice(&seed.to_le_bytes());
+
+    let npk = NullifierPublicKey::from(&secret);
+    let vpk = ViewingPublicKey::from_scalar(secret);
+    let account = Account {
+        balance: seed.into(),
+        ..Account::default()
+    };
+    let commitment = Commitment::new(&npk, &account);
+    let shared_secret = SharedSecretKey::new(&secret, &vpk);
+
+    CompactOutput {
+        // Spread over all tags, so some outputs are trial decrypted
+        view_tag: seed as u8,
+        epk: EphemeralPublicKey::from_scalar(secret),
+        ciphertext: EncryptionScheme::encrypt(&account, &shared_secret, &commitment, output_index),
+        commitment,
+        output_index,
+    }
+}
+
+fn synthetic_chain(outputs_per_block: u64) -> Vec<CompactBlock> {
+    (1..=BLOCKS)
+        .map(|block_id| CompactBlock {
+            block_id,
+            outputs: (0..outputs_per_block)
+                .map(|i| synthetic_output(block_id * outputs_per_block + i, (i % 2) as u32))
+                .collect(),
+        })
+        .collect()
+}
+
+fn apply_compact_blocks(c: &mut Criterion) {
+    let home = tempfile::tempdir().unwrap();
+    let mut wallet = WalletCore::new_init_storage(
+        home.path().join("wallet_config.json"),
+        home.path().join("storage.json"),
+        None,
+        "password".to_string(),
+    )
+    .unwrap();
+    for _ in 0..PRIVATE_ACCOUNTS {
+        wallet.create_new_account_private(None);
+    }
+
+    let mut group = c.benchmark_group("apply_compact_blocks");
+    group.sample_size(20);
+
+    for outputs_per_block in [10, 100] {
+        let chain = synthetic_chain(outputs_per_block);
+
+        group.throughput(Throughput::Elements(BLOCKS * outputs_per_block));
+        group.bench_function(BenchmarkId::from_parameter(outputs_per_block), |b| {
+            b.iter_batched(
+                || chain.clone(),
+                |chain| {
+                    wallet.last_synced_block = 0;
+                    wallet.apply_compact_blocks(chain);
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, apply_compact_blocks);
+criterion_main!(benches);
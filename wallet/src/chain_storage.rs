@@ -266,6 +266,11 @@ mod tests {
             seq_tx_poll_max_blocks: 5,
             seq_poll_max_retries: 10,
             seq_block_poll_max_amount: 100,
+            seq_block_poll_prefetch: 4,
+            sync_checkpoint_blocks: 1000,
+            sync_checkpoint_interval: std::time::Duration::from_secs(30),
+            max_parallel_proofs: 4,
+            receipt_cache_size: 64,
             initial_accounts: create_initial_accounts(),
             basic_auth: None,
         }
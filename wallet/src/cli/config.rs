@@ -67,6 +67,30 @@ impl WalletSubcommand for ConfigSubcommand {
                                 wallet_core.storage.wallet_config.seq_block_poll_max_amount
                             );
                         }
+                        "seq_block_poll_prefetch" => {
+                            println!(
+                                "{}",
+                                wallet_core.storage.wallet_config.seq_block_poll_prefetch
+                            );
+                        }
+                        "sync_checkpoint_blocks" => {
+                            println!(
+                                "{}",
+                                wallet_core.storage.wallet_config.sync_checkpoint_blocks
+                            );
+                        }
+                        "sync_checkpoint_interval" => {
+                            println!(
+                                "{:?}",
+                                wallet_core.storage.wallet_config.sync_checkpoint_interval
+                            );
+                        }
+                        "max_parallel_proofs" => {
+                            println!("{}", wallet_core.storage.wallet_config.max_parallel_proofs);
+                        }
+                        "receipt_cache_size" => {
+                            println!("{}", wallet_core.storage.wallet_config.receipt_cache_size);
+                        }
                         "initial_accounts" => {
                             println!("{:#?}", wallet_core.storage.wallet_config.initial_accounts);
                         }
@@ -109,6 +133,24 @@ impl WalletSubcommand for ConfigSubcommand {
                         wallet_core.storage.wallet_config.seq_block_poll_max_amount =
                             value.parse()?;
                     }
+                    "seq_block_poll_prefetch" => {
+                        wallet_core.storage.wallet_config.seq_block_poll_prefetch =
+                            value.parse()?;
+                    }
+                    "sync_checkpoint_blocks" => {
+                        wallet_core.storage.wallet_config.sync_checkpoint_blocks = value.parse()?;
+                    }
+                    "sync_checkpoint_interval" => {
+                        wallet_core.storage.wallet_config.sync_checkpoint_interval =
+                            humantime::parse_duration(&value)
+                                .map_err(|e| anyhow::anyhow!("Invalid duration: {}", e))?;
+                    }
+                    "max_parallel_proofs" => {
+                        wallet_core.storage.wallet_config.max_parallel_proofs = value.parse()?;
+                    }
+                    "receipt_cache_size" => {
+                        wallet_core.storage.wallet_config.receipt_cache_size = value.parse()?;
+                    }
                     "basic_auth" => {
                         wallet_core.storage.wallet_config.basic_auth = Some(value.parse()?);
                     }
@@ -149,6 +191,31 @@ impl WalletSubcommand for ConfigSubcommand {
                         "Sequencer client polling variable: max number of blocks to request in one polling call"
                     );
                 }
+                "seq_block_poll_prefetch" => {
+                    println!(
+                        "Sequencer client polling variable: number of block range requests kept in flight while syncing"
+                    );
+                }
+                "sync_checkpoint_blocks" => {
+                    println!(
+                        "Sync variable: max number of synced blocks between two writes of the wallet storage"
+                    );
+                }
+                "sync_checkpoint_interval" => {
+                    println!(
+                        "Sync variable: max time between two writes of the wallet storage (human readable duration)"
+                    );
+                }
+                "max_parallel_proofs" => {
+                    println!(
+                        "Proving variable: max number of program proofs generated at the same time for a private transaction"
+                    );
+                }
+                "receipt_cache_size" => {
+                    println!(
+                        "Proving variable: number of program receipts kept for reuse by identical program executions"
+                    );
+                }
                 "initial_accounts" => {
                     println!("List of initial accounts' keys(both public and private)");
                 }
@@ -219,6 +219,7 @@ pub async fn execute_keys_restoration(wallet_core: &mut WalletCore, depth: u32)
         .user_data
         .private_key_tree
         .generate_tree_for_depth(depth);
+    wallet_core.update_view_tag_index();
 
     println!("Private tree generated");
 
@@ -248,6 +249,7 @@ pub async fn execute_keys_restoration(wallet_core: &mut WalletCore, depth: u32)
         .user_data
         .private_key_tree
         .cleanup_tree_remove_uninit_layered(depth);
+    wallet_core.update_view_tag_index();
 
     println!("Private tree cleaned up");
 
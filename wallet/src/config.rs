@@ -195,6 +195,21 @@ pub struct WalletConfig {
     pub seq_poll_max_retries: u64,
     /// Max amount of blocks to poll in one request
     pub seq_block_poll_max_amount: u64,
+    /// Number of block range requests kept in flight while syncing
+    #[serde(default = "default_seq_block_poll_prefetch")]
+    pub seq_block_poll_prefetch: usize,
+    /// Max number of synced blocks between two writes of the wallet storage
+    #[serde(default = "default_sync_checkpoint_blocks")]
+    pub sync_checkpoint_blocks: u64,
+    /// Max time between two writes of the wallet storage while syncing
+    #[serde(with = "humantime_serde", default = "default_sync_checkpoint_interval")]
+    pub sync_checkpoint_interval: Duration,
+    /// Max number of program proofs generated at the same time for a private transaction
+    #[serde(default = "default_max_parallel_proofs")]
+    pub max_parallel_proofs: usize,
+    /// Number of program receipts kept for reuse by identical program executions
+    #[serde(default = "default_receipt_cache_size")]
+    pub receipt_cache_size: usize,
     /// Initial accounts for wallet
     pub initial_accounts: Vec<InitialAccountData>,
     /// Basic authentication credentials
@@ -202,6 +217,26 @@ pub struct WalletConfig {
     pub basic_auth: Option<BasicAuth>,
 }
 
+fn default_seq_block_poll_prefetch() -> usize {
+    4
+}
+
+fn default_sync_checkpoint_blocks() -> u64 {
+    1000
+}
+
+fn default_sync_checkpoint_interval() -> Duration {
+    Duration::from_secs(30)
+}
+
+fn default_max_parallel_proofs() -> usize {
+    nssa::privacy_preserving_transaction::circuit::DEFAULT_MAX_PARALLEL_PROOFS
+}
+
+fn default_receipt_cache_size() -> usize {
+    64
+}
+
 impl Default for WalletConfig {
     fn default() -> Self {
         Self {
@@ -211,6 +246,11 @@ impl Default for WalletConfig {
             seq_tx_poll_max_blocks: 5,
             seq_poll_max_retries: 5,
             seq_block_poll_max_amount: 100,
+            seq_block_poll_prefetch: default_seq_block_poll_prefetch(),
+            sync_checkpoint_blocks: default_sync_checkpoint_blocks(),
+            sync_checkpoint_interval: default_sync_checkpoint_interval(),
+            max_parallel_proofs: default_max_parallel_proofs(),
+            receipt_cache_size: default_receipt_cache_size(),
             basic_auth: None,
             initial_accounts: {
                 let init_acc_json = r#"
@@ -546,6 +586,11 @@ impl WalletConfig {
             seq_tx_poll_max_blocks,
             seq_poll_max_retries,
             seq_block_poll_max_amount,
+            seq_block_poll_prefetch,
+            sync_checkpoint_blocks,
+            sync_checkpoint_interval,
+            max_parallel_proofs,
+            receipt_cache_size,
             initial_accounts,
             basic_auth,
         } = self;
@@ -557,6 +602,11 @@ impl WalletConfig {
             seq_tx_poll_max_blocks: o_seq_tx_poll_max_blocks,
             seq_poll_max_retries: o_seq_poll_max_retries,
             seq_block_poll_max_amount: o_seq_block_poll_max_amount,
+            seq_block_poll_prefetch: o_seq_block_poll_prefetch,
+            sync_checkpoint_blocks: o_sync_checkpoint_blocks,
+            sync_checkpoint_interval: o_sync_checkpoint_interval,
+            max_parallel_proofs: o_max_parallel_proofs,
+            receipt_cache_size: o_receipt_cache_size,
             initial_accounts: o_initial_accounts,
             basic_auth: o_basic_auth,
         } = overrides;
@@ -585,6 +635,26 @@ impl WalletConfig {
             warn!("Overriding wallet config 'seq_block_poll_max_amount' to {v}");
             *seq_block_poll_max_amount = v;
         }
+        if let Some(v) = o_seq_block_poll_prefetch {
+            warn!("Overriding wallet config 'seq_block_poll_prefetch' to {v}");
+            *seq_block_poll_prefetch = v;
+        }
+        if let Some(v) = o_sync_checkpoint_blocks {
+            warn!("Overriding wallet config 'sync_checkpoint_blocks' to {v}");
+            *sync_checkpoint_blocks = v;
+        }
+        if let Some(v) = o_sync_checkpoint_interval {
+            warn!("Overriding wallet config 'sync_checkpoint_interval' to {v:?}");
+            *sync_checkpoint_interval = v;
+        }
+        if let Some(v) = o_max_parallel_proofs {
+            warn!("Overriding wallet config 'max_parallel_proofs' to {v}");
+            *max_parallel_proofs = v;
+        }
+        if let Some(v) = o_receipt_cache_size {
+            warn!("Overriding wallet config 'receipt_cache_size' to {v}");
+            *receipt_cache_size = v;
+        }
         if let Some(v) = o_initial_accounts {
             warn!("Overriding wallet config 'initial_accounts' to {v:#?}");
             *initial_accounts = v;
@@ -1,4 +1,9 @@
-use std::{collections::HashMap, path::PathBuf, str::FromStr};
+use std::{
+    collections::HashMap,
+    io::Write as _,
+    path::{Path, PathBuf},
+    str::FromStr,
+};
 
 use anyhow::Result;
 use base64::{Engine, engine::general_purpose::STANDARD as BASE64};
@@ -53,6 +58,28 @@ pub fn fetch_persistent_storage_path() -> Result<PathBuf> {
     Ok(accs_path)
 }
 
+/// Replace the file at `path` with `contents` without leaving a partially written file behind.
+///
+/// Data is written and synced to a uniquely named temporary file next to `path`, which is then
+/// renamed over it, so concurrent writers never share a temporary file.
+pub async fn write_file_atomically(path: &Path, contents: &[u8]) -> Result<()> {
+    let path = path.to_owned();
+    let contents = contents.to_vec();
+
+    tokio::task::spawn_blocking(move || {
+        let dir = match path.parent() {
+            Some(parent) if !parent.as_os_str().is_empty() => parent,
+            _ => Path::new("."),
+        };
+        let mut file = tempfile::NamedTempFile::new_in(dir)?;
+        file.write_all(&contents)?;
+        file.as_file().sync_all()?;
+        file.persist(&path)?;
+        Ok(())
+    })
+    .await?
+}
+
 /// Produces data for storage
 pub fn produce_data_for_storage(
     user_data: &NSSAUserData,
@@ -186,6 +213,38 @@ mod tests {
         }
     }
 
+    #[tokio::test]
+    async fn test_write_file_atomically_replaces_contents() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("storage.json");
+
+        write_file_atomically(&path, b"first").await.unwrap();
+        write_file_atomically(&path, b"second").await.unwrap();
+
+        assert_eq!(std::fs::read(&path).unwrap(), b"second");
+        // No temporary file is left behind
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 1);
+    }
+
+    #[tokio::test]
+    async fn test_concurrent_atomic_writes_never_mix() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("storage.json");
+        let contents = (0..8u8).map(|i| vec![i; 64 * 1024]).collect::<Vec<_>>();
+
+        futures::future::try_join_all(
+            contents
+                .iter()
+                .map(|contents| write_file_atomically(&path, contents)),
+        )
+        .await
+        .unwrap();
+
+        let written = std::fs::read(&path).unwrap();
+        assert!(contents.contains(&written));
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 1);
+    }
+
     #[test]
     fn test_addr_parse_with_privacy() {
         let addr_base58 = "Public/BLgCRDXYdQPMMWVHYRFGQZbgeHx9frkipa8GtpG2Syqy";
@@ -1,29 +1,40 @@
-use std::{path::PathBuf, sync::Arc};
+use std::{collections::HashMap, path::PathBuf, sync::Arc};
 
 use anyhow::{Context, Result};
 use base64::{Engine, engine::general_purpose::STANDARD as BASE64};
 use chain_storage::WalletChainStore;
 use common::{
-    HashType, error::ExecutionFailureKind, rpc_primitives::requests::SendTxResponse,
-    sequencer_client::SequencerClient, transaction::NSSATransaction,
+    HashType,
+    block::{BlockId, CompactBlock, CompactOutput, HashableBlockData},
+    error::ExecutionFailureKind,
+    rpc_primitives::{MAX_ACCOUNTS_PER_REQUEST, requests::SendTxResponse},
+    sequencer_client::SequencerClient,
+    transaction::NSSATransaction,
 };
 use config::WalletConfig;
-use key_protocol::key_management::key_tree::{chain_index::ChainIndex, traits::KeyNode as _};
+use key_protocol::{
+    key_management::{KeyChain, key_tree::chain_index::ChainIndex},
+    key_protocol_core::NSSAUserData,
+};
 use log::info;
 use nssa::{
     Account, AccountId, PrivacyPreservingTransaction,
     privacy_preserving_transaction::{
-        circuit::ProgramWithDependencies, message::EncryptedAccountData,
+        circuit::{CircuitProver, ProgramWithDependencies},
+        message::{EncryptedAccountData, ViewTag},
+        prover::{ProvingBackend, ReceiptCache},
     },
 };
 use nssa_core::{Commitment, MembershipProof, SharedSecretKey, program::InstructionData};
 pub use privacy_preserving_tx::PrivacyPreservingAccount;
+use rayon::prelude::*;
 use tokio::io::AsyncWriteExt;
 
 use crate::{
     config::{PersistentStorage, WalletConfigOverrides},
     helperfunctions::{produce_data_for_storage, produce_random_nonces},
     poller::TxPoller,
+    stats::WalletStats,
 };
 
 pub const HOME_DIR_ENV_VAR: &str = "NSSA_WALLET_HOME_DIR";
@@ -35,18 +46,94 @@ pub mod helperfunctions;
 pub mod poller;
 mod privacy_preserving_tx;
 pub mod program_facades;
+pub mod stats;
 
 pub enum AccDecodeData {
     Skip,
     Decode(nssa_core::SharedSecretKey, AccountId),
 }
 
+/// Decides when a running sync writes the wallet storage to disk.
+///
+/// Storage is written at most every `sync_checkpoint_blocks` blocks or `sync_checkpoint_interval`,
+/// whichever comes first, instead of after every block.
+pub struct SyncCheckpoint {
+    max_blocks: u64,
+    max_interval: std::time::Duration,
+    stored_block: u64,
+    stored_at: std::time::Instant,
+}
+
+impl SyncCheckpoint {
+    pub fn new(config: &WalletConfig, last_synced_block: u64) -> Self {
+        Self {
+            max_blocks: config.sync_checkpoint_blocks,
+            max_interval: config.sync_checkpoint_interval,
+            stored_block: last_synced_block,
+            stored_at: std::time::Instant::now(),
+        }
+    }
+
+    /// Whether blocks were synced since the last write.
+    pub fn is_dirty(&self, last_synced_block: u64) -> bool {
+        last_synced_block > self.stored_block
+    }
+
+    /// Whether the storage should be written now.
+    pub fn is_due(&self, last_synced_block: u64) -> bool {
+        self.is_dirty(last_synced_block)
+            && (last_synced_block - self.stored_block >= self.max_blocks
+                || self.stored_at.elapsed() >= self.max_interval)
+    }
+
+    /// Record that the storage was written at `last_synced_block`.
+    pub fn mark(&mut self, last_synced_block: u64) {
+        self.stored_block = last_synced_block;
+        self.stored_at = std::time::Instant::now();
+    }
+}
+
+/// Private accounts decrypted from synced blocks, see [`WalletCore::decrypt_compact_blocks`]
+pub struct DecryptedBlocks {
+    blocks: Vec<CompactBlock>,
+    /// Decrypted post states with the id of their block, in block order
+    accounts: Vec<(BlockId, AccountId, Account)>,
+    key_set_version: u64,
+}
+
+/// Serialized persistent data of a [`WalletCore`]
+pub struct PersistentDataSnapshot {
+    storage_path: PathBuf,
+    storage: Vec<u8>,
+}
+
+impl PersistentDataSnapshot {
+    /// Write the data to the storage path of the wallet it was taken from
+    pub async fn write(&self) -> Result<()> {
+        // Write through a temporary file so a crash mid-write never leaves a truncated storage
+        helperfunctions::write_file_atomically(&self.storage_path, &self.storage).await?;
+
+        println!("Stored persistent accounts at {:#?}", self.storage_path);
+
+        Ok(())
+    }
+}
+
 pub struct WalletCore {
     config_path: PathBuf,
     config_overrides: Option<WalletConfigOverrides>,
     storage: WalletChainStore,
     storage_path: PathBuf,
     poller: TxPoller,
+    /// View tags of private accounts, computed once per account.
+    view_tags: HashMap<AccountId, ViewTag>,
+    /// Private accounts by view tag, kept up to date as accounts are added and removed.
+    view_tag_index: HashMap<ViewTag, Vec<AccountId>>,
+    /// Bumped whenever a private account is added to or removed from `view_tag_index`.
+    key_set_version: u64,
+    /// Prover of private transactions, with program receipts cached across transactions.
+    circuit_prover: CircuitProver,
+    stats: Arc<WalletStats>,
     // TODO: Make all fields private
     pub sequencer_client: Arc<SequencerClient>,
     pub last_synced_block: u64,
@@ -115,18 +202,29 @@ impl WalletCore {
             config.basic_auth.clone(),
         )?);
         let tx_poller = TxPoller::new(config.clone(), Arc::clone(&sequencer_client));
+        let circuit_prover = CircuitProver::default()
+            .with_max_parallel_proofs(config.max_parallel_proofs)
+            .with_receipt_cache(Arc::new(ReceiptCache::new(config.receipt_cache_size)));
 
         let storage = storage_ctor(config)?;
 
-        Ok(Self {
+        let mut wallet = Self {
             config_path,
             storage_path,
             storage,
             poller: tx_poller,
+            view_tags: HashMap::new(),
+            view_tag_index: HashMap::new(),
+            key_set_version: 0,
+            circuit_prover,
+            stats: Arc::default(),
             sequencer_client,
             last_synced_block,
             config_overrides,
-        })
+        };
+        wallet.update_view_tag_index();
+
+        Ok(wallet)
     }
 
     /// Get configuration with applied overrides
@@ -134,6 +232,12 @@ impl WalletCore {
         &self.storage.wallet_config
     }
 
+    /// Generate the proofs of private transactions with `backend`, for example a remote proving
+    /// service, instead of the default risc0 prover.
+    pub fn set_proving_backend(&mut self, backend: Arc<dyn ProvingBackend>) {
+        self.circuit_prover = self.circuit_prover.clone().with_backend(backend);
+    }
+
     /// Get storage
     pub fn storage(&self) -> &WalletChainStore {
         &self.storage
@@ -142,26 +246,54 @@ impl WalletCore {
     /// Reset storage
     pub fn reset_storage(&mut self, password: String) -> Result<()> {
         self.storage = WalletChainStore::new_storage(self.storage.wallet_config.clone(), password)?;
+        self.view_tags.clear();
+        self.view_tag_index.clear();
+        self.key_set_version += 1;
+        self.update_view_tag_index();
         Ok(())
     }
 
     /// Store persistent data at home
     pub async fn store_persistent_data(&self) -> Result<()> {
+        self.persistent_data_snapshot()?.write().await
+    }
+
+    /// Serialize persistent data, to be written by [`PersistentDataSnapshot::write`] once the
+    /// wallet is no longer borrowed
+    pub fn persistent_data_snapshot(&self) -> Result<PersistentDataSnapshot> {
         let data = produce_data_for_storage(
             &self.storage.user_data,
             self.last_synced_block,
             self.storage.labels.clone(),
         );
-        let storage = serde_json::to_vec_pretty(&data)?;
-
-        let mut storage_file = tokio::fs::File::create(&self.storage_path).await?;
-        storage_file.write_all(&storage).await?;
-        // Ensure data is flushed to disk before returning to prevent race conditions
-        storage_file.sync_all().await?;
 
-        println!("Stored persistent accounts at {:#?}", self.storage_path);
+        Ok(PersistentDataSnapshot {
+            storage_path: self.storage_path.clone(),
+            storage: serde_json::to_vec_pretty(&data)?,
+        })
+    }
 
-        Ok(())
+    /// Wallet holding only the keys of `account_ids`, to send transactions of these accounts
+    /// without borrowing this wallet while they are proven and submitted
+    pub fn detach_accounts(&self, account_ids: &[AccountId]) -> Self {
+        Self {
+            config_path: self.config_path.clone(),
+            config_overrides: self.config_overrides.clone(),
+            storage: WalletChainStore {
+                user_data: self.storage.user_data.subset(account_ids),
+                wallet_config: self.storage.wallet_config.clone(),
+                labels: HashMap::new(),
+            },
+            storage_path: self.storage_path.clone(),
+            poller: self.poller.clone(),
+            view_tags: HashMap::new(),
+            view_tag_index: HashMap::new(),
+            key_set_version: 0,
+            circuit_prover: self.circuit_prover.clone(),
+            stats: Arc::clone(&self.stats),
+            sequencer_client: Arc::clone(&self.sequencer_client),
+            last_synced_block: self.last_synced_block,
+        }
     }
 
     /// Store persistent data at home
@@ -191,9 +323,13 @@ impl WalletCore {
         &mut self,
         chain_index: Option<ChainIndex>,
     ) -> (AccountId, ChainIndex) {
-        self.storage
+        let (account_id, chain_index) = self
+            .storage
             .user_data
-            .generate_new_privacy_preserving_transaction_key_chain(chain_index)
+            .generate_new_privacy_preserving_transaction_key_chain(chain_index);
+        self.index_private_account(account_id);
+
+        (account_id, chain_index)
     }
 
     /// Get account balance
@@ -220,6 +356,20 @@ impl WalletCore {
         Ok(response.account)
     }
 
+    /// Get several accounts, in the order of `account_ids`, with one request per
+    /// [`MAX_ACCOUNTS_PER_REQUEST`] accounts
+    pub async fn get_accounts_public(&self, account_ids: Vec<AccountId>) -> Result<Vec<Account>> {
+        let mut accounts = Vec::with_capacity(account_ids.len());
+        for account_ids in account_ids.chunks(MAX_ACCOUNTS_PER_REQUEST) {
+            let response = self
+                .sequencer_client
+                .get_accounts(account_ids.to_vec())
+                .await?;
+            accounts.extend(response.accounts);
+        }
+        Ok(accounts)
+    }
+
     pub fn get_account_public_signing_key(
         &self,
         account_id: AccountId,
@@ -328,20 +478,24 @@ impl WalletCore {
         )?;
 
         let private_account_keys = acc_manager.private_account_keys();
-        let (output, proof) = nssa::privacy_preserving_transaction::circuit::execute_and_prove(
-            pre_states,
-            instruction_data,
-            acc_manager.visibility_mask().to_vec(),
-            produce_random_nonces(private_account_keys.len()),
-            private_account_keys
-                .iter()
-                .map(|keys| (keys.npk.clone(), keys.ssk))
-                .collect::<Vec<_>>(),
-            acc_manager.private_account_auth(),
-            acc_manager.private_account_membership_proofs(),
-            &program.to_owned(),
-        )
-        .unwrap();
+        let before_proving = std::time::Instant::now();
+        let (output, proof) = self
+            .circuit_prover
+            .execute_and_prove(
+                pre_states,
+                instruction_data,
+                acc_manager.visibility_mask().to_vec(),
+                produce_random_nonces(private_account_keys.len()),
+                private_account_keys
+                    .iter()
+                    .map(|keys| (keys.npk.clone(), keys.ssk))
+                    .collect::<Vec<_>>(),
+                acc_manager.private_account_auth(),
+                acc_manager.private_account_membership_proofs(),
+                &program.to_owned(),
+            )
+            .unwrap();
+        self.stats.proving.record(before_proving.elapsed());
 
         let message =
             nssa::privacy_preserving_transaction::message::Message::try_from_circuit_output(
@@ -386,87 +540,211 @@ impl WalletCore {
         println!("Syncing to block {block_id}. Blocks to sync: {num_of_blocks}");
 
         let poller = self.poller.clone();
-        let mut blocks =
-            std::pin::pin!(poller.poll_block_range(self.last_synced_block + 1..=block_id));
+        let mut chunks =
+            std::pin::pin!(poller.poll_compact_block_chunks(self.last_synced_block + 1..=block_id));
 
+        let mut checkpoint =
+            SyncCheckpoint::new(&self.storage.wallet_config, self.last_synced_block);
         let bar = indicatif::ProgressBar::new(num_of_blocks);
-        while let Some(block) = blocks.try_next().await? {
-            for tx in block.transactions {
-                self.sync_private_accounts_with_tx(tx);
+        loop {
+            let blocks = match chunks.try_next().await {
+                Ok(Some(blocks)) => blocks,
+                Ok(None) => break,
+                Err(err) => {
+                    // Keep the progress made so far before bailing out
+                    if checkpoint.is_dirty(self.last_synced_block) {
+                        self.store_persistent_data().await?;
+                    }
+                    return Err(err);
+                }
+            };
+
+            let num_of_blocks = blocks.len() as u64;
+            self.apply_compact_blocks(blocks);
+            bar.inc(num_of_blocks);
+
+            if checkpoint.is_due(self.last_synced_block) {
+                self.store_persistent_data().await?;
+                checkpoint.mark(self.last_synced_block);
             }
+        }
+        bar.finish();
 
-            self.last_synced_block = block.block_id;
+        if checkpoint.is_dirty(self.last_synced_block) {
             self.store_persistent_data().await?;
-            bar.inc(1);
         }
-        bar.finish();
 
-        println!(
-            "Synced to block {block_id} in {:?}",
-            before_polling.elapsed()
-        );
+        let elapsed = before_polling.elapsed();
+        self.stats.record_sync(elapsed, num_of_blocks);
+        println!("Synced to block {block_id} in {elapsed:?}");
 
         Ok(())
     }
 
-    fn sync_private_accounts_with_tx(&mut self, tx: NSSATransaction) {
-        let NSSATransaction::PrivacyPreserving(tx) = tx else {
-            return;
-        };
+    /// Poller for fetching blocks, sharing this wallet's sequencer client.
+    ///
+    /// Lets callers download blocks without borrowing the wallet, and then
+    /// apply them with [`Self::apply_synced_block`].
+    pub fn block_poller(&self) -> TxPoller {
+        self.poller.clone()
+    }
 
-        let private_account_key_chains = self
-            .storage
-            .user_data
-            .default_user_private_accounts
+    /// Sync and proving timings since the wallet was opened.
+    ///
+    /// Shared, so callers that sync through [`Self::block_poller`] can record their syncs.
+    pub fn stats(&self) -> Arc<WalletStats> {
+        Arc::clone(&self.stats)
+    }
+
+    /// Update private accounts from `block` and advance `last_synced_block`.
+    ///
+    /// Blocks at or below `last_synced_block` are ignored, so applying the same block twice is a
+    /// no-op.
+    pub fn apply_synced_block(&mut self, block: HashableBlockData) {
+        self.apply_synced_blocks(vec![block]);
+    }
+
+    /// Update private accounts from consecutive `blocks` and advance `last_synced_block`.
+    ///
+    /// Blocks at or below `last_synced_block` are ignored.
+    pub fn apply_synced_blocks(&mut self, blocks: Vec<HashableBlockData>) {
+        self.apply_compact_blocks(blocks.iter().map(CompactBlock::from).collect());
+    }
+
+    /// Update private accounts from consecutive compact `blocks` and advance `last_synced_block`.
+    ///
+    /// Blocks at or below `last_synced_block` are ignored.
+    pub fn apply_compact_blocks(&mut self, blocks: Vec<CompactBlock>) {
+        let decrypted = self.decrypt_compact_blocks(blocks);
+        self.apply_decrypted_blocks(decrypted);
+    }
+
+    /// Trial-decrypt the outputs of consecutive compact `blocks` with the private accounts' keys.
+    ///
+    /// Only needs to borrow the wallet, so callers sharing it can decrypt under a read lock and
+    /// take the write lock only for [`Self::apply_decrypted_blocks`]. Trial decryption is spread
+    /// across worker threads. Blocks at or below `last_synced_block` are ignored.
+    pub fn decrypt_compact_blocks(&self, blocks: Vec<CompactBlock>) -> DecryptedBlocks {
+        let blocks = blocks
+            .into_iter()
+            .filter(|block| block.block_id > self.last_synced_block)
+            .collect::<Vec<_>>();
+
+        let outputs = blocks
             .iter()
-            .map(|(acc_account_id, (key_chain, _))| (*acc_account_id, key_chain, None))
-            .chain(self.storage.user_data.private_key_tree.key_map.iter().map(
-                |(chain_index, keys_node)| {
-                    (
-                        keys_node.account_id(),
-                        &keys_node.value.0,
-                        chain_index.index(),
-                    )
-                },
-            ));
-
-        let affected_accounts = private_account_key_chains
-            .flat_map(|(acc_account_id, key_chain, index)| {
-                let view_tag = EncryptedAccountData::compute_view_tag(
-                    key_chain.nullifer_public_key.clone(),
-                    key_chain.viewing_public_key.clone(),
-                );
-
-                tx.message()
-                    .encrypted_private_post_states
-                    .iter()
-                    .enumerate()
-                    .filter(move |(_, encrypted_data)| encrypted_data.view_tag == view_tag)
-                    .filter_map(|(ciph_id, encrypted_data)| {
-                        let ciphertext = &encrypted_data.ciphertext;
-                        let commitment = &tx.message.new_commitments[ciph_id];
-                        let shared_secret = key_chain
-                            .calculate_shared_secret_receiver(encrypted_data.epk.clone(), index);
-
-                        nssa_core::EncryptionScheme::decrypt(
-                            ciphertext,
-                            &shared_secret,
-                            commitment,
-                            ciph_id as u32,
-                        )
-                    })
-                    .map(move |res_acc| (acc_account_id, res_acc))
-                    .collect::<Vec<_>>()
+            .flat_map(|block| block.outputs.iter().map(|output| (block.block_id, output)))
+            .collect::<Vec<_>>();
+
+        let key_chains = PrivateKeyChains {
+            index: &self.view_tag_index,
+            user_data: &self.storage.user_data,
+        };
+        let accounts = outputs
+            .par_iter()
+            .flat_map_iter(|&(block_id, output)| {
+                decrypt_private_accounts(&key_chains, output)
+                    .into_iter()
+                    .map(move |(account_id, account)| (block_id, account_id, account))
             })
             .collect::<Vec<_>>();
 
-        for (affected_account_id, new_acc) in affected_accounts {
+        DecryptedBlocks {
+            blocks,
+            accounts,
+            key_set_version: self.key_set_version,
+        }
+    }
+
+    /// Apply private accounts decrypted by [`Self::decrypt_compact_blocks`] and advance
+    /// `last_synced_block`.
+    ///
+    /// Blocks applied in the meantime are skipped. If private accounts were added or removed since
+    /// decrypting, the blocks are decrypted again with the current keys.
+    pub fn apply_decrypted_blocks(&mut self, decrypted: DecryptedBlocks) {
+        let decrypted = if decrypted.key_set_version == self.key_set_version {
+            decrypted
+        } else {
+            self.decrypt_compact_blocks(decrypted.blocks)
+        };
+        let Some(last_block_id) = decrypted.blocks.last().map(|block| block.block_id) else {
+            return;
+        };
+
+        for (block_id, affected_account_id, new_acc) in decrypted.accounts {
+            if block_id <= self.last_synced_block {
+                continue;
+            }
             info!(
                 "Received new account for account_id {affected_account_id:#?} with account object {new_acc:#?}"
             );
             self.storage
                 .insert_private_account_data(affected_account_id, new_acc);
         }
+
+        self.last_synced_block = self.last_synced_block.max(last_block_id);
+    }
+
+    /// Bring the view tag index in line with the private accounts of the storage.
+    ///
+    /// Only accounts added or removed since the last update are touched. Call after changing the
+    /// key trees directly, for example when restoring keys.
+    pub fn update_view_tag_index(&mut self) {
+        let user_data = &self.storage.user_data;
+        let removed = self
+            .view_tags
+            .keys()
+            .filter(|account_id| user_data.get_private_account(**account_id).is_none())
+            .copied()
+            .collect::<Vec<_>>();
+        let account_ids = user_data
+            .default_user_private_accounts
+            .keys()
+            .chain(user_data.private_key_tree.account_id_map.keys())
+            .copied()
+            .collect::<Vec<_>>();
+
+        for account_id in removed {
+            self.forget_private_account(account_id);
+        }
+        for account_id in account_ids {
+            self.index_private_account(account_id);
+        }
+    }
+
+    /// Add a private account to the view tag index, computing its view tag if it is not known.
+    fn index_private_account(&mut self, account_id: AccountId) {
+        if self.view_tags.contains_key(&account_id) {
+            return;
+        }
+        let Some((key_chain, _)) = self.storage.user_data.get_private_account(account_id) else {
+            return;
+        };
+
+        let view_tag = EncryptedAccountData::compute_view_tag(
+            key_chain.nullifer_public_key.clone(),
+            key_chain.viewing_public_key.clone(),
+        );
+        self.view_tags.insert(account_id, view_tag);
+        self.view_tag_index
+            .entry(view_tag)
+            .or_default()
+            .push(account_id);
+        self.key_set_version += 1;
+    }
+
+    /// Drop a removed private account from the view tag index.
+    fn forget_private_account(&mut self, account_id: AccountId) {
+        let Some(view_tag) = self.view_tags.remove(&account_id) else {
+            return;
+        };
+        self.key_set_version += 1;
+
+        if let Some(account_ids) = self.view_tag_index.get_mut(&view_tag) {
+            account_ids.retain(|indexed| *indexed != account_id);
+            if account_ids.is_empty() {
+                self.view_tag_index.remove(&view_tag);
+            }
+        }
     }
 
     pub fn config_path(&self) -> &PathBuf {
@@ -481,3 +759,194 @@ impl WalletCore {
         &self.config_overrides
     }
 }
+
+struct PrivateAccountKeyChain<'a> {
+    account_id: AccountId,
+    key_chain: &'a KeyChain,
+    index: Option<u32>,
+}
+
+/// Key chains of the private accounts of a wallet, looked up by view tag.
+struct PrivateKeyChains<'a> {
+    index: &'a HashMap<ViewTag, Vec<AccountId>>,
+    user_data: &'a NSSAUserData,
+}
+
+impl<'a> PrivateKeyChains<'a> {
+    /// Key chains of the accounts whose view tag is `view_tag`.
+    fn with_view_tag(
+        &self,
+        view_tag: &ViewTag,
+    ) -> impl Iterator<Item = PrivateAccountKeyChain<'a>> {
+        let user_data = self.user_data;
+
+        self.index
+            .get(view_tag)
+            .into_iter()
+            .flatten()
+            .filter_map(move |&account_id| {
+                if let Some((key_chain, _)) =
+                    user_data.default_user_private_accounts.get(&account_id)
+                {
+                    return Some(PrivateAccountKeyChain {
+                        account_id,
+                        key_chain,
+                        index: None,
+                    });
+                }
+
+                let tree = &user_data.private_key_tree;
+                let chain_index = tree.account_id_map.get(&account_id)?;
+                let keys_node = tree.key_map.get(chain_index)?;
+                Some(PrivateAccountKeyChain {
+                    account_id,
+                    key_chain: &keys_node.value.0,
+                    index: chain_index.index(),
+                })
+            })
+    }
+}
+
+/// Trial-decrypt a private post state with the key chains whose view tag matches.
+fn decrypt_private_accounts(
+    key_chains: &PrivateKeyChains<'_>,
+    output: &CompactOutput,
+) -> Vec<(AccountId, Account)> {
+    key_chains
+        .with_view_tag(&output.view_tag)
+        .filter_map(|chain| {
+            let shared_secret = chain
+                .key_chain
+                .calculate_shared_secret_receiver(output.epk.clone(), chain.index);
+
+            nssa_core::EncryptionScheme::decrypt(
+                &output.ciphertext,
+                &shared_secret,
+                &output.commitment,
+                output.output_index,
+            )
+            .map(|res_acc| (chain.account_id, res_acc))
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use key_protocol::key_management::ephemeral_key_holder::EphemeralKeyHolder;
+
+    use super::*;
+
+    fn new_wallet(home: &std::path::Path) -> WalletCore {
+        WalletCore::new_init_storage(
+            home.join("wallet_config.json"),
+            home.join("storage.json"),
+            None,
+            "password".to_string(),
+        )
+        .unwrap()
+    }
+
+    /// Output of a private transaction giving `account` to private account `account_id`.
+    fn output_for(wallet: &WalletCore, account_id: AccountId, account: &Account) -> CompactOutput {
+        let (key_chain, _) = wallet
+            .storage
+            .user_data
+            .get_private_account(account_id)
+            .cloned()
+            .unwrap();
+        let npk = key_chain.nullifer_public_key;
+        let vpk = key_chain.viewing_public_key;
+        let commitment = Commitment::new(&npk, account);
+        let eph_holder = EphemeralKeyHolder::new(&npk);
+
+        CompactOutput {
+            view_tag: EncryptedAccountData::compute_view_tag(npk, vpk.clone()),
+            epk: eph_holder.generate_ephemeral_public_key(),
+            ciphertext: nssa_core::EncryptionScheme::encrypt(
+                account,
+                &eph_holder.calculate_shared_secret_sender(&vpk),
+                &commitment,
+                0,
+            ),
+            commitment,
+            output_index: 0,
+        }
+    }
+
+    #[test]
+    fn test_new_private_account_is_synced_without_rebuilding_view_tags() {
+        let home = tempfile::tempdir().unwrap();
+        let mut wallet = new_wallet(home.path());
+        let indexed_accounts = wallet.view_tags.len();
+
+        let (account_id, _) = wallet.create_new_account_private(None);
+        assert_eq!(wallet.view_tags.len(), indexed_accounts + 1);
+
+        let account = Account {
+            balance: 42,
+            ..Account::default()
+        };
+        let output = output_for(&wallet, account_id, &account);
+
+        wallet.apply_compact_blocks(vec![CompactBlock {
+            block_id: 1,
+            outputs: vec![output],
+        }]);
+
+        assert_eq!(wallet.get_account_private(account_id), Some(account));
+        assert_eq!(wallet.last_synced_block, 1);
+    }
+
+    #[test]
+    fn test_decrypted_blocks_are_redone_when_keys_change() {
+        let home = tempfile::tempdir().unwrap();
+        let mut wallet = new_wallet(home.path());
+        let mut other_wallet = new_wallet(home.path());
+        let (account_id, _) = other_wallet.create_new_account_private(None);
+
+        let account = Account {
+            balance: 42,
+            ..Account::default()
+        };
+        let blocks = vec![CompactBlock {
+            block_id: 1,
+            outputs: vec![output_for(&other_wallet, account_id, &account)],
+        }];
+
+        // Both wallets share the seed, so the account is created again after decrypting
+        let decrypted = wallet.decrypt_compact_blocks(blocks);
+        assert_eq!(wallet.create_new_account_private(None).0, account_id);
+        wallet.apply_decrypted_blocks(decrypted);
+
+        assert_eq!(wallet.get_account_private(account_id), Some(account));
+        assert_eq!(wallet.last_synced_block, 1);
+    }
+
+    #[test]
+    fn test_decrypted_blocks_skip_blocks_applied_meanwhile() {
+        let home = tempfile::tempdir().unwrap();
+        let mut wallet = new_wallet(home.path());
+        let (account_id, _) = wallet.create_new_account_private(None);
+
+        let first = Account {
+            balance: 1,
+            ..Account::default()
+        };
+        let second = Account {
+            balance: 2,
+            ..Account::default()
+        };
+        let block = |block_id, account| CompactBlock {
+            block_id,
+            outputs: vec![output_for(&wallet, account_id, account)],
+        };
+        let stale = wallet.decrypt_compact_blocks(vec![block(1, &first)]);
+        let fresh = block(2, &second);
+
+        wallet.apply_compact_blocks(vec![fresh]);
+        wallet.apply_decrypted_blocks(stale);
+
+        assert_eq!(wallet.get_account_private(account_id), Some(second));
+        assert_eq!(wallet.last_synced_block, 2);
+    }
+}
@@ -1,7 +1,13 @@
 use std::{sync::Arc, time::Duration};
 
 use anyhow::Result;
-use common::{HashType, block::HashableBlockData, sequencer_client::SequencerClient};
+use common::{
+    HashType,
+    block::{CompactBlock, HashableBlockData},
+    rpc_primitives::MAX_BLOCKS_PER_READ,
+    sequencer_client::SequencerClient,
+};
+use futures::{StreamExt as _, TryStreamExt as _};
 use log::{info, warn};
 
 use crate::config::WalletConfig;
@@ -13,6 +19,7 @@ pub struct TxPoller {
     polling_max_error_attempts: u64,
     polling_delay: Duration,
     block_poll_max_amount: u64,
+    block_poll_prefetch: usize,
     client: Arc<SequencerClient>,
 }
 
@@ -23,6 +30,7 @@ impl TxPoller {
             polling_max_blocks_to_query: config.seq_tx_poll_max_blocks,
             polling_max_error_attempts: config.seq_poll_max_retries,
             block_poll_max_amount: config.seq_block_poll_max_amount,
+            block_poll_prefetch: config.seq_block_poll_prefetch.max(1),
             client: client.clone(),
         }
     }
@@ -71,23 +79,62 @@ impl TxPoller {
         &self,
         range: std::ops::RangeInclusive<u64>,
     ) -> impl futures::Stream<Item = Result<HashableBlockData>> {
-        async_stream::stream! {
-            let mut chunk_start = *range.start();
+        self.poll_block_chunks(range)
+            .map_ok(|blocks| futures::stream::iter(blocks.into_iter().map(Ok::<_, anyhow::Error>)))
+            .try_flatten()
+    }
 
-            loop {
-                let chunk_end = std::cmp::min(chunk_start + self.block_poll_max_amount - 1, *range.end());
+    /// Poll `range` in chunks of at most `block_poll_max_amount` blocks, and at most the
+    /// [`MAX_BLOCKS_PER_READ`] blocks the sequencer serves per request.
+    ///
+    /// Up to `block_poll_prefetch` chunk requests are kept in flight at once, so the next chunks
+    /// are downloaded while the caller processes the current one. Chunks are yielded in order.
+    pub fn poll_block_chunks(
+        &self,
+        range: std::ops::RangeInclusive<u64>,
+    ) -> impl futures::Stream<Item = Result<Vec<HashableBlockData>>> {
+        let client = Arc::clone(&self.client);
+        self.poll_chunks(range, move |chunk| {
+            let client = Arc::clone(&client);
+            async move { Ok(client.get_block_range_binary(chunk).await?) }
+        })
+    }
 
-                let blocks = self.client.get_block_range(chunk_start..=chunk_end).await?.blocks;
-                for block in blocks {
-                    let block = borsh::from_slice::<HashableBlockData>(&block)?;
-                    yield Ok(block);
-                }
+    /// Poll the compact blocks of `range`, in chunks like [`Self::poll_block_chunks`].
+    ///
+    /// Compact blocks hold everything needed to sync private accounts, at a fraction of the size
+    /// of full blocks.
+    pub fn poll_compact_block_chunks(
+        &self,
+        range: std::ops::RangeInclusive<u64>,
+    ) -> impl futures::Stream<Item = Result<Vec<CompactBlock>>> {
+        let client = Arc::clone(&self.client);
+        self.poll_chunks(range, move |chunk| {
+            let client = Arc::clone(&client);
+            async move { Ok(client.get_compact_block_range(chunk, None).await?) }
+        })
+    }
 
-                chunk_start = chunk_end + 1;
-                if chunk_start > *range.end() {
-                    break;
-                }
-            }
-        }
+    fn poll_chunks<T, F>(
+        &self,
+        range: std::ops::RangeInclusive<u64>,
+        fetch: impl FnMut(std::ops::RangeInclusive<u64>) -> F,
+    ) -> impl futures::Stream<Item = Result<Vec<T>>>
+    where
+        F: Future<Output = Result<Vec<T>>>,
+    {
+        let chunk_size = self.block_poll_max_amount.clamp(1, MAX_BLOCKS_PER_READ);
+        let range_end = *range.end();
+        let chunks = std::iter::successors(Some(*range.start()), move |chunk_start| {
+            chunk_start.checked_add(chunk_size)
+        })
+        .take_while(move |chunk_start| *chunk_start <= range_end)
+        .map(move |chunk_start| {
+            chunk_start..=std::cmp::min(chunk_start.saturating_add(chunk_size - 1), range_end)
+        });
+
+        futures::stream::iter(chunks)
+            .map(fetch)
+            .buffered(self.block_poll_prefetch)
     }
 }
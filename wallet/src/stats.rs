@@ -0,0 +1,86 @@
+//! Timings of the wallet's slow operations, for hosts that embed the wallet to report.
+
+use std::{
+    sync::atomic::{AtomicU64, Ordering},
+    time::Duration,
+};
+
+/// Count and durations of one kind of operation.
+///
+/// Updated without locking, so a snapshot taken during an update may mix old and new values.
+#[derive(Debug, Default)]
+pub struct OperationTimings {
+    count: AtomicU64,
+    total_micros: AtomicU64,
+    last_micros: AtomicU64,
+    max_micros: AtomicU64,
+}
+
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct OperationTimingsSnapshot {
+    pub count: u64,
+    pub total_micros: u64,
+    pub last_micros: u64,
+    pub max_micros: u64,
+}
+
+impl OperationTimings {
+    pub fn record(&self, elapsed: Duration) {
+        let micros = u64::try_from(elapsed.as_micros()).unwrap_or(u64::MAX);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.total_micros.fetch_add(micros, Ordering::Relaxed);
+        self.last_micros.store(micros, Ordering::Relaxed);
+        self.max_micros.fetch_max(micros, Ordering::Relaxed);
+    }
+
+    pub fn snapshot(&self) -> OperationTimingsSnapshot {
+        OperationTimingsSnapshot {
+            count: self.count.load(Ordering::Relaxed),
+            total_micros: self.total_micros.load(Ordering::Relaxed),
+            last_micros: self.last_micros.load(Ordering::Relaxed),
+            max_micros: self.max_micros.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Timings since the wallet was opened.
+#[derive(Debug, Default)]
+pub struct WalletStats {
+    /// Completed syncs, from the first downloaded block to the last applied one
+    pub sync: OperationTimings,
+    /// Blocks applied by completed syncs
+    pub synced_blocks: AtomicU64,
+    /// Proofs of private transactions
+    pub proving: OperationTimings,
+}
+
+impl WalletStats {
+    pub fn record_sync(&self, elapsed: Duration, num_of_blocks: u64) {
+        self.sync.record(elapsed);
+        self.synced_blocks
+            .fetch_add(num_of_blocks, Ordering::Relaxed);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_operation_timings_snapshot() {
+        let timings = OperationTimings::default();
+        timings.record(Duration::from_micros(30));
+        timings.record(Duration::from_micros(50));
+        timings.record(Duration::from_micros(20));
+
+        assert_eq!(
+            timings.snapshot(),
+            OperationTimingsSnapshot {
+                count: 3,
+                total_micros: 100,
+                last_micros: 20,
+                max_micros: 50,
+            }
+        );
+    }
+}